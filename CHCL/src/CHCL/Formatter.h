@@ -1,215 +1,643 @@
 #pragma once
 
-#include <bitset>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <iomanip>
 #include <iostream>
-#include <regex>
+#include <iterator>
+#include <limits>
 #include <string>
+#include <string_view>
 #include <sstream>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "CHCL/dataStorage/Buffer.h"
+
 namespace chcl
 {
-	class Formatter
+	/**
+	 * @brief Format specifier of a single {n:w.pf} field
+	 */
+	struct FormatSpec
 	{
-	private:
+		size_t argIndex = 0;
+		int width = -1; ///< -1 if not given
+		int precision = -1; ///< -1 if not given
+		char flag = 0; ///< First character of the flags, 0 if none were given
+	};
+
+	/**
+	 * @brief Piece of a format string, either literal text or a field
+	 */
+	struct FormatSegment
+	{
+		size_t begin = 0; ///< Offset of the segment in the format string
+		size_t length = 0;
+		bool isField = false;
+		FormatSpec spec;
+	};
+
+	namespace FormatterDetail
+	{
+		constexpr bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+
+		/**
+		 * @brief Reads a run of decimal digits
+		 * @return Whether there were any digits
+		 */
+		constexpr bool ReadNumber(std::string_view text, size_t &pos, int &value)
+		{
+			size_t begin = pos;
+			int result = 0;
+			for (; pos < text.length() && IsDigit(text[pos]); ++pos)
+			{
+				if (result < 100000000)
+					result = result * 10 + (text[pos] - '0');
+			}
+			if (pos != begin)
+				value = result;
+			return pos != begin;
+		}
+
+		/**
+		 * @brief Parses a field starting at an opening brace
+		 * @param spec Parsed field. Its argIndex is left alone if the field has no explicit index
+		 * @param explicitIndex Whether the field gave its own argument index
+		 * @return Length of the field, or 0 if the text at begin is not a field
+		 */
+		constexpr size_t ParseField(std::string_view format, size_t begin, FormatSpec &spec, bool &explicitIndex)
+		{
+			size_t pos = begin + 1;
+			int index = 0;
+			explicitIndex = ReadNumber(format, pos, index);
+			if (explicitIndex)
+				spec.argIndex = size_t(index);
+
+			if (pos < format.length() && format[pos] == '}')
+				return pos + 1 - begin;
+			if (pos >= format.length() || format[pos] != ':')
+				return 0;
+
+			ReadNumber(format, ++pos, spec.width);
+			if (pos < format.length() && format[pos] == '.')
+				ReadNumber(format, ++pos, spec.precision);
+
+			// Flags run up to the closing brace, without crossing a line
+			size_t close = pos;
+			while (close < format.length() && format[close] != '}')
+			{
+				if (format[close] == '\n' || format[close] == '\r')
+					return 0;
+				++close;
+			}
+			if (close == format.length())
+				return 0;
+
+			if (close != pos)
+				spec.flag = format[pos];
+			return close + 1 - begin;
+		}
+
 		/**
-		 * Regex for finding format fields
-		 * Has 4 capture groups:
-		 * 1. (always) field ID to match with argument
-		 * 2. (optional) format width specifier
-		 * 3. (optional) format precision specifier
-		 * 4. (optional) format type specifier
+		 * @brief Reads the segment of a format string starting at pos
+		 * Braces that do not start a well-formed field are kept as literal text
+		 * @param autoIndex Argument index for the next field without one of its own, advanced as fields use it
 		 */
-		static constexpr char formatFieldRegex[] = R"(\{(\d*)(?::(\d*)(?:\.(\d*))?(.*?))?\})";
-		inline static std::regex s_regex;
-		inline static bool s_regexInit = false;
+		constexpr FormatSegment NextSegment(std::string_view format, size_t pos, size_t &autoIndex)
+		{
+			FormatSegment segment;
+			segment.begin = pos;
+
+			for (size_t brace = format.find('{', pos); brace != std::string_view::npos; brace = format.find('{', brace + 1))
+			{
+				FormatSpec spec;
+				bool explicitIndex = false;
+				size_t fieldLength = ParseField(format, brace, spec, explicitIndex);
+				if (!fieldLength)
+					continue;
+
+				// Literal text before the field is returned first, the field is read on the next call
+				if (brace != pos)
+				{
+					segment.length = brace - pos;
+					return segment;
+				}
 
-		// Struct to store information about a format field
-		struct FormatField
+				if (!explicitIndex)
+					spec.argIndex = autoIndex++;
+				segment.length = fieldLength;
+				segment.isField = true;
+				segment.spec = spec;
+				return segment;
+			}
+
+			segment.length = format.length() - pos;
+			return segment;
+		}
+
+		/**
+		 * @brief Destination writing through an output iterator
+		 */
+		template <typename OutputIt>
+		struct IteratorSink
 		{
-			std::smatch regexMatch; //< Field regex match
-			int fieldIndex; //< Argument index
-			std::string formattedValue = ""; //< Formatted value of the field
+			OutputIt out;
+
+			inline void write(const char *data, size_t length) { out = std::copy_n(data, length, out); }
+			inline void fill(char c, size_t count) { out = std::fill_n(out, count, c); }
 		};
 
-	public:
+		/**
+		 * @brief Destination appending to a string
+		 */
+		struct StringSink
+		{
+			std::string &out;
 
-		/**Format a string with arguments
-		 * Format fields are in the form {n[:w.pf]}, including an optional format specifier
-		 * n - the required parameter index
-		 * w - an optional width
-		 * p - an optional precision
-		 * f - a set of optional flags to better control output
-		 * 	Currently supported flags:
-		 * 	- f - fixed point
-		 * 	- e - scientific notation
-		 *  - x - hexadecimal integer
-		 *  - i - decimal integer
-		 *  - b - binary integer
+			inline void write(const char *data, size_t length) { out.append(data, length); }
+			inline void fill(char c, size_t count) { out.append(count, c); }
+		};
+
+		/**
+		 * @brief Destination appending to a Buffer
 		 */
-		template <typename ...Ts> 
-		static std::string Format(const std::string &formatString,  const Ts &...args)
+		struct BufferSink
 		{
-			if (!s_regexInit)
-			try
+			Buffer &out;
+
+			inline void write(const char *data, size_t length) { out.append(data, length); }
+			inline void fill(char c, size_t count)
 			{
-				s_regex = std::regex(formatFieldRegex);
-				s_regexInit = true;
+				char chunk[64];
+				std::memset(chunk, c, sizeof(chunk));
+				for (; count > sizeof(chunk); count -= sizeof(chunk))
+					out.append(chunk, sizeof(chunk));
+				out.append(chunk, count);
 			}
-			catch (std::exception e)
+		};
+
+		/**
+		 * @brief Destination that only counts the characters written to it
+		 */
+		struct CountingSink
+		{
+			size_t count = 0;
+
+			inline void write(const char*, size_t length) { count += length; }
+			inline void fill(char, size_t count) { this->count += count; }
+		};
+
+		/// @brief Types an ostream prints as a single character
+		template <typename T>
+		concept Character = std::is_same_v<T, char> || std::is_same_v<T, signed char> || std::is_same_v<T, unsigned char>;
+
+		/**
+		 * @brief Writes text right-aligned to the field's width
+		 * Matches the ostream settings the flags correspond to: the x flag pads with zeros after any sign or base prefix
+		 * @param prefixLength Length of the sign or base prefix at the start of the text
+		 */
+		template <typename Sink>
+		void WritePadded(Sink &sink, const FormatSpec &spec, std::string_view text, size_t prefixLength = 0)
+		{
+			size_t width = spec.width > 0 ? size_t(spec.width) : 0;
+			if (text.length() >= width)
 			{
-				std::cout << "Formatter regex error: " << e.what() << "\n";
-				return "";
+				sink.write(text.data(), text.length());
+				return;
 			}
 
-			std::sregex_iterator fieldsBegin(formatString.begin(), formatString.end(), s_regex);
-			std::sregex_iterator fieldsEnd{};
-			
-			std::vector<FormatField> formatFields;
-			std::vector<FormatField*> sortedFormatFields;
-			
-			size_t numFields = std::distance(fieldsBegin, fieldsEnd);
-			formatFields.reserve(numFields);
-			sortedFormatFields.reserve(numFields);
+			size_t padding = width - text.length();
+			if (spec.flag == 'x')
+			{
+				sink.write(text.data(), prefixLength);
+				sink.fill('0', padding);
+				sink.write(text.data() + prefixLength, text.length() - prefixLength);
+			}
+			else
+			{
+				sink.fill(' ', padding);
+				sink.write(text.data(), text.length());
+			}
+		}
 
-			int autoIndex = 0;
-			for (std::sregex_iterator i = fieldsBegin; i != fieldsEnd; ++i)
+		/// @brief Every pair of decimal digits from 00 to 99, so integers convert two digits per division
+		inline constexpr std::array<char, 200> DecimalPairs = []()
+		{
+			std::array<char, 200> pairs{};
+			for (size_t i = 0; i < 100; ++i)
 			{
-				std::smatch fieldMatch = *i;
-				int index = 0;
-				if (fieldMatch.length(1))
-					index = std::stoi(fieldMatch.str(1));
-				else
-					index = autoIndex++;
+				pairs[i * 2] = char('0' + i / 10);
+				pairs[i * 2 + 1] = char('0' + i % 10);
+			}
+			return pairs;
+		}();
+
+		/// @brief Every byte as two lowercase hexadecimal digits
+		inline constexpr std::array<char, 512> HexPairs = []()
+		{
+			constexpr char Digits[] = "0123456789abcdef";
+			std::array<char, 512> pairs{};
+			for (size_t i = 0; i < 256; ++i)
+			{
+				pairs[i * 2] = Digits[i >> 4];
+				pairs[i * 2 + 1] = Digits[i & 0xF];
+			}
+			return pairs;
+		}();
+
+		/// @brief Longest text any of the integer kernels write: 64 binary digits
+		inline constexpr size_t MaxIntegerLength = std::numeric_limits<unsigned long long>::digits;
+
+		/**
+		 * @brief Writes the decimal digits of a value, ending at end
+		 * @return Start of the digits
+		 */
+		inline char* WriteDecimal(char *end, unsigned long long value)
+		{
+			while (value >= 100)
+			{
+				end -= 2;
+				std::memcpy(end, &DecimalPairs[(value % 100) * 2], 2);
+				value /= 100;
+			}
+
+			if (value >= 10)
+			{
+				end -= 2;
+				std::memcpy(end, &DecimalPairs[value * 2], 2);
+			}
+			else
+				*--end = char('0' + value);
+			return end;
+		}
 
-				formatFields.push_back(FormatField{ fieldMatch, index, "" });
-				sortedFormatFields.push_back(&formatFields.back());
+		/**
+		 * @brief Writes the lowercase hexadecimal digits of a value, without a prefix, ending at end
+		 * @return Start of the digits
+		 */
+		inline char* WriteHex(char *end, unsigned long long value)
+		{
+			while (value >= 0x100)
+			{
+				end -= 2;
+				std::memcpy(end, &HexPairs[(value & 0xFF) * 2], 2);
+				value >>= 8;
+			}
+
+			if (value >= 0x10)
+			{
+				end -= 2;
+				std::memcpy(end, &HexPairs[value * 2], 2);
 			}
+			else
+				*--end = HexPairs[value * 2 + 1];
+			return end;
+		}
 
-			std::sort(sortedFormatFields.begin(), sortedFormatFields.end(),
-				[](FormatField *first, FormatField *second)
+		/**
+		 * @brief Writes the lowest bytes of a value as binary digits, most significant first
+		 * Each byte is spread into eight characters at once with a multiply and masks, without branching on any bit
+		 * @return End of the digits
+		 */
+		inline char* WriteBinary(char *out, unsigned long long value, size_t byteCount)
+		{
+			// Selects bit 7 - i into byte i of the word in memory order, so it can be copied out as text
+			constexpr uint64_t BitMask = std::endian::native == std::endian::little ? 0x0102040810204080ull : 0x8040201008040201ull;
+
+			for (size_t byte = byteCount; byte-- > 0;)
+			{
+				uint64_t bits = ((value >> (byte * 8)) & 0xFF) * 0x0101010101010101ull & BitMask;
+				// Adding 0x7F carries each selected bit into the top of its byte, which the shift moves to the bottom
+				bits = ((bits + 0x7F7F7F7F7F7F7F7Full) >> 7 & 0x0101010101010101ull) | 0x3030303030303030ull;
+				std::memcpy(out, &bits, 8);
+				out += 8;
+			}
+			return out;
+		}
+
+		template <typename Sink, typename T>
+		void FormatInteger(Sink &sink, const FormatSpec &spec, T arg)
+		{
+			// Integers are promoted like ostream's +arg, so characters print as numbers
+			using Promoted = decltype(+arg);
+			using Unsigned = std::make_unsigned_t<Promoted>;
+			char buffer[MaxIntegerLength + 2];
+			char *begin = buffer, *end = std::end(buffer);
+			size_t prefixLength = 0;
+
+			if (spec.flag == 'b')
+			{
+				// Every bit of the original type, as std::bitset prints it
+				end = WriteBinary(buffer, static_cast<unsigned long long>(arg), sizeof(T));
+			}
+			else if (spec.flag == 'x')
+			{
+				// Negative numbers print as their unsigned representation, and zero has no base prefix
+				auto value = static_cast<Unsigned>(+arg);
+				begin = WriteHex(end, value);
+				if (value)
 				{
-					return first->fieldIndex < second->fieldIndex;
+					*--begin = 'x';
+					*--begin = '0';
+					prefixLength = 2;
 				}
-			);
+			}
+			else if constexpr (std::is_signed_v<Promoted>)
+			{
+				// Negated as unsigned, so the most negative value does not overflow
+				auto value = static_cast<Unsigned>(+arg);
+				bool negative = arg < 0;
+				begin = WriteDecimal(end, negative ? Unsigned(0) - value : value);
+				if (negative)
+					*--begin = '-';
+			}
+			else
+				begin = WriteDecimal(end, +arg);
 
-			int index = 0;
-			auto fieldsIterBegin = sortedFormatFields.begin();
-			auto fieldsIterEnd = sortedFormatFields.end();
-			(... , FormatArg(index, fieldsIterBegin, fieldsIterEnd, args));
+			WritePadded(sink, spec, std::string_view(begin, end - begin), prefixLength);
+		}
+
+		/**
+		 * @brief Formats a floating point number with std::to_chars
+		 * Without a precision, writes the shortest text that reads back as the same value. The f and e flags pick
+		 * fixed or scientific notation, otherwise the notation is chosen like printf's %g
+		 */
+		template <typename Sink, typename T>
+		void FormatFloat(Sink &sink, const FormatSpec &spec, T arg)
+		{
+			std::chars_format format = spec.flag == 'f' ? std::chars_format::fixed :
+				spec.flag == 'e' ? std::chars_format::scientific : std::chars_format::general;
+
+			auto convert = [&](char *begin, char *end)
+			{
+				return spec.precision >= 0 ? std::to_chars(begin, end, arg, format, spec.precision) : std::to_chars(begin, end, arg, format);
+			};
+
+			char buffer[128];
+			auto [end, error] = convert(buffer, std::end(buffer));
+			if (error == std::errc())
+			{
+				WritePadded(sink, spec, std::string_view(buffer, end - buffer), buffer[0] == '-');
+				return;
+			}
 
-			std::ostringstream result;
-			size_t unformattedBegin = 0;
-			for (FormatField &field : formatFields)
+			// Only huge fixed point numbers or precisions overflow the buffer
+			std::vector<char> large(size_t(std::max(spec.precision, 0)) + std::numeric_limits<T>::max_exponent10 + 64);
+			end = convert(large.data(), large.data() + large.size()).ptr;
+			WritePadded(sink, spec, std::string_view(large.data(), end - large.data()), large[0] == '-');
+		}
+
+		/**
+		 * @brief Formats types without a dedicated conversion through their ostream operator<<
+		 */
+		template <typename Sink, typename T>
+		void FormatStreamed(Sink &sink, const FormatSpec &spec, const T &arg)
+		{
+			std::ostringstream stream;
+			stream.precision(spec.precision >= 0 ? spec.precision : 6);
+			if (spec.width >= 0)
+				stream.width(spec.width);
+
+			switch (spec.flag)
 			{
-				size_t fieldBeginIndex = field.regexMatch.position();
+				case 'e':
+					stream << std::scientific;
+					break;
+				case 'f':
+					stream << std::fixed;
+					break;
+				case 'x':
+					stream << std::hex << std::showbase << std::setfill('0') << std::internal;
+					break;
+			}
 
-				if (unformattedBegin < fieldBeginIndex)
+			stream << arg;
+			std::string_view text = stream.view();
+			sink.write(text.data(), text.length());
+		}
+
+		/**
+		 * @brief Formats a single argument, applying the field's format specifier
+		 */
+		template <typename Sink, typename T>
+		void FormatValue(Sink &sink, const FormatSpec &spec, const T &arg)
+		{
+			if constexpr (std::is_convertible_v<const T&, std::string_view>)
+				WritePadded(sink, spec, std::string_view(arg));
+			else if constexpr (Character<T>)
+			{
+				// Any flag makes characters print as numbers
+				if (spec.flag)
+					FormatInteger(sink, spec, arg);
+				else
 				{
-					result << formatString.substr(unformattedBegin, fieldBeginIndex - unformattedBegin);
+					char c = char(arg);
+					WritePadded(sink, spec, std::string_view(&c, 1));
 				}
+			}
+			else if constexpr (std::is_integral_v<T>)
+				FormatInteger(sink, spec, arg);
+			else if constexpr (std::is_floating_point_v<T>)
+				FormatFloat(sink, spec, arg);
+			else
+				FormatStreamed(sink, spec, arg);
+		}
 
-				result << field.formattedValue;
+		template <typename Sink, typename T>
+		void FormatErased(Sink &sink, const FormatSpec &spec, const void *arg)
+		{
+			FormatValue(sink, spec, *static_cast<const T*>(arg));
+		}
+
+		/**
+		 * @brief Formats with a format string only known at runtime
+		 */
+		template <typename Sink, typename ...Ts>
+		void FormatRuntime(Sink &sink, std::string_view format, const Ts &...args)
+		{
+			// Arguments are looked up by index at runtime, through a formatting function instantiated for each type
+			struct ArgRef
+			{
+				const void *value;
+				void (*format)(Sink&, const FormatSpec&, const void*);
+			};
+			const std::array<ArgRef, sizeof...(Ts)> argRefs{ ArgRef{ &args, &FormatErased<Sink, Ts> }... };
 
-				unformattedBegin = fieldBeginIndex + field.regexMatch.length();
+			size_t autoIndex = 0;
+			for (size_t pos = 0; pos < format.length();)
+			{
+				FormatSegment segment = NextSegment(format, pos, autoIndex);
+				if (!segment.isField)
+					sink.write(format.data() + segment.begin, segment.length);
+				else if (segment.spec.argIndex < argRefs.size())
+				{
+					const ArgRef &arg = argRefs[segment.spec.argIndex];
+					arg.format(sink, segment.spec, arg.value);
+				}
+				pos += segment.length;
 			}
+		}
+	}
 
-			if (unformattedBegin < formatString.length())
-				result << formatString.substr(unformattedBegin);
+	/**
+	 * @brief Format string parsed at compile time.
+	 *
+	 * Used as a template argument, as in Formatter::Format<"{0:4x}">(value), so fields are found while compiling
+	 * and formatting only has to emit the arguments.
+	 */
+	template <size_t N>
+	struct FormatString
+	{
+		char text[N]{};
+		FormatSegment segments[N]{};
+		size_t segmentCount = 0;
+		/// @brief One more than the highest argument index any field refers to
+		size_t argCount = 0;
+
+		consteval FormatString(const char (&str)[N])
+		{
+			for (size_t i = 0; i < N; ++i)
+				text[i] = str[i];
 
-			return result.str();
+			std::string_view format{ text, N - 1 };
+			size_t autoIndex = 0;
+			for (size_t pos = 0; pos < format.length(); pos += segments[segmentCount++].length)
+			{
+				segments[segmentCount] = FormatterDetail::NextSegment(format, pos, autoIndex);
+				if (segments[segmentCount].isField && segments[segmentCount].spec.argIndex >= argCount)
+					argCount = segments[segmentCount].spec.argIndex + 1;
+			}
 		}
-	
-	private:
 
-		template <typename T>
-		static void FormatAsNumber(std::ostream &stream, const T &arg)
+		constexpr std::string_view view() const { return std::string_view(text, N - 1); }
+	};
+
+	class Formatter
+	{
+	public:
+
+		/**Format a string with arguments
+		 * Format fields are in the form {n[:w.pf]}, including an optional format specifier
+		 * n - the required parameter index
+		 * w - an optional width
+		 * p - an optional precision, floating point numbers without one use the shortest text that reads back exactly
+		 * f - a set of optional flags to better control output
+		 * 	Currently supported flags:
+		 * 	- f - fixed point
+		 * 	- e - scientific notation
+		 *  - x - hexadecimal integer
+		 *  - i - decimal integer
+		 *  - b - binary integer
+		 */
+		template <typename ...Ts>
+		static std::string Format(const std::string &formatString,  const Ts &...args)
 		{
-			stream << arg;
+			std::string result;
+			FormatterDetail::StringSink sink{ result };
+			FormatterDetail::FormatRuntime(sink, formatString, args...);
+			return result;
 		}
 
-		template<typename T> requires std::is_integral<T>::value
-		static void FormatAsNumber(std::ostream &stream, const T &arg)
+		/**
+		 * @brief Formats a string with a format string parsed at compile time
+		 * Takes the same fields as the runtime version, but referring to a missing argument fails to compile
+		 */
+		template <FormatString formatString, typename ...Ts>
+		static std::string Format(const Ts &...args)
 		{
-			stream << +arg;
+			std::string result;
+			FormatterDetail::StringSink sink{ result };
+			Emit<formatString>(sink, args...);
+			return result;
 		}
 
-		template <typename T>
-		static void FormatAsBinary(std::ostream &stream, const T &arg)
+		/**
+		 * @brief Formats straight into an output iterator, such as a pointer into a buffer sized with FormattedSize
+		 * Built-in types are formatted without streams or heap allocations
+		 * @return Iterator past the last character written
+		 */
+		template <std::output_iterator<char> OutputIt, typename ...Ts>
+		static OutputIt FormatTo(OutputIt out, std::string_view formatString, const Ts &...args)
 		{
-			stream << arg;
+			FormatterDetail::IteratorSink<OutputIt> sink{ out };
+			FormatterDetail::FormatRuntime(sink, formatString, args...);
+			return sink.out;
 		}
 
-		template <typename T> requires std::is_integral<T>::value
-		static void FormatAsBinary(std::ostream &stream, const T &arg)
+		template <FormatString formatString, std::output_iterator<char> OutputIt, typename ...Ts>
+		static OutputIt FormatTo(OutputIt out, const Ts &...args)
 		{
-			stream << std::bitset<sizeof(T) * 8>(arg);
+			FormatterDetail::IteratorSink<OutputIt> sink{ out };
+			Emit<formatString>(sink, args...);
+			return sink.out;
 		}
-		
-		template <typename T>
-		static void FormatArg(int &index, std::vector<FormatField*>::iterator &fieldsIter, std::vector<FormatField*>::iterator &fieldsIterEnd, const T &arg)
+
+		/**
+		 * @brief Formats onto the end of a buffer
+		 */
+		template <typename ...Ts>
+		static void FormatTo(Buffer &out, std::string_view formatString, const Ts &...args)
 		{
-			while (fieldsIter != fieldsIterEnd && (*fieldsIter)->fieldIndex == index)
-			{
-				FormatField *field = *fieldsIter;
+			FormatterDetail::BufferSink sink{ out };
+			FormatterDetail::FormatRuntime(sink, formatString, args...);
+		}
 
-				bool treatAsNumeric = false;
-				bool treatAsBinary = false;
-				std::ostringstream fieldFormatter;
+		template <FormatString formatString, typename ...Ts>
+		static void FormatTo(Buffer &out, const Ts &...args)
+		{
+			FormatterDetail::BufferSink sink{ out };
+			Emit<formatString>(sink, args...);
+		}
 
-				// Check for width parameter
-				if (field->regexMatch.length(2))
-				{
-					int fieldWidth = std::stoi(field->regexMatch.str(2));
-					fieldFormatter.width(fieldWidth);
-				}
+		/**
+		 * @brief Gets the number of characters FormatTo would write, without writing them
+		 */
+		template <typename ...Ts>
+		static size_t FormattedSize(std::string_view formatString, const Ts &...args)
+		{
+			FormatterDetail::CountingSink sink;
+			FormatterDetail::FormatRuntime(sink, formatString, args...);
+			return sink.count;
+		}
 
-				// Check for precision parameter
-				if (field->regexMatch.length(3))
-				{
-					int fieldPrecision = std::stoi(field->regexMatch.str(3));
-					fieldFormatter.precision(fieldPrecision);
-				}
+		template <FormatString formatString, typename ...Ts>
+		static size_t FormattedSize(const Ts &...args)
+		{
+			FormatterDetail::CountingSink sink;
+			Emit<formatString>(sink, args...);
+			return sink.count;
+		}
 
-				// Check for type flags
-				if (field->regexMatch.length(4))
-				{
-					treatAsNumeric = true;
-
-					switch (*(field->regexMatch[4].first))
-					{
-					case 'i':
-						fieldFormatter << std::dec;
-						break;
-					case 'e':
-						fieldFormatter << std::scientific;
-						break;
-					case 'f':
-						fieldFormatter << std::fixed;
-						break;
-					case 'x':
-						fieldFormatter << std::hex << std::showbase << std::setfill('0') << std::internal;
-						break;
-					case 'b':
-						treatAsBinary = true;
-						break;
-					}
-				}
+	private:
 
-				if (treatAsBinary)
-					FormatAsBinary(fieldFormatter, arg);
-				// Hack to print char types as a number
-				else if (treatAsNumeric)
-					FormatAsNumber(fieldFormatter, arg);
-				else
-					fieldFormatter << arg;
-				
-				field->formattedValue = fieldFormatter.str();
-				
-				++fieldsIter;
-			}
-			++index;
+		template <FormatString formatString, typename Sink, typename ...Ts>
+		static void Emit(Sink &sink, const Ts &...args)
+		{
+			static_assert(formatString.argCount <= sizeof...(Ts), "Format string refers to an argument that was not given");
+
+			auto argTuple = std::tie(args...);
+			[&]<size_t ...segmentIndices>(std::index_sequence<segmentIndices...>)
+			{
+				(EmitSegment<formatString, segmentIndices>(sink, argTuple), ...);
+			}(std::make_index_sequence<formatString.segmentCount>());
+		}
+
+		template <FormatString formatString, size_t segmentIndex, typename Sink, typename ArgTuple>
+		static void EmitSegment(Sink &sink, const ArgTuple &argTuple)
+		{
+			constexpr FormatSegment segment = formatString.segments[segmentIndex];
+			if constexpr (segment.isField)
+				FormatterDetail::FormatValue(sink, segment.spec, std::get<segment.spec.argIndex>(argTuple));
+			else
+				sink.write(formatString.text + segment.begin, segment.length);
 		}
 	};
 }
\ No newline at end of file
@@ -4,13 +4,23 @@
 
 void chcl::PrintBuffer(const Buffer &buffer)
 {
-	for (int i = 0; i < buffer.size(); ++i)
+	// Each byte takes four characters and a separator, formatted into a chunk of lines before being written out
+	constexpr size_t BytesPerLine = 32;
+	constexpr size_t LinesPerChunk = 64;
+	char chunk[BytesPerLine * LinesPerChunk * 5];
+	char *out = chunk;
+
+	const uint8_t *bytes = static_cast<const uint8_t*>(buffer.data());
+	for (size_t i = 0; i < buffer.size(); ++i)
 	{
-		std::cout << Formatter::Format("{0:4x}", *(uint8_t*)buffer[i]);
+		out = Formatter::FormatTo<"{0:4x}">(out, bytes[i]);
+		*out++ = i % BytesPerLine == BytesPerLine - 1 ? '\n' : ' ';
 
-		if (i % 32 == 31)
-			std::cout << "\n";
-		else
-			std::cout << " ";
+		if (out == std::end(chunk))
+		{
+			std::cout.write(chunk, out - chunk);
+			out = chunk;
+		}
 	}
+	std::cout.write(chunk, out - chunk);
 }
\ No newline at end of file
@@ -0,0 +1,66 @@
+#include "Arena.h"
+
+#include <algorithm>
+#include <cstring>
+
+chcl::Arena::Arena(size_t blockSize) :
+	m_blockSize(std::max<size_t>(blockSize, 64))
+{}
+
+void* chcl::Arena::allocate(size_t size, size_t alignment)
+{
+	while (m_block < m_blocks.size())
+	{
+		Block &block = m_blocks[m_block];
+		uintptr_t base = (uintptr_t)block.data.get();
+		size_t aligned = ((base + m_offset + alignment - 1) & ~uintptr_t(alignment - 1)) - base;
+		if (aligned + size <= block.size)
+		{
+			m_used += aligned + size - m_offset;
+			m_offset = aligned + size;
+			return block.data.get() + aligned;
+		}
+
+		// Move on to the next block kept from an earlier cycle, if any
+		if (m_block + 1 == m_blocks.size())
+			break;
+		++m_block;
+		m_offset = 0;
+	}
+
+	// New blocks come from operator new[], which is suitably aligned for anything but over-aligned types
+	size_t blockSize = std::max(m_blockSize, size + alignment);
+	m_blocks.push_back(Block{ std::make_unique_for_overwrite<uint8_t[]>(blockSize), blockSize });
+	m_block = m_blocks.size() - 1;
+	m_offset = 0;
+	return allocate(size, alignment);
+}
+
+std::string_view chcl::Arena::copy(std::string_view str)
+{
+	char *dest = allocate<char>(str.length());
+	std::memcpy(dest, str.data(), str.length());
+	return std::string_view(dest, str.length());
+}
+
+void chcl::Arena::reset()
+{
+	if (m_blocks.size() > 1)
+	{
+		size_t total = capacity();
+		m_blocks.clear();
+		m_blocks.push_back(Block{ std::make_unique_for_overwrite<uint8_t[]>(total), total });
+	}
+
+	m_block = 0;
+	m_offset = 0;
+	m_used = 0;
+}
+
+size_t chcl::Arena::capacity() const
+{
+	size_t total = 0;
+	for (const Block &block : m_blocks)
+		total += block.size;
+	return total;
+}
\ No newline at end of file
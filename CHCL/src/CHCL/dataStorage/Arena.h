@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace chcl
+{
+	/**
+	 * @brief Monotonic allocator handing out memory from a few large blocks.
+	 *
+	 * Nothing is freed individually. reset() releases everything at once and keeps the blocks for reuse,
+	 * so a loop that fills and resets an arena stops allocating once it has warmed up.
+	 * Only trivially destructible objects should be placed in an arena, as no destructors are run.
+	 */
+	class Arena
+	{
+	public:
+		static constexpr size_t DefaultBlockSize = 64 * 1024;
+
+		/**
+		 * @param blockSize Size of each block requested from the heap. Larger allocations get a block of their own
+		 */
+		explicit Arena(size_t blockSize = DefaultBlockSize);
+
+		Arena(const Arena&) = delete;
+		Arena& operator=(const Arena&) = delete;
+		Arena(Arena&&) = default;
+		Arena& operator=(Arena&&) = default;
+
+		/**
+		 * @brief Allocates uninitialized memory, valid until the next reset
+		 */
+		void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+		template <typename T>
+		T* allocate(size_t count = 1)
+		{
+			static_assert(std::is_trivially_destructible_v<T>, "Arena memory is released without running destructors");
+			return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+		}
+
+		/**
+		 * @brief Copies a string into the arena
+		 * @return View of the copy, valid until the next reset
+		 */
+		std::string_view copy(std::string_view str);
+
+		/**
+		 * @brief Releases every allocation at once
+		 * If the last cycle spilled into several blocks, they are merged into one so the next cycle fits in a single block
+		 */
+		void reset();
+
+		/// @brief Number of bytes handed out since the last reset, including alignment padding
+		inline size_t used() const { return m_used; }
+		/// @brief Total size of the blocks held
+		size_t capacity() const;
+
+	private:
+		struct Block
+		{
+			std::unique_ptr<uint8_t[]> data;
+			size_t size;
+		};
+
+		std::vector<Block> m_blocks;
+		size_t m_blockSize;
+		size_t m_block = 0; ///< Block currently allocated from
+		size_t m_offset = 0; ///< Position within the current block
+		size_t m_used = 0;
+	};
+}
\ No newline at end of file
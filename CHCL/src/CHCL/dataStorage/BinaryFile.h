@@ -20,12 +20,23 @@ namespace chcl
 
 			T result = 0;
 			std::ifstream::read((char*)&result, sizeof(T));
-			if (endian == Endianness::Big)
-			{
-				return NetworkOrder::reverse(&result);
-			}
+			return NetworkOrder::convertFrom(endian, result);
+		}
+
+		/**
+		 * @brief Reads an array of integers in one read, converting them to native order in bulk
+		 * @param dest Array to read into
+		 * @param count Number of integers to read
+		 * @param endian Endianness the integers are stored in
+		 */
+		template <typename T> requires std::is_integral<T>::value
+		void readArray(T *dest, size_t count, Endianness endian = Endianness::Default)
+		{
+			if (endian == Endianness::Default)
+				endian = m_defaultEndian;
 
-			return result;
+			std::ifstream::read((char*)dest, count * sizeof(T));
+			NetworkOrder::convertFrom(endian, std::span<T>(dest, (size_t)gcount() / sizeof(T)));
 		}
 
 	private:
@@ -0,0 +1,210 @@
+#include "BinaryReader.h"
+
+#include <algorithm>
+#include <climits>
+
+#ifdef _WIN32
+	#include <fcntl.h>
+	#include <io.h>
+#else
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+namespace
+{
+#ifdef _WIN32
+	int OpenFile(const std::string &filename) { return _open(filename.c_str(), _O_RDONLY | _O_BINARY); }
+	long long ReadFile(int fd, void *dest, size_t size) { return _read(fd, dest, (unsigned int)std::min<size_t>(size, INT_MAX)); }
+	long long SeekFile(int fd, long long position, int origin) { return _lseeki64(fd, position, origin); }
+	void CloseFile(int fd) { _close(fd); }
+#else
+	int OpenFile(const std::string &filename) { return ::open(filename.c_str(), O_RDONLY); }
+	long long ReadFile(int fd, void *dest, size_t size) { return ::read(fd, dest, std::min<size_t>(size, INT_MAX)); }
+	long long SeekFile(int fd, long long position, int origin) { return ::lseek(fd, position, origin); }
+	void CloseFile(int fd) { ::close(fd); }
+#endif
+}
+
+chcl::BinaryReader::BinaryReader(const void *data, size_t size, Endianness defaultEndian) :
+	m_windowBegin((const uint8_t*)data),
+	m_pos((const uint8_t*)data),
+	m_end((const uint8_t*)data + size),
+	m_defaultEndian(defaultEndian)
+{}
+
+chcl::BinaryReader::BinaryReader(const Buffer &buffer, Endianness defaultEndian) :
+	BinaryReader(buffer.data(), buffer.size(), defaultEndian)
+{}
+
+chcl::BinaryReader::BinaryReader(int fileDescriptor, Endianness defaultEndian, size_t bufferSize) :
+	m_buffer(bufferSize),
+	m_fileDescriptor(fileDescriptor),
+	m_defaultEndian(defaultEndian)
+{
+	m_windowBegin = m_pos = m_end = (const uint8_t*)m_buffer.data();
+	m_failed = fileDescriptor < 0;
+
+	long long position = m_failed ? -1 : SeekFile(fileDescriptor, 0, SEEK_CUR);
+	m_windowOffset = position > 0 ? (size_t)position : 0;
+}
+
+chcl::BinaryReader::BinaryReader(const std::string &filename, Endianness defaultEndian, size_t bufferSize) :
+	BinaryReader(OpenFile(filename), defaultEndian, bufferSize)
+{
+	m_ownsFile = m_fileDescriptor >= 0;
+}
+
+chcl::BinaryReader::~BinaryReader()
+{
+	if (m_ownsFile)
+		CloseFile(m_fileDescriptor);
+}
+
+size_t chcl::BinaryReader::read(void *dest, size_t size)
+{
+	uint8_t *out = (uint8_t*)dest;
+	size_t copied = std::min(available(), size);
+	std::memcpy(out, m_pos, copied);
+	m_pos += copied;
+
+	if (copied < size && m_fileDescriptor >= 0)
+	{
+		size_t remaining = size - copied;
+
+		// Large reads bypass the internal buffer entirely
+		if (remaining >= m_buffer.capacity())
+		{
+			size_t position = tell();
+			size_t directRead = readFile(out + copied, remaining);
+			copied += directRead;
+
+			m_windowBegin = m_pos = m_end = (const uint8_t*)m_buffer.data();
+			m_windowOffset = position + directRead;
+		}
+		else
+		{
+			fill(remaining);
+			size_t bufferedRead = std::min(available(), remaining);
+			std::memcpy(out + copied, m_pos, bufferedRead);
+			m_pos += bufferedRead;
+			copied += bufferedRead;
+		}
+	}
+
+	if (copied < size)
+		m_failed = true;
+
+	return copied;
+}
+
+std::span<const uint8_t> chcl::BinaryReader::view(size_t n)
+{
+	if (available() < n)
+		fill(n);
+
+	size_t viewSize = std::min(available(), n);
+	std::span<const uint8_t> result(m_pos, viewSize);
+	m_pos += viewSize;
+
+	if (viewSize < n)
+		m_failed = true;
+
+	return result;
+}
+
+void chcl::BinaryReader::skip(size_t bytes)
+{
+	if (bytes <= available())
+	{
+		m_pos += bytes;
+		return;
+	}
+
+	if (m_fileDescriptor >= 0)
+	{
+		seek(tell() + bytes);
+		return;
+	}
+
+	m_pos = m_end;
+	m_failed = true;
+}
+
+bool chcl::BinaryReader::seek(size_t position)
+{
+	size_t windowSize = m_end - m_windowBegin;
+	if (position >= m_windowOffset && position <= m_windowOffset + windowSize)
+	{
+		m_pos = m_windowBegin + (position - m_windowOffset);
+		return true;
+	}
+
+	if (m_fileDescriptor < 0)
+	{
+		m_failed = true;
+		return false;
+	}
+
+	// Seeking past the end of a file succeeds, so the position is checked against the file's size.
+	// A position past the end leaves the reader at the end, as skipping past the end of memory does
+	long long fileSize = SeekFile(m_fileDescriptor, 0, SEEK_END);
+	if (fileSize < 0)
+	{
+		m_failed = true;
+		return false;
+	}
+
+	const bool valid = position <= (size_t)fileSize;
+	position = std::min(position, (size_t)fileSize);
+
+	m_windowBegin = m_pos = m_end = (const uint8_t*)m_buffer.data();
+	m_fileEnd = !valid;
+
+	if (SeekFile(m_fileDescriptor, (long long)position, SEEK_SET) < 0)
+	{
+		m_failed = true;
+		return false;
+	}
+
+	m_windowOffset = position;
+	m_failed |= !valid;
+	return valid;
+}
+
+bool chcl::BinaryReader::fill(size_t minBytes)
+{
+	if (m_fileDescriptor < 0 || m_fileEnd)
+		return available() >= minBytes;
+
+	// Shift unread bytes to the front of the buffer, and grow it if a large view was requested
+	size_t remaining = available();
+	m_windowOffset = tell();
+	std::memmove(m_buffer.data(), m_pos, remaining);
+	m_buffer.setSize(remaining);
+	m_buffer.reserve(minBytes);
+
+	uint8_t *base = (uint8_t*)m_buffer.data();
+	size_t filled = remaining + readFile(base + remaining, m_buffer.capacity() - remaining);
+
+	m_windowBegin = m_pos = base;
+	m_end = base + filled;
+
+	return filled >= minBytes;
+}
+
+size_t chcl::BinaryReader::readFile(void *dest, size_t size)
+{
+	size_t total = 0;
+	while (total < size)
+	{
+		long long bytesRead = ReadFile(m_fileDescriptor, (uint8_t*)dest + total, size - total);
+		if (bytesRead <= 0)
+		{
+			m_fileEnd = true;
+			break;
+		}
+		total += (size_t)bytesRead;
+	}
+	return total;
+}
\ No newline at end of file
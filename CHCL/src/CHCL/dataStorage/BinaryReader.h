@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+
+#include "Buffer.h"
+#include "NetworkOrder.h"
+
+namespace chcl
+{
+	/**
+	 * @brief Buffered reader for binary data, without the stream machinery of BinaryFile.
+	 *
+	 * Reads either from memory (a Buffer or raw block, which is not copied and must outlive the reader)
+	 * or from a file descriptor through a large internal buffer that is refilled as it runs out.
+	 * Reads past the end of the data return zeroes and mark the reader as failed.
+	 */
+	class BinaryReader
+	{
+	public:
+		static constexpr size_t DefaultBufferSize = 64 * 1024;
+
+		/**
+		 * @brief Create a reader over an in-memory block of data
+		 * @param data Pointer to first byte
+		 * @param size Size of data, in bytes
+		 * @param defaultEndian Endianness used when reads do not specify one
+		 */
+		BinaryReader(const void *data, size_t size, Endianness defaultEndian = Endianness::Default);
+		/**
+		 * @brief Create a reader over the contents of a buffer
+		 * The buffer is not copied, and must not be modified while the reader is in use
+		 */
+		BinaryReader(const Buffer &buffer, Endianness defaultEndian = Endianness::Default);
+		/**
+		 * @brief Create a reader pulling from an open file descriptor
+		 * The descriptor is not closed by the reader
+		 * @param fileDescriptor Descriptor opened for binary reading
+		 * @param bufferSize Size of internal read buffer
+		 */
+		BinaryReader(int fileDescriptor, Endianness defaultEndian = Endianness::Default, size_t bufferSize = DefaultBufferSize);
+		/**
+		 * @brief Open a file and read from it
+		 * Check operator bool to see whether the file was opened
+		 */
+		BinaryReader(const std::string &filename, Endianness defaultEndian = Endianness::Default, size_t bufferSize = DefaultBufferSize);
+
+		BinaryReader(const BinaryReader&) = delete;
+		BinaryReader& operator=(const BinaryReader&) = delete;
+
+		~BinaryReader();
+
+		/**
+		 * @brief Reads a single integer, converting it to native order
+		 * @param endian Endianness the integer is stored in
+		 */
+		template <typename T> requires std::is_integral<T>::value
+		inline T readInt(Endianness endian = Endianness::Default)
+		{
+			if (endian == Endianness::Default)
+				endian = m_defaultEndian;
+
+			T result = 0;
+			if (available() >= sizeof(T) || fill(sizeof(T)))
+			{
+				std::memcpy(&result, m_pos, sizeof(T));
+				m_pos += sizeof(T);
+			}
+			else
+				m_failed = true;
+
+			return NetworkOrder::convertFrom(endian, result);
+		}
+
+		/**
+		 * @brief Reads enough integers to fill dest, converting them to native order in bulk
+		 * @return Number of integers read
+		 */
+		template <typename T> requires std::is_integral<T>::value
+		size_t readArray(std::span<T> dest, Endianness endian = Endianness::Default)
+		{
+			if (endian == Endianness::Default)
+				endian = m_defaultEndian;
+
+			size_t count = read(dest.data(), dest.size_bytes()) / sizeof(T);
+			NetworkOrder::convertFrom(endian, dest.first(count));
+			return count;
+		}
+
+		/**
+		 * @brief Copies raw bytes into dest
+		 * @return Number of bytes copied
+		 */
+		size_t read(void *dest, size_t size);
+
+		/**
+		 * @brief Gets a pointer to the next n bytes without copying, and advances past them
+		 * For file readers the view is invalidated by the next read.
+		 * @return View of the bytes, shorter than n if the data ran out
+		 */
+		std::span<const uint8_t> view(size_t n);
+
+		/** Move the read position forward by 'bytes'. Skipping past the end stops there and marks the reader as failed */
+		void skip(size_t bytes);
+		/**
+		 * @brief Move the read position to the given offset from the start of the data
+		 * @return Whether the position is valid
+		 */
+		bool seek(size_t position);
+		/** Current read position, in bytes from the start of the data */
+		inline size_t tell() const { return m_windowOffset + (m_pos - m_windowBegin); }
+
+		inline bool eof() const { return m_pos == m_end && !(m_fileDescriptor >= 0 && !m_fileEnd); }
+		inline explicit operator bool() const { return !m_failed; }
+
+	private:
+		const uint8_t *m_windowBegin = nullptr; ///< First byte of the currently readable window
+		const uint8_t *m_pos = nullptr; ///< Current read position within the window
+		const uint8_t *m_end = nullptr; ///< End of the currently readable window
+		size_t m_windowOffset = 0; ///< Position of the window start within the data
+
+		Buffer m_buffer; ///< Storage for file readers
+		int m_fileDescriptor = -1;
+		bool m_ownsFile = false;
+		bool m_fileEnd = false;
+		bool m_failed = false;
+
+		Endianness m_defaultEndian;
+
+		inline size_t available() const { return m_end - m_pos; }
+
+		/**
+		 * @brief Makes at least minBytes contiguous bytes available from the read position
+		 * @return Whether enough bytes are available
+		 */
+		bool fill(size_t minBytes);
+		size_t readFile(void *dest, size_t size);
+	};
+}
\ No newline at end of file
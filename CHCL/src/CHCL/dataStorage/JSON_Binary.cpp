@@ -0,0 +1,619 @@
+#include "JSON_Binary.h"
+
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#include "JSON_Strings.h"
+#include "NetworkOrder.h"
+
+namespace
+{
+	using chcl::JSON_Binary::Format;
+	using chcl::JSON_Node;
+	using chcl::JSON_Type;
+
+	/// @brief Nesting limit, so malformed data cannot exhaust the stack
+	constexpr size_t MaxDepth = 1024;
+
+	float HalfToFloat(uint16_t half)
+	{
+		uint32_t sign = uint32_t(half & 0x8000) << 16;
+		uint32_t exponent = (half >> 10) & 0x1f;
+		uint32_t mantissa = half & 0x3ff;
+
+		if (exponent == 0)
+		{
+			// Zero and subnormals
+			float value = std::ldexp(float(mantissa), -24);
+			return sign ? -value : value;
+		}
+		if (exponent == 31)
+			return std::bit_cast<float>(sign | 0x7f800000 | (mantissa << 13));
+		return std::bit_cast<float>(sign | ((exponent + 112) << 23) | (mantissa << 13));
+	}
+
+	/**
+	 * @brief Decodes CBOR or MessagePack into tape nodes.
+	 * Strings and literals are kept as JSON text, while numbers are stored as their binary values in native byte order
+	 */
+	class Decoder
+	{
+	public:
+		std::string source;
+		std::vector<JSON_Node> nodes;
+
+		Decoder(const uint8_t *data, size_t size, Format format) :
+			m_pos(data),
+			m_end(data + size),
+			m_format(format)
+		{
+			source.reserve(size);
+		}
+
+		bool decode() { return readItem(0); }
+
+	private:
+		const uint8_t *m_pos;
+		const uint8_t *m_end;
+		Format m_format;
+		std::string m_joined; ///< Contents of CBOR strings split into chunks
+		bool m_key = false; ///< Whether a member name is being read
+
+		inline size_t remaining() const { return size_t(m_end - m_pos); }
+
+		bool readItem(size_t depth)
+		{
+			if (depth > MaxDepth || m_pos == m_end)
+				return false;
+			return m_format == Format::Cbor ? readCbor(depth) : readMessagePack(depth);
+		}
+
+		// Tape building
+
+		size_t beginNode(JSON_Type type, chcl::JSON_NumberFormat format = chcl::JSON_NumberFormat::Text)
+		{
+			nodes.push_back(JSON_Node{ type, format, 0, source.size(), 0, 0 });
+			return nodes.size() - 1;
+		}
+
+		void endNode(size_t index)
+		{
+			nodes[index].end = source.size();
+			nodes[index].next = nodes.size();
+		}
+
+		void addLiteral(JSON_Type type, std::string_view literal)
+		{
+			size_t index = beginNode(type);
+			source += literal;
+			endNode(index);
+		}
+
+		template <typename T>
+		void addNumber(T number)
+		{
+			if constexpr (std::is_floating_point_v<T>)
+			{
+				if (!std::isfinite(number))
+				{
+					addLiteral(JSON_Type::Null, "null");
+					return;
+				}
+			}
+
+			if (m_key)
+			{
+				// Member names are strings in JSON, so numeric names are stored as their text
+				char buffer[32];
+				auto [end, error] = std::to_chars(buffer, buffer + sizeof(buffer), number);
+				addString(std::string_view(buffer, size_t(end - buffer)));
+				return;
+			}
+
+			size_t index = beginNode(JSON_Type::Number, chcl::JSON_Tape::NumberFormatOf<T>());
+			source.append((const char*)&number, sizeof(T));
+			endNode(index);
+		}
+
+		void addString(std::string_view str)
+		{
+			size_t index = beginNode(JSON_Type::String);
+			source.push_back('\"');
+
+			chcl::JSON_Strings::Escape(str, [this](const char *data, size_t length) { source.append(data, length); });
+			source.push_back('\"');
+			endNode(index);
+		}
+
+		/**
+		 * @brief Adds an array of numbers read from packed memory
+		 * The converted elements are stored back to back, so the array can be read with a single copy
+		 * @tparam T Type the elements are stored as
+		 * @param convert Function converting count elements from the encoded bytes into native T values
+		 */
+		template <typename T, typename Convert>
+		bool addPacked(std::string_view bytes, size_t elementSize, Convert &&convert)
+		{
+			if (bytes.length() % elementSize || bytes.length() / elementSize > UINT32_MAX)
+				return false;
+
+			constexpr chcl::JSON_NumberFormat format = chcl::JSON_Tape::NumberFormatOf<T>();
+			size_t count = bytes.length() / elementSize;
+			size_t index = beginNode(JSON_Type::Array, format);
+			size_t begin = source.size();
+			source.resize(begin + count * sizeof(T));
+			convert(bytes.data(), source.data() + begin, count);
+
+			nodes.reserve(nodes.size() + count);
+			for (size_t i = 0; i < count; ++i)
+			{
+				size_t offset = begin + i * sizeof(T);
+				nodes.push_back(JSON_Node{ JSON_Type::Number, format, 0, offset, offset + sizeof(T), nodes.size() + 1 });
+			}
+			nodes[index].count = uint32_t(count);
+			endNode(index);
+			return true;
+		}
+
+		/// @brief Adds a byte string, which JSON has no type for, as an array of its bytes
+		bool addBytes(std::string_view bytes)
+		{
+			return addTypedElements<uint8_t>(bytes, chcl::NetworkOrder::Native);
+		}
+
+		template <typename T>
+		static T LoadPacked(const char *data, chcl::Endianness endian)
+		{
+			if constexpr (std::is_floating_point_v<T>)
+			{
+				using Bits = std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;
+				return std::bit_cast<T>(LoadPacked<Bits>(data, endian));
+			}
+			else
+			{
+				T value;
+				std::memcpy(&value, data, sizeof(T));
+				return chcl::NetworkOrder::convertFrom(endian, value);
+			}
+		}
+
+		template <typename T>
+		bool addTypedElements(std::string_view bytes, chcl::Endianness endian)
+		{
+			return addPacked<T>(bytes, sizeof(T), [endian](const char *in, char *out, size_t count)
+				{
+					// Arrays in native byte order, as JSON_Writer encodes them, are copied as they are
+					if (sizeof(T) == 1 || !chcl::NetworkOrder::NeedsSwap(endian))
+					{
+						std::memcpy(out, in, count * sizeof(T));
+						return;
+					}
+
+					for (size_t i = 0; i < count; ++i)
+					{
+						T value = LoadPacked<T>(in + i * sizeof(T), endian);
+						std::memcpy(out + i * sizeof(T), &value, sizeof(T));
+					}
+				});
+		}
+
+		/**
+		 * @brief Adds an RFC 8746 typed array
+		 * @param tag Tag of the array, with bits 0b010fsell: float, signed, little endian and element size
+		 * @return False if the tag is not a supported typed array or the size does not match it
+		 */
+		bool addTypedArray(uint64_t tag, std::string_view bytes)
+		{
+			if (tag < 64 || tag > 87)
+				return false;
+
+			uint8_t bits = uint8_t(tag - 64);
+			bool isFloat = bits & 0b10000;
+			bool isSigned = bits & 0b1000;
+			chcl::Endianness endian = (bits & 0b100) ? chcl::Endianness::Little : chcl::Endianness::Big;
+			uint8_t sizeBits = bits & 0b11;
+
+			if (isFloat)
+			{
+				switch (sizeBits)
+				{
+					case 0:
+						return addPacked<float>(bytes, 2, [endian](const char *in, char *out, size_t count)
+							{
+								for (size_t i = 0; i < count; ++i)
+								{
+									float value = HalfToFloat(LoadPacked<uint16_t>(in + i * 2, endian));
+									std::memcpy(out + i * sizeof(float), &value, sizeof(float));
+								}
+							});
+					case 1:
+						return addTypedElements<float>(bytes, endian);
+					case 2:
+						return addTypedElements<double>(bytes, endian);
+					default:
+						return false;
+				}
+			}
+
+			switch (sizeBits)
+			{
+				case 0:
+					// Single bytes have no byte order, and the little endian bit instead marks clamped/reserved types
+					if (isSigned)
+						return (bits & 0b100) ? false : addTypedElements<int8_t>(bytes, endian);
+					return addTypedElements<uint8_t>(bytes, endian);
+				case 1:
+					return isSigned ? addTypedElements<int16_t>(bytes, endian) : addTypedElements<uint16_t>(bytes, endian);
+				case 2:
+					return isSigned ? addTypedElements<int32_t>(bytes, endian) : addTypedElements<uint32_t>(bytes, endian);
+				default:
+					return isSigned ? addTypedElements<int64_t>(bytes, endian) : addTypedElements<uint64_t>(bytes, endian);
+			}
+		}
+
+		/**
+		 * @brief Reads a container, either of known size or running until a CBOR break
+		 * @param object Whether the container holds key-value pairs
+		 */
+		bool readContainer(bool object, bool indefinite, uint64_t count, size_t depth)
+		{
+			if (!indefinite && count > UINT32_MAX)
+				return false;
+
+			size_t index = beginNode(object ? JSON_Type::Object : JSON_Type::Array);
+
+			uint32_t read = 0;
+			while (indefinite || read < count)
+			{
+				if (indefinite)
+				{
+					if (m_pos == m_end)
+						return false;
+					if (*m_pos == 0xff)
+					{
+						++m_pos;
+						break;
+					}
+					if (read == UINT32_MAX)
+						return false;
+				}
+
+				if (object && !readKey(depth))
+					return false;
+				if (!readItem(depth + 1))
+					return false;
+				++read;
+			}
+
+			nodes[index].count = read;
+			endNode(index);
+			return true;
+		}
+
+		/// @brief Reads a member name. Integer names are turned into strings, as JSON only has string names
+		bool readKey(size_t depth)
+		{
+			size_t index = nodes.size();
+			m_key = true;
+			bool read = readItem(depth + 1);
+			m_key = false;
+			return read && nodes[index].type == JSON_Type::String;
+		}
+
+		bool readBytes(size_t length, std::string_view &out)
+		{
+			if (length > remaining())
+				return false;
+			out = std::string_view((const char*)m_pos, length);
+			m_pos += length;
+			return true;
+		}
+
+		template <typename T>
+		bool readBigEndian(T &value)
+		{
+			if (remaining() < sizeof(T))
+				return false;
+			std::memcpy(&value, m_pos, sizeof(T));
+			value = chcl::NetworkOrder::convertFrom(chcl::Endianness::Big, value);
+			m_pos += sizeof(T);
+			return true;
+		}
+
+		/// @brief Reads an unsigned big endian integer of 1, 2, 4 or 8 bytes
+		bool readUnsigned(size_t size, uint64_t &value)
+		{
+			switch (size)
+			{
+				case 1: { uint8_t v; if (!readBigEndian(v)) return false; value = v; return true; }
+				case 2: { uint16_t v; if (!readBigEndian(v)) return false; value = v; return true; }
+				case 4: { uint32_t v; if (!readBigEndian(v)) return false; value = v; return true; }
+				default: return readBigEndian(value);
+			}
+		}
+
+		// CBOR
+
+		bool readCborArgument(uint8_t info, uint64_t &argument)
+		{
+			if (info < 24)
+			{
+				argument = info;
+				return true;
+			}
+			if (info > 27)
+				return false;
+			return readUnsigned(size_t(1) << (info - 24), argument);
+		}
+
+		/// @brief Reads the contents of a byte or text string, joining the chunks of indefinite length strings
+		bool readCborString(uint8_t major, bool indefinite, uint64_t length, std::string_view &out)
+		{
+			if (!indefinite)
+				return readBytes(length, out);
+
+			m_joined.clear();
+			while (true)
+			{
+				if (m_pos == m_end)
+					return false;
+				uint8_t initial = *m_pos++;
+				if (initial == 0xff)
+					break;
+
+				uint64_t chunkLength;
+				std::string_view chunk;
+				if ((initial >> 5) != major || !readCborArgument(initial & 0x1f, chunkLength) || !readBytes(chunkLength, chunk))
+					return false;
+				m_joined += chunk;
+			}
+			out = m_joined;
+			return true;
+		}
+
+		bool readCbor(size_t depth)
+		{
+			uint8_t initial = *m_pos++;
+			uint8_t major = initial >> 5;
+			uint8_t info = initial & 0x1f;
+
+			if (major == 7)
+				return readCborSimple(info);
+
+			// Only strings and containers may have an indefinite length
+			bool indefinite = info == 31;
+			uint64_t argument = 0;
+			if (indefinite ? (major < 2 || major > 5) : !readCborArgument(info, argument))
+				return false;
+
+			switch (major)
+			{
+				case 0:
+					addNumber(argument);
+					return true;
+				case 1:
+					// The value is -1 - argument, which only fits in an int64_t for half the range
+					if (argument <= uint64_t(INT64_MAX))
+						addNumber(-1 - int64_t(argument));
+					else
+						addNumber(-1.0 - double(argument));
+					return true;
+				case 2:
+				case 3:
+				{
+					std::string_view contents;
+					if (!readCborString(major, indefinite, argument, contents))
+						return false;
+					if (major == 3)
+						addString(contents);
+					else
+						addBytes(contents);
+					return true;
+				}
+				case 4:
+					return readContainer(false, indefinite, argument, depth);
+				case 5:
+					return readContainer(true, indefinite, argument, depth);
+				default:
+				{
+					// Typed arrays are a tag on a byte string, other tags are skipped
+					if (argument >= 64 && argument <= 87 && m_pos != m_end && (*m_pos >> 5) == 2)
+					{
+						uint8_t stringInfo = *m_pos++ & 0x1f;
+						uint64_t length = 0;
+						std::string_view bytes;
+						if (stringInfo != 31 && !readCborArgument(stringInfo, length))
+							return false;
+						return readCborString(2, stringInfo == 31, length, bytes) && addTypedArray(argument, bytes);
+					}
+					return readItem(depth + 1);
+				}
+			}
+		}
+
+		bool readCborSimple(uint8_t info)
+		{
+			switch (info)
+			{
+				case 20:
+					addLiteral(JSON_Type::False, "false");
+					return true;
+				case 21:
+					addLiteral(JSON_Type::True, "true");
+					return true;
+				case 22:
+				case 23: // Undefined
+					addLiteral(JSON_Type::Null, "null");
+					return true;
+				case 25:
+				{
+					uint16_t half;
+					if (!readBigEndian(half)) return false;
+					addNumber(HalfToFloat(half));
+					return true;
+				}
+				case 26:
+				{
+					uint32_t bits;
+					if (!readBigEndian(bits)) return false;
+					addNumber(std::bit_cast<float>(bits));
+					return true;
+				}
+				case 27:
+				{
+					uint64_t bits;
+					if (!readBigEndian(bits)) return false;
+					addNumber(std::bit_cast<double>(bits));
+					return true;
+				}
+				default:
+					return false;
+			}
+		}
+
+		// MessagePack
+
+		bool readExtension(size_t length)
+		{
+			std::string_view bytes;
+			if (m_pos == m_end)
+				return false;
+			uint8_t type = *m_pos++;
+			if (!readBytes(length, bytes))
+				return false;
+
+			// Extension types other than typed arrays, such as timestamps, have no JSON equivalent
+			if (type >= 64 && type <= 87)
+				return addTypedArray(type, bytes);
+			addLiteral(JSON_Type::Null, "null");
+			return true;
+		}
+
+		bool readMessagePack(size_t depth)
+		{
+			uint8_t type = *m_pos++;
+
+			if (type <= 0x7f)
+			{
+				addNumber(type);
+				return true;
+			}
+			if (type >= 0xe0)
+			{
+				addNumber(int8_t(type));
+				return true;
+			}
+			if (type <= 0x8f)
+				return readContainer(true, false, type & 0x0f, depth);
+			if (type <= 0x9f)
+				return readContainer(false, false, type & 0x0f, depth);
+
+			std::string_view contents;
+			uint64_t length;
+			if (type <= 0xbf)
+			{
+				if (!readBytes(type & 0x1f, contents))
+					return false;
+				addString(contents);
+				return true;
+			}
+
+			switch (type)
+			{
+				case 0xc0:
+					addLiteral(JSON_Type::Null, "null");
+					return true;
+				case 0xc2:
+					addLiteral(JSON_Type::False, "false");
+					return true;
+				case 0xc3:
+					addLiteral(JSON_Type::True, "true");
+					return true;
+				case 0xc4:
+				case 0xc5:
+				case 0xc6:
+					if (!readUnsigned(size_t(1) << (type - 0xc4), length) || !readBytes(length, contents))
+						return false;
+					return addBytes(contents);
+				case 0xc7:
+				case 0xc8:
+				case 0xc9:
+					return readUnsigned(size_t(1) << (type - 0xc7), length) && readExtension(length);
+				case 0xca:
+				{
+					uint32_t bits;
+					if (!readBigEndian(bits)) return false;
+					addNumber(std::bit_cast<float>(bits));
+					return true;
+				}
+				case 0xcb:
+				{
+					uint64_t bits;
+					if (!readBigEndian(bits)) return false;
+					addNumber(std::bit_cast<double>(bits));
+					return true;
+				}
+				case 0xcc:
+				case 0xcd:
+				case 0xce:
+				case 0xcf:
+					if (!readUnsigned(size_t(1) << (type - 0xcc), length))
+						return false;
+					addNumber(length);
+					return true;
+				case 0xd0:
+				case 0xd1:
+				case 0xd2:
+				case 0xd3:
+				{
+					// Sign extend from the stored width
+					size_t size = size_t(1) << (type - 0xd0);
+					if (!readUnsigned(size, length))
+						return false;
+					size_t shift = 64 - size * 8;
+					addNumber(int64_t(length << shift) >> shift);
+					return true;
+				}
+				case 0xd4:
+				case 0xd5:
+				case 0xd6:
+				case 0xd7:
+				case 0xd8:
+					return readExtension(size_t(1) << (type - 0xd4));
+				case 0xd9:
+				case 0xda:
+				case 0xdb:
+					if (!readUnsigned(size_t(1) << (type - 0xd9), length) || !readBytes(length, contents))
+						return false;
+					addString(contents);
+					return true;
+				case 0xdc:
+				case 0xdd:
+					return readUnsigned(size_t(2) << (type - 0xdc), length) && readContainer(false, false, length, depth);
+				case 0xde:
+				case 0xdf:
+					return readUnsigned(size_t(2) << (type - 0xde), length) && readContainer(true, false, length, depth);
+				default:
+					return false;
+			}
+		}
+	};
+}
+
+std::shared_ptr<const chcl::JSON_Tape> chcl::JSON_Binary::DecodeTape(const void *data, size_t size, Format format)
+{
+	if (format == Format::Text)
+	{
+		auto tape = std::make_shared<const JSON_Tape>(std::string((const char*)data, size));
+		return tape->valid() ? tape : nullptr;
+	}
+
+	Decoder decoder{ (const uint8_t*)data, size, format };
+	if (!decoder.decode())
+		return nullptr;
+	return std::make_shared<const JSON_Tape>(std::move(decoder.source), std::move(decoder.nodes));
+}
\ No newline at end of file
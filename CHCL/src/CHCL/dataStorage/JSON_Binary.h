@@ -0,0 +1,73 @@
+#pragma once
+
+#include <memory>
+
+#include "Buffer.h"
+#include "JSON_Parser.h"
+#include "JSON_Tape.h"
+#include "JSON_Writer.h"
+
+namespace chcl
+{
+	/**
+	 * @brief Namespace containing functions for storing JSON elements as CBOR or MessagePack.
+	 *
+	 * Encoding goes through JSON_Writer and decoding produces a JSON_Tape, so any type with JSON_Writer or
+	 * JSON_Stream operators can be stored in either format without further code.
+	 * Packed typed arrays are decoded to arrays of numbers, and other byte strings to arrays of their bytes.
+	 * Decoded numbers keep their binary values, so reading a typed array back into memory of the same type is a single copy.
+	 */
+	namespace JSON_Binary
+	{
+		using Format = JSON_Writer::Format;
+
+		/**
+		 * @brief Decodes a single element into a tape that reads exactly like a parsed text document
+		 * Numbers are stored in the tape as binary values rather than text, see JSON_Tape::binary
+		 * @param data Encoded element
+		 * @param size Size of the data in bytes
+		 * @param format Encoding of the data
+		 * @return Decoded tape, or nullptr if the data is malformed
+		 */
+		std::shared_ptr<const JSON_Tape> DecodeTape(const void *data, size_t size, Format format);
+
+		/**
+		 * @brief Encodes an object onto the end of a buffer
+		 * Objects with a JSON_Writer overload are encoded directly, others are first formatted through JSON_Stream
+		 * @tparam T Object type to encode
+		 * @param object Object to encode
+		 * @param out Buffer to append to
+		 * @param format Encoding to use
+		 */
+		template <typename T>
+		void Encode(const T &object, Buffer &out, Format format)
+		{
+			JSON_Writer writer{ out, format };
+			if constexpr (JSON_Writable<T>)
+				writer << object;
+			else
+			{
+				JSON_Stream formatStream;
+				formatStream << object;
+				writer.rawValue(formatStream.str());
+			}
+		}
+
+		/**
+		 * @brief Decodes an object through its JSON_Stream operator>>
+		 * @tparam T Type to decode
+		 * @return Decoded object, or a default constructed one if the data is malformed
+		 */
+		template <typename T>
+		T Decode(const void *data, size_t size, Format format)
+		{
+			auto tape = DecodeTape(data, size, format);
+			if (!tape) return T();
+
+			JSON_Stream elemStream{ std::move(tape), 0 };
+			T result{};
+			elemStream >> result;
+			return result;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,245 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "JSON_Parser.h"
+#include "JSON_Writer.h"
+
+namespace chcl
+{
+	namespace JSON_BindingDetail
+	{
+		/**
+		 * @brief String literal usable as a template argument
+		 */
+		template <size_t length>
+		struct FieldName
+		{
+			char value[length]{};
+
+			constexpr FieldName(const char (&name)[length]) { std::copy_n(name, length, value); }
+			constexpr std::string_view view() const { return std::string_view(value, length - 1); }
+		};
+
+		/// @brief 64-bit FNV-1a, used both at compile time on field names and at runtime on keys
+		constexpr uint64_t HashName(std::string_view name)
+		{
+			uint64_t hash = 0xcbf29ce484222325;
+			for (char c : name)
+			{
+				hash ^= uint8_t(c);
+				hash *= 0x100000001b3;
+			}
+			return hash;
+		}
+
+		template <typename T>
+		struct MemberTraits;
+
+		template <typename Record, typename Member>
+		struct MemberTraits<Member Record::*>
+		{
+			using RecordType = Record;
+			using MemberType = Member;
+		};
+	}
+
+	/**
+	 * @brief Describes one member of a record bound to a JSON object
+	 * @tparam name Label of the member in the JSON object
+	 * @tparam member Pointer to the member the value is stored in
+	 */
+	template <JSON_BindingDetail::FieldName name, auto member>
+	struct JSON_Field
+	{
+		using RecordType = typename JSON_BindingDetail::MemberTraits<decltype(member)>::RecordType;
+		using MemberType = typename JSON_BindingDetail::MemberTraits<decltype(member)>::MemberType;
+
+		static constexpr auto Member = member;
+		static constexpr std::string_view Name = name.view();
+		static constexpr uint64_t Hash = JSON_BindingDetail::HashName(Name);
+	};
+
+	/**
+	 * @brief Compile-time description of a record stored as a JSON object, with generated readers and writers
+	 *
+	 * Keys are dispatched through a perfect hash table built at compile time, and values are decoded
+	 * straight from the parsed document into the members, with no intermediate map or strings.
+	 *
+	 * Usage:
+	 * template <> struct chcl::JSON_BindingOf<Message> : JSON_Binding<JSON_Field<"id", &Message::id>, JSON_Field<"text", &Message::text>, ...> {};
+	 * Message message = JSON_Parser::ParseElement<Message>(text);
+	 *
+	 * @tparam Fields List of JSON_Field descriptors, in the order they are written
+	 */
+	template <typename ...Fields>
+	class JSON_Binding
+	{
+	public:
+		using RecordType = typename std::tuple_element_t<0, std::tuple<Fields...>>::RecordType;
+		static constexpr size_t FieldCount = sizeof...(Fields);
+
+		static_assert((std::is_same_v<RecordType, typename Fields::RecordType> && ...), "All fields of a binding must belong to the same record type");
+
+	private:
+		static constexpr std::array<uint64_t, FieldCount> Hashes = { Fields::Hash... };
+
+		static constexpr bool DistinctSlots(size_t tableSize)
+		{
+			for (size_t i = 0; i < FieldCount; ++i)
+				for (size_t j = i + 1; j < FieldCount; ++j)
+					if (Hashes[i] % tableSize == Hashes[j] % tableSize)
+						return false;
+			return true;
+		}
+
+		/// @returns Smallest table size in which no two fields share a slot
+		static constexpr size_t ComputeTableSize()
+		{
+			for (size_t tableSize = FieldCount; tableSize < FieldCount * FieldCount * 8 + 64; ++tableSize)
+				if (DistinctSlots(tableSize))
+					return tableSize;
+			return 0;
+		}
+
+		static constexpr size_t TableSize = ComputeTableSize();
+		static_assert(TableSize != 0, "Field names of a binding must be distinct");
+
+		static constexpr std::array<size_t, TableSize> ComputeSlots()
+		{
+			std::array<size_t, TableSize> slots{};
+			slots.fill(FieldCount);
+			for (size_t i = 0; i < FieldCount; ++i)
+				slots[Hashes[i] % TableSize] = i;
+			return slots;
+		}
+
+		/// @brief Field index stored in each slot of the hash table, FieldCount for empty slots
+		static constexpr std::array<size_t, TableSize> Slots = ComputeSlots();
+		static constexpr std::array<std::string_view, FieldCount> Names = { Fields::Name... };
+
+		using Reader = void(*)(const JSON_Stream &stream, size_t index, RecordType &record);
+
+		template <typename F>
+		static void readField(const JSON_Stream &stream, size_t index, RecordType &record)
+		{
+			using MemberType = typename F::MemberType;
+			MemberType &member = record.*F::Member;
+
+			if constexpr (JSON_Number<MemberType>)
+			{
+				if (!stream.tape->readNumber(index, member))
+					member = MemberType();
+			}
+			else if constexpr (std::is_same_v<MemberType, std::string>)
+			{
+				if (!stream.tape->readString(index, member))
+					member.clear();
+			}
+			else
+			{
+				JSON_Stream elemStream{ stream.tape, index };
+				elemStream >> member;
+			}
+		}
+
+		static constexpr std::array<Reader, FieldCount> Readers = { &readField<Fields>... };
+
+	public:
+		/**
+		 * @returns Index of the field with the given label, or FieldCount if there is none
+		 */
+		static constexpr size_t FieldIndex(std::string_view label)
+		{
+			size_t field = Slots[JSON_BindingDetail::HashName(label) % TableSize];
+			return field != FieldCount && Names[field] == label ? field : FieldCount;
+		}
+
+		/**
+		 * @brief Reads the members of a record from a JSON object
+		 * Members missing from the object are left untouched, and unknown labels are ignored
+		 * @return Whether the element was an object
+		 */
+		static bool read(JSON_Stream &stream, RecordType &record)
+		{
+			const JSON_Tape *tape = stream.readTape();
+			if (!tape || (*tape)[stream.node].type != JSON_Type::Object)
+				return false;
+
+			std::string decodedKey;
+			for (size_t keyIndex = stream.node + 1; keyIndex < (*tape)[stream.node].next; keyIndex = (*tape)[keyIndex + 1].next)
+			{
+				std::string_view key = tape->text(keyIndex);
+				key = key.substr(1, key.length() - 2);
+
+				// Only decode keys that actually contain escapes
+				if (key.find('\\') != std::string_view::npos)
+				{
+					tape->readString(keyIndex, decodedKey);
+					key = decodedKey;
+				}
+
+				size_t field = FieldIndex(key);
+				if (field != FieldCount)
+					Readers[field](stream, keyIndex + 1, record);
+			}
+			return true;
+		}
+
+		/**
+		 * @brief Writes a record as a JSON object, with members in the order of the fields
+		 */
+		static JSON_Writer& write(JSON_Writer &writer, const RecordType &record)
+		{
+			writer.beginObject();
+			((writer.key(Fields::Name) << record.*Fields::Member), ...);
+			return writer.endObject();
+		}
+
+		static JSON_Stream& write(JSON_Stream &stream, const RecordType &record)
+		{
+			if constexpr ((JSON_Writable<typename Fields::MemberType> && ...))
+			{
+				Buffer text;
+				{
+					JSON_Writer writer{ text };
+					write(writer, record);
+				}
+				stream.elemStream.write((const char*)text.data(), text.size());
+			}
+			else
+			{
+				JSON_Object recordInfo;
+				(recordInfo.writeElement(std::string(Fields::Name), record.*Fields::Member), ...);
+				stream << recordInfo;
+			}
+			return stream;
+		}
+	};
+
+	template <JSON_Bound T>
+	JSON_Stream& operator>>(JSON_Stream &stream, T &record)
+	{
+		JSON_BindingOf<T>::read(stream, record);
+		return stream;
+	}
+
+	template <JSON_Bound T>
+	JSON_Stream& operator<<(JSON_Stream &stream, const T &record)
+	{
+		return JSON_BindingOf<T>::write(stream, record);
+	}
+
+	template <JSON_Bound T>
+	JSON_Writer& operator<<(JSON_Writer &writer, const T &record)
+	{
+		return JSON_BindingOf<T>::write(writer, record);
+	}
+}
\ No newline at end of file
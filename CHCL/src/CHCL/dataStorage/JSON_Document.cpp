@@ -0,0 +1,85 @@
+#include "JSON_Document.h"
+
+chcl::JSON_Type chcl::JSON_Value::type() const
+{
+	return m_document ? m_document->tape()[m_index].type : JSON_Type::Null;
+}
+
+size_t chcl::JSON_Value::size() const
+{
+	// Strings use count to number themselves
+	return is(JSON_Type::Object) || is(JSON_Type::Array) ? m_document->tape()[m_index].count : 0;
+}
+
+std::string_view chcl::JSON_Value::string() const
+{
+	return is(JSON_Type::String) ? m_document->string(m_index) : std::string_view();
+}
+
+chcl::JSON_Value chcl::JSON_Value::operator[](std::string_view key) const
+{
+	if (!is(JSON_Type::Object))
+		return JSON_Value();
+
+	const JSON_Tape &tape = m_document->tape();
+	for (size_t keyIndex = m_index + 1; keyIndex < tape[m_index].next; keyIndex = tape[keyIndex + 1].next)
+	{
+		if (m_document->string(keyIndex) == key)
+			return JSON_Value(m_document, keyIndex + 1);
+	}
+	return JSON_Value();
+}
+
+chcl::JSON_Value chcl::JSON_Value::operator[](size_t position) const
+{
+	if (!is(JSON_Type::Array) || position >= size())
+		return JSON_Value();
+
+	const JSON_Tape &tape = m_document->tape();
+	size_t element = m_index + 1;
+	for (size_t i = 0; i < position; ++i)
+		element = tape[element].next;
+	return JSON_Value(m_document, element);
+}
+
+chcl::JSON_Value chcl::JSON_Value::at(const JSON_Path &path) const
+{
+	if (!m_document)
+		return JSON_Value();
+
+	size_t element = path.find(m_document->tape(), m_index);
+	return element == JSON_Path::npos ? JSON_Value() : JSON_Value(m_document, element);
+}
+
+chcl::JSON_Document::JSON_Document(size_t arenaBlockSize) :
+	m_arena(arenaBlockSize)
+{}
+
+bool chcl::JSON_Document::parse(std::string_view source)
+{
+	m_arena.reset();
+	m_strings = nullptr;
+	if (!m_tape.assign(source.data(), source.length()))
+		return false;
+
+	m_strings = m_arena.allocate<std::string_view>(m_tape.stringCount());
+	for (size_t i = 0; i < m_tape.size(); ++i)
+	{
+		if (m_tape[i].type != JSON_Type::String)
+			continue;
+
+		std::string_view raw = m_tape.text(i);
+		raw = raw.substr(1, raw.length() - 2);
+
+		// Only strings with escape sequences need decoding, the rest are viewed in place
+		std::string_view &decoded = m_strings[m_tape[i].count];
+		if (raw.find('\\') == std::string_view::npos)
+			decoded = raw;
+		else
+		{
+			char *text = m_arena.allocate<char>(raw.length());
+			decoded = std::string_view(text, JSON_Tape::Unescape(raw, text));
+		}
+	}
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <memory>
+#include <string_view>
+
+#include "Arena.h"
+#include "JSON_Parser.h"
+#include "JSON_Path.h"
+#include "JSON_Tape.h"
+
+namespace chcl
+{
+	class JSON_Document;
+
+	/**
+	 * @brief Handle to an element of a JSON_Document, valid until the document is parsed again or destroyed
+	 *
+	 * Lookups on a missing element return another missing element, so paths can be chained without checks.
+	 */
+	class JSON_Value
+	{
+	public:
+		JSON_Value() = default;
+		JSON_Value(const JSON_Document *document, size_t index) : m_document(document), m_index(index) {}
+
+		/// @brief Whether the element exists
+		inline explicit operator bool() const { return m_document != nullptr; }
+
+		/// @brief Type of the element. Missing elements report Null, so check operator bool to tell the two apart
+		JSON_Type type() const;
+		inline bool is(JSON_Type t) const { return m_document && type() == t; }
+
+		/// @brief Number of members or elements, for objects and arrays
+		size_t size() const;
+
+		/// @returns Unescaped contents of a string, or an empty view for other elements
+		std::string_view string() const;
+
+		/// @returns The number, or fallback if the element is not a number representable as T
+		template <JSON_Number T>
+		T number(T fallback = T()) const;
+
+		inline bool boolean(bool fallback = false) const { return is(JSON_Type::True) || (fallback && !is(JSON_Type::False)); }
+
+		/// @returns Member with the given name, or a missing element
+		JSON_Value operator[](std::string_view key) const;
+		/// @returns Array element at the given position, or a missing element
+		JSON_Value operator[](size_t position) const;
+		/// @returns Element the path leads to from this one, or a missing element
+		JSON_Value at(const JSON_Path &path) const;
+
+		/**
+		 * @brief Calls handler(std::string_view key, JSON_Value value) for every member of an object
+		 */
+		template <typename Handler>
+		void forEachMember(Handler &&handler) const;
+
+		/**
+		 * @brief Calls handler(JSON_Value element) for every element of an array
+		 */
+		template <typename Handler>
+		void forEachElement(Handler &&handler) const;
+
+		/**
+		 * @brief Decodes the element through JSON_Stream's operator>>
+		 * T must not keep a reference to the document once read, as JSON_Object and JSON_ObjectView do
+		 */
+		template <typename T>
+		T read() const;
+
+		inline size_t index() const { return m_index; }
+
+	private:
+		const JSON_Document *m_document = nullptr;
+		size_t m_index = 0;
+	};
+
+	/**
+	 * @brief Parsed JSON document whose nodes and decoded strings live in a handful of reusable blocks.
+	 *
+	 * Nodes are stored on a single JSON_Tape and strings containing escape sequences are decoded into an Arena,
+	 * while other strings are viewed in the source directly. The view of each string is kept in the arena as well. Destroying a document therefore frees a few blocks
+	 * regardless of its size, and parsing another document into the same object reuses all of them.
+	 */
+	class JSON_Document
+	{
+	public:
+		/**
+		 * @param arenaBlockSize Size of each block of the arena decoded strings are stored in
+		 */
+		explicit JSON_Document(size_t arenaBlockSize = Arena::DefaultBlockSize);
+
+		JSON_Document(const JSON_Document&) = delete;
+		JSON_Document& operator=(const JSON_Document&) = delete;
+
+		/**
+		 * @brief Parses a document, replacing the previous one and reusing its storage
+		 * @param source JSON text, which must outlive the document or the next call to parse
+		 * @return Whether the source held a well-formed element
+		 */
+		bool parse(std::string_view source);
+
+		inline bool valid() const { return m_tape.valid(); }
+		/// @returns The top level element, or a missing element if the document is not valid
+		inline JSON_Value root() const { return valid() ? JSON_Value(this, 0) : JSON_Value(); }
+
+		inline const JSON_Tape& tape() const { return m_tape; }
+		inline const Arena& arena() const { return m_arena; }
+
+		/// @returns Unescaped contents of a String node
+		inline std::string_view string(size_t index) const { return m_strings[m_tape[index].count]; }
+
+	private:
+		JSON_Tape m_tape;
+		Arena m_arena;
+		/// @brief Decoded contents of each String node, in the arena and indexed by the node's count
+		std::string_view *m_strings = nullptr;
+	};
+
+	template <JSON_Number T>
+	T JSON_Value::number(T fallback) const
+	{
+		T result;
+		return m_document && m_document->tape().readNumber(m_index, result) ? result : fallback;
+	}
+
+	template <typename Handler>
+	void JSON_Value::forEachMember(Handler &&handler) const
+	{
+		if (!is(JSON_Type::Object))
+			return;
+
+		const JSON_Tape &tape = m_document->tape();
+		for (size_t key = m_index + 1; key < tape[m_index].next; key = tape[key + 1].next)
+			handler(m_document->string(key), JSON_Value(m_document, key + 1));
+	}
+
+	template <typename Handler>
+	void JSON_Value::forEachElement(Handler &&handler) const
+	{
+		if (!is(JSON_Type::Array))
+			return;
+
+		const JSON_Tape &tape = m_document->tape();
+		for (size_t element = m_index + 1; element < tape[m_index].next; element = tape[element].next)
+			handler(JSON_Value(m_document, element));
+	}
+
+	template <typename T>
+	T JSON_Value::read() const
+	{
+		T result{};
+		if (!m_document)
+			return result;
+
+		// Non-owning pointer, as the document is not shared
+		std::shared_ptr<const JSON_Tape> tape{ std::shared_ptr<const JSON_Tape>(), &m_document->tape() };
+		JSON_Stream elemStream{ std::move(tape), m_index };
+		elemStream >> result;
+		return result;
+	}
+}
\ No newline at end of file
@@ -10,6 +10,59 @@
 
 namespace chcl
 {
+	namespace JSON_IntegrationDetail
+	{
+		/// @returns Tape index of a member of the object being read, or JSON_Tape::npos
+		inline size_t FindMember(JSON_Stream &stream, std::string_view label)
+		{
+			const JSON_Tape *tape = stream.readTape();
+			return tape ? tape->findMember(stream.node, label) : JSON_Tape::npos;
+		}
+
+		inline size_t ReadSize(JSON_Stream &stream, std::string_view label)
+		{
+			size_t index = FindMember(stream, label);
+			size_t size = 0;
+			if (index != JSON_Tape::npos && !stream.tape->readNumber(index, size))
+				size = 0;
+			return size;
+		}
+
+		/**
+		 * @brief Parses an array member of the object being read straight into memory
+		 * @return Whether the member held exactly count numbers
+		 */
+		template <JSON_Number T>
+		bool ReadValues(JSON_Stream &stream, std::string_view label, T *out, size_t count)
+		{
+			size_t index = FindMember(stream, label);
+			return index != JSON_Tape::npos && stream.tape->readNumbers(index, out, count);
+		}
+
+		/**
+		 * @brief Checks that an array member of the object being read has count elements
+		 * Sizes read from a document are only trusted, and allocated, once the array is known to match them
+		 */
+		inline bool HasArray(JSON_Stream &stream, std::string_view label, size_t count)
+		{
+			size_t index = FindMember(stream, label);
+			if (index == JSON_Tape::npos)
+				return false;
+
+			const JSON_Node &node = (*stream.tape)[index];
+			return node.type == JSON_Type::Array && node.count == count;
+		}
+
+		/// @returns Whether rows * cols fits in a size_t, storing it in count
+		inline bool ElementCount(size_t rows, size_t cols, size_t &count)
+		{
+			if (cols && rows > SIZE_MAX / cols)
+				return false;
+			count = rows * cols;
+			return true;
+		}
+	}
+
 	template <size_t dims, typename T>
 	JSON_Stream& operator<<(JSON_Stream &stream, const VectorN<dims, T> &vec)
 	{
@@ -23,16 +76,26 @@ namespace chcl
 	template <size_t dims, typename T>
 	JSON_Stream& operator>>(JSON_Stream &stream, VectorN<dims, T> &vec)
 	{
-		JSON_Object vecInfo;
-		stream >> vecInfo;
+		if constexpr (JSON_Number<T>)
+		{
+			VectorN<dims, T> result;
+			if (JSON_IntegrationDetail::ReadSize(stream, "size") == dims &&
+				JSON_IntegrationDetail::ReadValues(stream, "components", result.data(), dims))
+				vec = result;
+		}
+		else
+		{
+			JSON_Object vecInfo;
+			stream >> vecInfo;
 
-		if (vecInfo.readElement<size_t>("size") != dims) return stream;
+			if (vecInfo.readElement<size_t>("size") != dims) return stream;
 
-		std::vector<T> components = vecInfo.readElement<std::vector<T>>("components");
-		if (components.size() == dims)
-		{
-			for (size_t i = 0; i < dims; ++i)
-				vec[i] = components[i];
+			std::vector<T> components = vecInfo.readElement<std::vector<T>>("components");
+			if (components.size() == dims)
+			{
+				for (size_t i = 0; i < dims; ++i)
+					vec[i] = components[i];
+			}
 		}
 
 		return stream;
@@ -52,18 +115,29 @@ namespace chcl
 	template <size_t rows, size_t cols, typename T>
 	JSON_Stream& operator>>(JSON_Stream &stream, Matrix<rows, cols, T> &mat)
 	{
-		JSON_Object matInfo;
-		stream >> matInfo;
+		if constexpr (JSON_Number<T>)
+		{
+			Matrix<rows, cols, T> result;
+			if (JSON_IntegrationDetail::ReadSize(stream, "rows") == rows &&
+				JSON_IntegrationDetail::ReadSize(stream, "cols") == cols &&
+				JSON_IntegrationDetail::ReadValues(stream, "values", result.data(), rows * cols))
+				mat = result;
+		}
+		else
+		{
+			JSON_Object matInfo;
+			stream >> matInfo;
 
-		if (matInfo.readElement<size_t>("rows") != rows) return stream;
-		if (matInfo.readElement<size_t>("cols") != cols) return stream;
+			if (matInfo.readElement<size_t>("rows") != rows) return stream;
+			if (matInfo.readElement<size_t>("cols") != cols) return stream;
 		
-		std::vector<T> values = matInfo.readElement<std::vector<T>>("values");
-		if (values.size() == mat.Count())
-		{
-			for (size_t i = 0; i < rows; ++i)
-				for (size_t j = 0; j < cols; ++j)
-					mat.at(i, j) = values[mat.IndexOf(i, j)];
+			std::vector<T> values = matInfo.readElement<std::vector<T>>("values");
+			if (values.size() == mat.Count())
+			{
+				for (size_t i = 0; i < rows; ++i)
+					for (size_t j = 0; j < cols; ++j)
+						mat.at(i, j) = values[mat.IndexOf(i, j)];
+			}
 		}
 
 		return stream;
@@ -82,14 +156,27 @@ namespace chcl
 	template <typename T>
 	JSON_Stream& operator>>(JSON_Stream &stream, DynamicVector<T> &vec)
 	{
-		JSON_Object vecInfo;
-		stream >> vecInfo;
-
-		size_t size = vecInfo.readElement<size_t>("size");
-		std::vector<T> components = vecInfo.readElement<std::vector<T>>("components");
-		if (components.size() == size)
+		if constexpr (JSON_Number<T>)
 		{
-			vec = std::move(DynamicVector<T>(components));
+			size_t size = JSON_IntegrationDetail::ReadSize(stream, "size");
+			if (JSON_IntegrationDetail::HasArray(stream, "components", size))
+			{
+				DynamicVector<T> result(size);
+				if (JSON_IntegrationDetail::ReadValues(stream, "components", result.data(), size))
+					vec = std::move(result);
+			}
+		}
+		else
+		{
+			JSON_Object vecInfo;
+			stream >> vecInfo;
+
+			size_t size = vecInfo.readElement<size_t>("size");
+			std::vector<T> components = vecInfo.readElement<std::vector<T>>("components");
+			if (components.size() == size)
+			{
+				vec = std::move(DynamicVector<T>(components));
+			}
 		}
 
 		return stream;
@@ -109,17 +196,71 @@ namespace chcl
 	template <typename T>
 	JSON_Stream& operator>>(JSON_Stream &stream, DynamicMatrix<T> &mat)
 	{
-		JSON_Object matInfo;
-		stream >> matInfo;
-
-		size_t rows = matInfo.readElement<size_t>("rows");
-		size_t cols = matInfo.readElement<size_t>("cols");
-		std::vector<T> values = matInfo.readElement<std::vector<T>>("values");
-		if (values.size() == rows * cols)
+		if constexpr (JSON_Number<T>)
 		{
-			mat = std::move(DynamicMatrix<T>(rows, cols, values));
+			size_t rows = JSON_IntegrationDetail::ReadSize(stream, "rows");
+			size_t cols = JSON_IntegrationDetail::ReadSize(stream, "cols");
+			size_t count;
+			if (JSON_IntegrationDetail::ElementCount(rows, cols, count) && JSON_IntegrationDetail::HasArray(stream, "values", count))
+			{
+				DynamicMatrix<T> result(rows, cols);
+				if (JSON_IntegrationDetail::ReadValues(stream, "values", result.data(), count))
+					mat = std::move(result);
+			}
+		}
+		else
+		{
+			JSON_Object matInfo;
+			stream >> matInfo;
+
+			size_t rows = matInfo.readElement<size_t>("rows");
+			size_t cols = matInfo.readElement<size_t>("cols");
+			std::vector<T> values = matInfo.readElement<std::vector<T>>("values");
+			size_t count;
+			if (JSON_IntegrationDetail::ElementCount(rows, cols, count) && values.size() == count)
+			{
+				mat = std::move(DynamicMatrix<T>(rows, cols, values));
+			}
 		}
 
 		return stream;
 	}
+
+	template <size_t dims, typename T> requires std::is_arithmetic_v<T>
+	JSON_Writer& operator<<(JSON_Writer &writer, const VectorN<dims, T> &vec)
+	{
+		writer.beginObject();
+		writer.key("size").value(dims);
+		writer.key("components").values(vec.data(), dims);
+		return writer.endObject();
+	}
+
+	template <size_t rows, size_t cols, typename T> requires std::is_arithmetic_v<T>
+	JSON_Writer& operator<<(JSON_Writer &writer, const Matrix<rows, cols, T> &mat)
+	{
+		writer.beginObject();
+		writer.key("rows").value(rows);
+		writer.key("cols").value(cols);
+		writer.key("values").values(mat.data(), rows * cols);
+		return writer.endObject();
+	}
+
+	template <typename T> requires std::is_arithmetic_v<T>
+	JSON_Writer& operator<<(JSON_Writer &writer, const DynamicVector<T> &vec)
+	{
+		writer.beginObject();
+		writer.key("size").value(vec.size());
+		writer.key("components").values(vec.data(), vec.size());
+		return writer.endObject();
+	}
+
+	template <typename T> requires std::is_arithmetic_v<T>
+	JSON_Writer& operator<<(JSON_Writer &writer, const DynamicMatrix<T> &mat)
+	{
+		writer.beginObject();
+		writer.key("rows").value(mat.rows());
+		writer.key("cols").value(mat.cols());
+		writer.key("values").values(mat.data(), mat.count());
+		return writer.endObject();
+	}
 }
\ No newline at end of file
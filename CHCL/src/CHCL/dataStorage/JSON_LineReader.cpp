@@ -0,0 +1,180 @@
+#include "JSON_LineReader.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+bool chcl::JSON_LineReader::Scratch::parse(std::string_view line)
+{
+	if (!m_tape || m_tape.use_count() > 1)
+		m_tape = std::make_shared<JSON_Tape>();
+	return m_tape->assign(line.data(), line.length());
+}
+
+void chcl::JSON_LineReader::Scratch::release()
+{
+	if (m_tape)
+		m_tape->ownSource();
+	// Not reused even once its other owners are gone, as they may have released it on another thread
+	m_tape.reset();
+}
+
+chcl::JSON_LineReader::JSON_LineReader(const char *data, size_t length, size_t threadCount, size_t chunkSize) :
+	m_text(data, length),
+	m_threadCount(threadCount ? threadCount : std::max<size_t>(std::thread::hardware_concurrency(), 1))
+{
+	split(chunkSize);
+}
+
+chcl::JSON_LineReader::JSON_LineReader(std::unique_ptr<Snapshot::MappedFile> file, size_t threadCount, size_t chunkSize) :
+	m_file(std::move(file)),
+	m_threadCount(threadCount ? threadCount : std::max<size_t>(std::thread::hardware_concurrency(), 1)),
+	m_valid(bool(*m_file))
+{
+	if (m_valid)
+		m_text = std::string_view((const char*)m_file->data(), m_file->size());
+	split(chunkSize);
+}
+
+chcl::JSON_LineReader chcl::JSON_LineReader::FromFile(const std::string &filename, size_t threadCount, size_t chunkSize)
+{
+	return JSON_LineReader(std::make_unique<Snapshot::MappedFile>(filename), threadCount, chunkSize);
+}
+
+void chcl::JSON_LineReader::split(size_t chunkSize)
+{
+	chunkSize = std::max<size_t>(chunkSize, 1);
+
+	// Each chunk is extended to the end of the line it would otherwise cut through
+	size_t begin = 0;
+	while (begin < m_text.length())
+	{
+		size_t end = begin + chunkSize;
+		if (end >= m_text.length())
+			end = m_text.length();
+		else
+		{
+			size_t newLine = m_text.find('\n', end);
+			end = newLine == std::string_view::npos ? m_text.length() : newLine + 1;
+		}
+
+		m_chunks.push_back(Chunk{ begin, end });
+		begin = end;
+	}
+}
+
+void chcl::JSON_LineReader::run(const std::function<void(size_t, Scratch&)> &parseChunk, const std::function<void(size_t)> &deliverChunk, Delivery delivery)
+{
+	const size_t chunkCount = m_chunks.size();
+	if (chunkCount == 0)
+		return;
+
+	const size_t workerCount = std::min(m_threadCount, chunkCount);
+	// Bounds how far workers may run ahead of delivery, and with it the memory held by parsed chunks
+	const size_t window = deliverChunk ? workerCount * 2 : chunkCount;
+
+	std::mutex mutex;
+	std::condition_variable chunkParsed, chunkDelivered;
+	size_t nextChunk = 0;
+	size_t deliveredCount = 0;
+	std::vector<bool> parsed(chunkCount, false);
+	std::vector<size_t> parsedOrder;
+	std::exception_ptr error;
+
+	// Called with the lock held. No more chunks are handed out, so every thread winds down
+	auto fail = [&]()
+	{
+		if (!error)
+			error = std::current_exception();
+		nextChunk = chunkCount;
+		chunkParsed.notify_all();
+		chunkDelivered.notify_all();
+	};
+
+	auto work = [&]()
+	{
+		Scratch scratch;
+		std::unique_lock lock(mutex);
+		while (true)
+		{
+			chunkDelivered.wait(lock, [&]() { return nextChunk >= chunkCount || nextChunk < deliveredCount + window; });
+			if (nextChunk >= chunkCount)
+				return;
+
+			size_t chunk = nextChunk++;
+			lock.unlock();
+			try
+			{
+				parseChunk(chunk, scratch);
+			}
+			catch (...)
+			{
+				lock.lock();
+				fail();
+				return;
+			}
+			lock.lock();
+
+			parsed[chunk] = true;
+			parsedOrder.push_back(chunk);
+			chunkParsed.notify_one();
+		}
+	};
+
+	std::vector<std::thread> workers;
+	if (!deliverChunk)
+	{
+		// The calling thread has nothing to deliver, so it parses alongside the workers
+		for (size_t i = 1; i < workerCount; ++i)
+			workers.emplace_back(work);
+		work();
+	}
+	else
+	{
+		for (size_t i = 0; i < workerCount; ++i)
+			workers.emplace_back(work);
+
+		std::unique_lock lock(mutex);
+		size_t parsedIndex = 0;
+		while (deliveredCount < chunkCount)
+		{
+			size_t chunk;
+			if (delivery == Delivery::Ordered)
+			{
+				chunk = deliveredCount;
+				chunkParsed.wait(lock, [&]() { return parsed[chunk] || error; });
+			}
+			else
+			{
+				chunkParsed.wait(lock, [&]() { return parsedIndex < parsedOrder.size() || error; });
+				chunk = error ? 0 : parsedOrder[parsedIndex++];
+			}
+			if (error)
+				break;
+
+			lock.unlock();
+			try
+			{
+				deliverChunk(chunk);
+			}
+			catch (...)
+			{
+				lock.lock();
+				fail();
+				break;
+			}
+			lock.lock();
+
+			++deliveredCount;
+			chunkDelivered.notify_all();
+		}
+	}
+
+	for (std::thread &worker : workers)
+		worker.join();
+
+	if (error)
+		std::rethrow_exception(error);
+}
\ No newline at end of file
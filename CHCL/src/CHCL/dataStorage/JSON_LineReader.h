@@ -0,0 +1,201 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "JSON_Parser.h"
+#include "JSON_Tape.h"
+#include "Snapshot.h"
+
+namespace chcl
+{
+	/**
+	 * @brief Parses newline-delimited JSON (NDJSON / JSON Lines) on a pool of worker threads.
+	 *
+	 * The text is split into chunks that each end on a line boundary, and each worker parses whole chunks
+	 * into its own scratch tape, so steady-state parsing does not allocate and workers never contend on the allocator.
+	 * Blank lines are skipped.
+	 */
+	class JSON_LineReader
+	{
+	public:
+		static constexpr size_t DefaultChunkSize = 1024 * 1024;
+
+		enum class Delivery : uint8_t
+		{
+			Ordered, ///< Documents are delivered in the order they appear in the text
+			Unordered ///< Chunks are delivered as soon as they are parsed. Documents within a chunk keep their order
+		};
+
+		/**
+		 * @brief Per-worker parsing state, reused for every line the worker parses
+		 */
+		class Scratch
+		{
+		public:
+			/**
+			 * @brief Parses a line into the scratch tape
+			 * If a previous document is still referenced elsewhere, such as by a JSON_Object read from it, a new tape is started instead
+			 * @return Whether the line held a well-formed element
+			 */
+			bool parse(std::string_view line);
+
+			inline const std::shared_ptr<JSON_Tape>& document() const { return m_tape; }
+
+			/**
+			 * @brief Hands the current document over to whatever else references it, so the next parse starts a new tape
+			 * The document takes a copy of the text it borrows, so it may outlive the reader
+			 */
+			void release();
+
+		private:
+			std::shared_ptr<JSON_Tape> m_tape;
+		};
+
+		/**
+		 * @brief Reads a document already in memory, such as a mapped file, without copying it
+		 * @param data NDJSON text, which must outlive the reader
+		 * @param length Length of the text in bytes
+		 * @param threadCount Number of worker threads. 0 uses one per hardware thread
+		 * @param chunkSize Approximate number of bytes handed to a worker at a time
+		 */
+		JSON_LineReader(const char *data, size_t length, size_t threadCount = 0, size_t chunkSize = DefaultChunkSize);
+
+		/**
+		 * @brief Maps a file into memory to parse, without copying it
+		 * A named function, as a constructor taking a filename would be confused with the one taking text.
+		 * If the file cannot be opened, or is empty, the reader is invalid and parseAll and readAll return false
+		 */
+		static JSON_LineReader FromFile(const std::string &filename, size_t threadCount = 0, size_t chunkSize = DefaultChunkSize);
+
+		JSON_LineReader(const JSON_LineReader&) = delete;
+		JSON_LineReader& operator=(const JSON_LineReader&) = delete;
+
+		/// @brief Whether the text is available, which is only false when FromFile could not map its file
+		inline explicit operator bool() const { return m_valid; }
+
+		inline size_t threadCount() const { return m_threadCount; }
+		inline size_t chunkCount() const { return m_chunks.size(); }
+
+		/**
+		 * @brief Parses every line, passing each document to a handler on the worker thread that parsed it
+		 * @param handler Callable taking a const JSON_Tape&, called concurrently from several threads.
+		 * The tape is only valid for the duration of the call, and its source() is the line's text
+		 * @return Whether the text was available and every line was well-formed JSON. Malformed lines are not passed to the handler
+		 * @throws Anything the handler throws, rethrown on the calling thread once every worker has stopped
+		 */
+		template <typename Handler>
+		bool parseAll(Handler &&handler)
+		{
+			std::atomic<bool> valid = m_valid;
+			run([&](size_t chunk, Scratch &scratch)
+				{
+					forEachLine(chunk, [&](std::string_view line)
+						{
+							if (scratch.parse(line))
+								handler(static_cast<const JSON_Tape&>(*scratch.document()));
+							else
+								valid.store(false, std::memory_order_relaxed);
+						});
+				}, nullptr, Delivery::Unordered);
+			return valid;
+		}
+
+		/**
+		 * @brief Decodes every line as T on the worker threads, and passes the results to a consumer on the calling thread
+		 * @tparam T Type to decode each line as, through JSON_Stream's operator>>
+		 * @param consumer Callable taking a T&&. Only ever called from the calling thread. Values may outlive the reader
+		 * @param delivery Whether documents must reach the consumer in text order
+		 * @return Whether the text was available and every line was well-formed JSON. Malformed lines are skipped
+		 * @throws Anything decoding or the consumer throws, rethrown on the calling thread once every worker has stopped
+		 */
+		template <typename T, typename Consumer>
+		bool readAll(Consumer &&consumer, Delivery delivery = Delivery::Ordered)
+		{
+			std::vector<std::vector<T>> results(m_chunks.size());
+			std::atomic<bool> valid = m_valid;
+			run([&](size_t chunk, Scratch &scratch)
+				{
+					std::vector<T> &values = results[chunk];
+					forEachLine(chunk, [&](std::string_view line)
+						{
+							if (!scratch.parse(line))
+							{
+								valid.store(false, std::memory_order_relaxed);
+								return;
+							}
+
+							T value{};
+							{
+								JSON_Stream elemStream{ scratch.document(), 0 };
+								elemStream >> value;
+							}
+
+							// Values such as JSON_Object keep the document they were read from
+							if (scratch.document().use_count() > 1)
+								scratch.release();
+							values.push_back(std::move(value));
+						});
+				},
+				[&](size_t chunk)
+				{
+					for (T &value : results[chunk])
+						consumer(std::move(value));
+					results[chunk] = std::vector<T>();
+				}, delivery);
+			return valid;
+		}
+
+	private:
+		struct Chunk
+		{
+			size_t begin;
+			size_t end;
+		};
+
+		std::unique_ptr<Snapshot::MappedFile> m_file; ///< Null if the text is borrowed
+		std::string_view m_text;
+		std::vector<Chunk> m_chunks;
+		size_t m_threadCount;
+		bool m_valid = true;
+
+		/// @brief Takes ownership of a mapped file
+		JSON_LineReader(std::unique_ptr<Snapshot::MappedFile> file, size_t threadCount, size_t chunkSize);
+
+		void split(size_t chunkSize);
+
+		/**
+		 * @brief Parses every chunk on the worker pool, and delivers them on the calling thread
+		 * The first exception thrown on any thread stops the remaining chunks, and is rethrown once the workers have finished
+		 * @param parseChunk Called on a worker for each chunk, with that worker's scratch
+		 * @param deliverChunk Called on the calling thread for each parsed chunk, or nullptr to only parse
+		 * @param delivery Order to deliver chunks in
+		 */
+		void run(const std::function<void(size_t, Scratch&)> &parseChunk, const std::function<void(size_t)> &deliverChunk, Delivery delivery);
+
+		template <typename LineHandler>
+		void forEachLine(size_t chunk, LineHandler &&handleLine) const
+		{
+			const char *position = m_text.data() + m_chunks[chunk].begin;
+			const char *end = m_text.data() + m_chunks[chunk].end;
+			while (position < end)
+			{
+				const char *lineEnd = (const char*)std::memchr(position, '\n', end - position);
+				if (!lineEnd)
+					lineEnd = end;
+
+				std::string_view line{ position, size_t(lineEnd - position) };
+				if (line.find_first_not_of(" \t\r") != std::string_view::npos)
+					handleLine(line);
+				position = lineEnd + 1;
+			}
+		}
+	};
+}
\ No newline at end of file
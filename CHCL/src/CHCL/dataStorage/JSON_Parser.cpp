@@ -1,79 +1,39 @@
 #include "JSON_Parser.h"
 
-chcl::JSON_Stream& chcl::operator>>(JSON_Stream &stream, std::string &str)
-{
-	str.clear();
-
-	bool escapedChar = false;
-	std::string elemStr = stream.str();
+#include "JSON_Strings.h"
 
-	if (elemStr[0] != '\"') return stream;
-
-	for (size_t i = 1; i < elemStr.length() - 1; ++i)
+const chcl::JSON_Tape* chcl::JSON_Stream::readTape()
+{
+	if (!tape)
 	{
-		char currentChar = elemStr[i];
-
-		if (escapedChar)
-		{
-			switch (currentChar)
-			{
-				case '\"':
-					str.push_back('\"');
-					break;
-				case '\\':
-					str.push_back('\\');
-					break;
-				case 'n':
-					str.push_back('\n');
-					break;
-				case 'r':
-					str.push_back('\r');
-					break;
-				case 't':
-					str.push_back('\t');
-					break;
-				default:
-					str.push_back(currentChar);
-			}
-
-			escapedChar = false;
-			continue;
-		}
+		tape = std::make_shared<const JSON_Tape>(elemStream.str());
+		node = 0;
+	}
+	return tape->valid() ? tape.get() : nullptr;
+}
 
-		if (currentChar == '\\')
-		{
-			escapedChar = true;
-			continue;
-		}
+chcl::JSON_Stream& chcl::operator>>(JSON_Stream &stream, std::string &str)
+{
+	str.clear();
 
-		str.push_back(currentChar);
-	}
+	const JSON_Tape *tape = stream.readTape();
+	if (tape)
+		tape->readString(stream.node, str);
 	return stream;
 }
 
 chcl::JSON_Stream& chcl::operator>>(JSON_Stream &stream, bool &val)
 {
-	val = (stream.str() == "true");
+	const JSON_Tape *tape = stream.readTape();
+	val = tape && (*tape)[stream.node].type == JSON_Type::True;
 	return stream;
 }
 
 chcl::JSON_Stream& chcl::operator<<(JSON_Stream &stream, const std::string &str)
 {
-	stream << '\"';
-	for (char c : str)
-	{
-		switch (c)
-		{
-			case '\\':
-			case '\"':
-			case '\n':
-			case '\r':
-			case '\t':
-				stream << '\\';
-		}
-		stream << c;
-	}
-	stream << '\"';
+	stream.elemStream.put('\"');
+	JSON_Strings::Escape(str, [&stream](const char *data, size_t length) { stream.elemStream.write(data, std::streamsize(length)); });
+	stream.elemStream.put('\"');
 	return stream;
 }
 
@@ -86,200 +46,137 @@ chcl::JSON_Stream& chcl::operator<<(JSON_Stream &stream, bool val)
 	return stream;
 }
 
-bool chcl::JSON_Parser::JumpWhitespace(const std::string &text, size_t &index)
-{
-	while (index < text.length())
-	{
-		switch (text[index])
-		{
-			case ' ':
-			case '\t':
-			case '\n':
-			case '\r':
-				++index;
-				break;
-			default:
-				return true;
-		}
-	}
-	return false;
-}
-
-bool chcl::JSON_Parser::JumpSection(const std::string &text, size_t &index)
+chcl::JSON_Stream& chcl::operator>>(JSON_Stream &stream, JSON_Object &obj)
 {
-	if (text[index] != '{') return false;
+	obj.clear();
 
-	// Used as an emergency tracker in case of malformed file
-	size_t lastIndex = index;
+	const JSON_Tape *tape = stream.readTape();
+	if (!tape || (*tape)[stream.node].type != JSON_Type::Object) return stream;
 
-	++index;
-	JumpWhitespace(text, index);
+	const JSON_Node &object = (*tape)[stream.node];
+	obj.m_tape = stream.tape;
+	obj.m_nodes.reserve(object.count);
 
-	while (index < text.length() && index != lastIndex)
+	std::string label;
+	for (size_t index = stream.node + 1; index < object.next; index = (*tape)[index + 1].next)
 	{
-		lastIndex = index;
-
-		// Skip label
-		if (!JumpString(text, index)) break;
-		// Skip ':' and jump to next element
-		JumpWhitespace(text, index);
-		if (text[index] == ':') ++index;
-		else break;
-		JumpWhitespace(text, index);
-		// Skip next element
-		if (!JumpElement(text, index)) break;
-		JumpWhitespace(text, index);
-		if (text[index] == ',') ++index;
-		JumpWhitespace(text, index);
-
-		if (text[index] == '}')
-		{
-			++index;
-			return true;
-		}
+		tape->readString(index, label);
+		obj.m_nodes.insert_or_assign(label, index + 1);
 	}
-	return false;
+
+	return stream;
 }
 
-bool chcl::JSON_Parser::JumpArray(const std::string &text, size_t &index)
+chcl::JSON_Stream& chcl::operator<<(JSON_Stream &stream, const JSON_Object &obj)
 {
-	if (text[index] != '[') return false;
-
-	size_t lastIndex = index;
-
-	++index;
-	JumpWhitespace(text, ++index);
+	stream.elemStream << "{\n";
+	bool firstLine = true;
 
-	while (index < text.length() && index != lastIndex)
+	auto writeMember = [&](const std::string &label, std::string_view value)
 	{
-		lastIndex = index;
+		if (firstLine)
+			firstLine = false;
+		else
+			stream.elemStream << ",\n";
 
-		// Skip the next element
-		// If the element was deemed malformed, abandon and report the malform
-		if (!JumpElement(text, index)) break;
-		if (text[index] == ',') ++index;
-		JumpWhitespace(text, index);
+		stream.elemStream << '\t';
+		stream << label;
+		stream.elemStream << ": ";
 
-		if (text[index] == ']')
+		size_t lineBegin = 0;
+		size_t lineEnd;
+		while ((lineEnd = value.find('\n', lineBegin)) != std::string_view::npos)
 		{
-			++index;
-			return true;
+			stream.elemStream << value.substr(lineBegin, lineEnd - lineBegin) << "\n\t";
+			lineBegin = lineEnd + 1;
 		}
-	}
-	return false;
-}
+		stream.elemStream << value.substr(lineBegin);
+	};
 
-bool chcl::JSON_Parser::JumpString(const std::string &text, size_t &index)
-{
-	if (text[index] != '\"') return false;
+	for (auto const& [label, value] : obj.m_elements)
+		writeMember(label, value);
+	for (auto const& [label, index] : obj.m_nodes)
+		writeMember(label, obj.m_tape->json(index));
 
-	++index;
+	stream.elemStream << "\n}";
+	return stream;
+}
 
-	while (index < text.length())
-	{
-		switch (text[index++])
-		{
-			case '\\':
-				++index;
-				break;
-			case '\"':
-				return true;
-		}
-	}
-	return false;
+chcl::JSON_ObjectView chcl::JSON_Parser::ParseView(std::string_view source)
+{
+	return JSON_ObjectView(std::make_shared<const JSON_Tape>(source.data(), source.length()));
 }
 
-bool chcl::JSON_Parser::JumpElement(const std::string &text, size_t &index)
+chcl::JSON_ObjectView::JSON_ObjectView(std::shared_ptr<const JSON_Tape> tape, size_t node)
 {
-	while (index < text.length())
+	if (tape && tape->valid() && (*tape)[node].type == JSON_Type::Object)
 	{
-		switch (text[index])
-		{
-			case '{':
-				return JumpSection(text, index);
-			case '[':
-				return JumpArray(text, index);
-			case '\"':
-				return JumpString(text, index);
-			case ',':
-			case '}':
-			case ']':
-			case ' ':
-			case '\t':
-			case '\n':
-			case '\r':
-				return true;
-			default:
-				++index;
-				break;
-		}
+		m_tape = std::move(tape);
+		m_node = node;
 	}
-	return true;
 }
 
-chcl::JSON_Stream& chcl::operator>>(JSON_Stream &stream, JSON_Object &obj)
+size_t chcl::JSON_ObjectView::find(std::string_view label) const
 {
-	obj.clear();
+	return m_tape ? m_tape->findMember(m_node, label) : JSON_Tape::npos;
+}
 
-	size_t index = 1;
-	std::string elemStr = stream.str();
+std::string_view chcl::JSON_ObjectView::rawElement(std::string_view label) const
+{
+	size_t index = find(label);
+	return index == JSON_Tape::npos || m_tape->binary() ? std::string_view() : m_tape->text(index);
+}
 
-	if (elemStr[0] != '{') return stream;
+std::vector<std::string_view> chcl::JSON_ObjectView::labels() const
+{
+	std::vector<std::string_view> result;
+	if (!m_tape) return result;
 
-	JSON_Parser::JumpWhitespace(elemStr, index);
-	while (index < elemStr.length())
+	const JSON_Tape &tape = *m_tape;
+	result.reserve(tape[m_node].count);
+	for (size_t index = m_node + 1; index < tape[m_node].next; index = tape[index + 1].next)
 	{
-		size_t labelBegin = index;
-		JSON_Parser::JumpElement(elemStr, index);
-		std::string label;
-		JSON_Stream labelStream{ elemStr.substr(labelBegin, index - labelBegin) };
-		labelStream >> label;
-
-		// Jump over ':' character and whitespace
-		JSON_Parser::JumpWhitespace(elemStr, index);
-		++index;
-		JSON_Parser::JumpWhitespace(elemStr, index);
+		std::string_view label = tape.text(index);
+		result.push_back(label.substr(1, label.length() - 2));
+	}
+	return result;
+}
 
-		size_t elemBegin = index;
-		JSON_Parser::JumpElement(elemStr, index);
-		obj.m_elements[label] = elemStr.substr(elemBegin, index - elemBegin);
-		// Jump over ',' character and whitespace
-		JSON_Parser::JumpWhitespace(elemStr, index);
-		++index;
-		JSON_Parser::JumpWhitespace(elemStr, index);
+size_t chcl::JSON_ObjectView::size() const
+{
+	return m_tape ? (*m_tape)[m_node].count : 0;
+}
 
-		// Return if we reached the end of the section
-		if (elemStr[index] == '}')
-			break;
-	}
+chcl::JSON_Stream& chcl::operator>>(JSON_Stream &stream, JSON_ObjectView &obj)
+{
+	const JSON_Tape *tape = stream.readTape();
+	obj = tape ? JSON_ObjectView(stream.tape, stream.node) : JSON_ObjectView();
+	return stream;
+}
 
+chcl::JSON_Stream& chcl::operator<<(JSON_Stream &stream, const JSON_ObjectView &obj)
+{
+	if (obj.m_tape)
+		stream.elemStream << obj.m_tape->json(obj.m_node);
+	else
+		stream.elemStream << "{}";
 	return stream;
 }
 
-chcl::JSON_Stream& chcl::operator<<(JSON_Stream &stream, const JSON_Object &obj)
+chcl::JSON_Writer& chcl::operator<<(JSON_Writer &writer, const JSON_Object &obj)
 {
-	stream.elemStream << "{\n";
-	bool firstLine = true;
+	writer.beginObject();
 	for (auto const& [label, value] : obj.m_elements)
-	{
-		if (firstLine)
-			firstLine = false;
-		else
-			stream.elemStream << ",\n";
+		writer.key(label).rawValue(value);
+	for (auto const& [label, index] : obj.m_nodes)
+		writer.key(label).element(*obj.m_tape, index);
+	return writer.endObject();
+}
 
-		stream.elemStream << '\t';
-		stream << label;
-		stream.elemStream << ": ";
+chcl::JSON_Writer& chcl::operator<<(JSON_Writer &writer, const JSON_ObjectView &obj)
+{
+	if (!obj.m_tape)
+		return writer.beginObject().endObject();
 
-		std::string valueLine;
-		std::istringstream valueStream{ value };
-		while (std::getline(valueStream, valueLine))
-		{
-			stream.elemStream << valueLine;
-			if (!valueStream.eof())
-				stream.elemStream << "\n\t";
-		}
-	}
-	stream.elemStream << "\n}";
-	return stream;
+	return writer.element(*obj.m_tape, obj.m_node);
 }
\ No newline at end of file
@@ -1,13 +1,31 @@
 #pragma once
 
+#include <charconv>
+#include <cmath>
 #include <fstream>
+#include <memory>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
+#include "JSON_Tape.h"
+#include "JSON_Writer.h"
+
 namespace chcl
 {
+	struct JSON_ObjectView;
+
+	/**
+	 * @brief Specialize with a JSON_Binding to generate JSON reading and writing code for a type. See JSON_Binding.h
+	 */
+	template <typename T>
+	struct JSON_BindingOf;
+
+	template <typename T>
+	concept JSON_Bound = requires { JSON_BindingOf<T>::FieldCount; };
+
 	/**
 	 * @brief Class for converting objects to/from JSON syntax.
 	 * 
@@ -17,10 +35,22 @@ namespace chcl
 	{
 		std::stringstream elemStream;
 
+		/// @brief Parsed document the element being read belongs to
+		std::shared_ptr<const JSON_Tape> tape;
+		/// @brief Tape index of the element being read
+		size_t node = 0;
+
 		JSON_Stream() = default;
 		JSON_Stream(const std::string &elem) : elemStream(elem) {}
+		JSON_Stream(std::shared_ptr<const JSON_Tape> tape, size_t node) : tape(std::move(tape)), node(node) {}
 
-		inline std::string str() const { return elemStream.str(); }
+		inline std::string str() const { return tape ? tape->json(node) : elemStream.str(); }
+
+		/**
+		 * @brief Gets the tape to read the element from, parsing the stream's text if it has none yet
+		 * @return Parsed tape, or nullptr if the text is not valid JSON
+		 */
+		const JSON_Tape* readTape();
 
 		template <typename T>
 		friend JSON_Stream& operator>>(JSON_Stream &stream, T &elem);
@@ -31,7 +61,7 @@ namespace chcl
 		friend JSON_Stream& operator>>(JSON_Stream &stream, std::string &str);
 		friend JSON_Stream& operator>>(JSON_Stream &stream, bool &val);
 
-		template <typename T>
+		template <typename T> requires (!JSON_Bound<T>)
 		friend JSON_Stream& operator<<(JSON_Stream &stream, T elem);
 
 		template <typename T>
@@ -46,12 +76,6 @@ namespace chcl
 	 */
 	namespace JSON_Parser
 	{
-		bool JumpWhitespace(const std::string &text, size_t &index);
-		bool JumpSection(const std::string &text, size_t &index);
-		bool JumpArray(const std::string &text, size_t &index);
-		bool JumpString(const std::string &text, size_t &index);
-		bool JumpElement(const std::string &text, size_t &index);
-
 		/**
 		 * @brief Converts a string representing a JSON element to the appropriate object
 		 * @tparam T Type to convert to
@@ -59,18 +83,29 @@ namespace chcl
 		 * @return Parsed object
 		 */
 		template <typename T>
-		static T ParseElement(const std::string &elem)
+		static T ParseElement(std::string &&elem)
 		{
-			size_t index = 0;
-			JSON_Parser::JumpWhitespace(elem, index);
-			size_t elemBegin = index;
-			if (!JSON_Parser::JumpElement(elem, index)) return T();
-			JSON_Stream elemStream{ elem.substr(elemBegin, index - elemBegin) };
-			T result;
+			auto tape = std::make_shared<const JSON_Tape>(std::move(elem));
+			if (!tape->valid()) return T();
+			JSON_Stream elemStream{ std::move(tape), 0 };
+			T result{};
 			elemStream >> result;
 			return result;
 		}
 
+		template <typename T>
+		static T ParseElement(const std::string &elem)
+		{
+			return JSON_Parser::ParseElement<T>(std::string(elem));
+		}
+
+		/**
+		 * @brief Parses a JSON object without copying its text
+		 * @param source JSON text, which must outlive the view and any views read from it
+		 * @return View of the object, empty if the source is not a valid object
+		 */
+		JSON_ObjectView ParseView(std::string_view source);
+
 		/**
 		 * @brief Reads and parses the contents of a .json file
 		 * @tparam T
@@ -80,26 +115,44 @@ namespace chcl
 		template <typename T>
 		static T ReadFile(const std::string &filename)
 		{
-			std::ifstream file{ filename };
-			std::stringstream fileString;
-			fileString << file.rdbuf();
+			std::ifstream file{ filename, std::ios::binary | std::ios::ate };
+			std::streamoff fileSize = file.tellg();
+			if (fileSize < 0) return T();
+
+			// Read straight into the string the tape takes ownership of, so the text is never copied
+			std::string contents(size_t(fileSize), '\0');
+			file.seekg(0, std::ios::beg);
+			file.read(contents.data(), fileSize);
+			contents.resize(size_t(file.gcount()));
 			file.close();
-			return JSON_Parser::ParseElement<T>(fileString.str());
+			return JSON_Parser::ParseElement<T>(std::move(contents));
 		}
 
 		/**
 		 * @brief Saves the object to a JSON file
+		 * Objects with a JSON_Writer overload are written in a single pass, others through JSON_Stream
 		 * @tparam T Object type to save
 		 * @param filename Filename
 		 * @param object Object to save
+		 * @param style Layout used when writing through JSON_Writer
 		 */
 		template <typename T>
-		static void SaveToFile(const std::string &filename, const T &object)
+		static void SaveToFile(const std::string &filename, const T &object, JSON_Writer::Style style = JSON_Writer::Style::Pretty)
 		{
-			JSON_Stream formatStream;
-			formatStream << object;
-			std::ofstream fileStream{ filename };
-			fileStream << formatStream.elemStream.rdbuf();
+			std::ofstream fileStream{ filename, std::ios::binary };
+			if constexpr (JSON_Writable<T>)
+			{
+				Buffer text;
+				JSON_Writer writer{ text, style };
+				writer << object;
+				fileStream.write((const char*)text.data(), text.size());
+			}
+			else
+			{
+				JSON_Stream formatStream;
+				formatStream << object;
+				fileStream << formatStream.elemStream.rdbuf();
+			}
 			fileStream.close();
 		}
 	};
@@ -117,7 +170,19 @@ namespace chcl
 		 * @return 
 		 */
 		template <typename T>
-		T readElement(const std::string &label) { return JSON_Parser::ParseElement<T>(m_elements[label]); }
+		T readElement(const std::string &label)
+		{
+			if (auto written = m_elements.find(label); written != m_elements.end())
+				return JSON_Parser::ParseElement<T>(written->second);
+
+			auto parsed = m_nodes.find(label);
+			if (parsed == m_nodes.end()) return T();
+
+			JSON_Stream elemStream{ m_tape, parsed->second };
+			T result{};
+			elemStream >> result;
+			return result;
+		}
 
 		/**
 		 * @brief Formats and adds the element to the JSON object
@@ -130,26 +195,116 @@ namespace chcl
 		{
 			JSON_Stream outStream;
 			outStream << elem;
+			m_nodes.erase(label);
 			m_elements[label] = outStream.str();
 		}
 
-		inline void clear() { m_elements.clear(); }
+		inline void clear()
+		{
+			m_elements.clear();
+			m_nodes.clear();
+			m_tape.reset();
+		}
 
 		friend JSON_Stream& operator<<(JSON_Stream &stream, const JSON_Object &obj);
 		friend JSON_Stream& operator>>(JSON_Stream &stream, JSON_Object &obj);
+		friend JSON_Writer& operator<<(JSON_Writer &writer, const JSON_Object &obj);
 
 		/**
 		 * @brief Contents of a single section.
 		 * First element is the label, second element is the contents.
 		 */
 		std::unordered_map<std::string, std::string> m_elements;
+
+		/// @brief Document the parsed elements are stored in
+		std::shared_ptr<const JSON_Tape> m_tape;
+		/**
+		 * @brief Elements read from a parsed document and not since overwritten.
+		 * First element is the label, second element is the tape index of the contents.
+		 */
+		std::unordered_map<std::string, size_t> m_nodes;
+	};
+
+	/**
+	 * @brief Read-only view of a parsed JSON object.
+	 *
+	 * Nothing is decoded or copied up front: labels are matched against the raw source text when an element
+	 * is requested, and only that element is decoded.
+	 */
+	struct JSON_ObjectView
+	{
+	public:
+		JSON_ObjectView() = default;
+		/**
+		 * @param tape Parsed document
+		 * @param node Tape index of the object. The view is left empty if it is not an object
+		 */
+		JSON_ObjectView(std::shared_ptr<const JSON_Tape> tape, size_t node = 0);
+
+		/**
+		 * @brief Reads the element with the given key from the JSON object
+		 * @tparam T Type to read
+		 * @param label Object label
+		 * @return Decoded element, or a default constructed one if the label is missing
+		 */
+		template <typename T>
+		T readElement(std::string_view label) const
+		{
+			size_t index = find(label);
+			if (index == JSON_Tape::npos) return T();
+
+			JSON_Stream elemStream{ m_tape, index };
+			T result{};
+			elemStream >> result;
+			return result;
+		}
+
+		inline bool contains(std::string_view label) const { return find(label) != JSON_Tape::npos; }
+
+		/// @brief Raw text of an element as it appears in the source, empty if the label is missing or the document was decoded from a binary format
+		std::string_view rawElement(std::string_view label) const;
+
+		/// @brief Raw labels of all elements, in document order and with escape sequences left in place
+		std::vector<std::string_view> labels() const;
+
+		/// @brief Number of elements in the object
+		size_t size() const;
+
+		inline bool empty() const { return size() == 0; }
+
+		friend JSON_Stream& operator<<(JSON_Stream &stream, const JSON_ObjectView &obj);
+		friend JSON_Stream& operator>>(JSON_Stream &stream, JSON_ObjectView &obj);
+		friend JSON_Writer& operator<<(JSON_Writer &writer, const JSON_ObjectView &obj);
+
+	private:
+		std::shared_ptr<const JSON_Tape> m_tape;
+		size_t m_node = 0;
+
+		/// @returns Tape index of the element's value, or JSON_Tape::npos
+		size_t find(std::string_view label) const;
 	};
 
 	template <typename T>
 	JSON_Stream& operator>>(JSON_Stream &stream, T &elem)
 	{
-		stream.elemStream >> elem;
-		return stream;
+		if constexpr (JSON_Number<T>)
+		{
+			const JSON_Tape *tape = stream.readTape();
+			if (!tape || !tape->readNumber(stream.node, elem))
+				elem = T();
+			return stream;
+		}
+		else if (!stream.tape)
+		{
+			stream.elemStream >> elem;
+			return stream;
+		}
+		else
+		{
+			std::istringstream valueStream{ stream.tape->json(stream.node) };
+			valueStream >> elem;
+			return stream;
+		}
 	}
 
 	template <typename T>
@@ -157,36 +312,50 @@ namespace chcl
 	{
 		elem.clear();
 
-		size_t index = 1;
-		std::string elemStr = stream.str();
-
-		if (elemStr[0] != '[') return stream;
+		const JSON_Tape *tape = stream.readTape();
+		if (!tape || (*tape)[stream.node].type != JSON_Type::Array) return stream;
 
-		JSON_Parser::JumpWhitespace(elemStr, index);
-		while (index < elemStr.length())
+		const JSON_Node &array = (*tape)[stream.node];
+		if constexpr (JSON_Number<T>)
 		{
-			size_t elemStart = index;
-			JSON_Parser::JumpElement(elemStr, index);
-			JSON_Stream inStream{ elemStr.substr(elemStart, index - elemStart) };
-			elem.resize(elem.size() + 1);
-			inStream >> elem.back();
-			JSON_Parser::JumpWhitespace(elemStr, index);
-			++index;
-			JSON_Parser::JumpWhitespace(elemStr, index);
+			elem.resize(array.count);
+			if (tape->readNumbers(stream.node, elem.data(), elem.size()))
+				return stream;
+			elem.clear();
+		}
 
-			if (elemStr[index] == ']')
-			{
-				++index;
-				break;
-			}
+		elem.reserve(array.count);
+		for (size_t index = stream.node + 1; index < array.next; index = (*tape)[index].next)
+		{
+			JSON_Stream inStream{ stream.tape, index };
+			T value{};
+			inStream >> value;
+			elem.push_back(std::move(value));
 		}
 		return stream;
 	}
 
-	template <typename T>
+	template <typename T> requires (!JSON_Bound<T>)
 	JSON_Stream& operator<<(JSON_Stream &stream, T elem)
 	{
-		stream.elemStream << elem;
+		if constexpr (JSON_Number<T>)
+		{
+			if constexpr (std::is_floating_point_v<T>)
+			{
+				// Non-finite values have no JSON representation
+				if (!std::isfinite(elem))
+				{
+					stream.elemStream << "null";
+					return stream;
+				}
+			}
+
+			char text[32];
+			auto [end, error] = std::to_chars(text, text + sizeof(text), elem);
+			stream.elemStream.write(text, end - text);
+		}
+		else
+			stream.elemStream << elem;
 		return stream;
 	}
 
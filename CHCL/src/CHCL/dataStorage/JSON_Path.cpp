@@ -0,0 +1,289 @@
+#include "JSON_Path.h"
+
+#include <charconv>
+
+#include "JSON_Scanner.h"
+
+namespace
+{
+	constexpr size_t npos = chcl::JSON_Path::npos;
+
+	/**
+	 * @brief Consumes the structural characters of the element starting at begin
+	 * @return Index one past the end of the element, or npos if the text ends first
+	 */
+	size_t SkipElement(std::string_view text, chcl::JSON_Scanner &scanner, size_t begin)
+	{
+		switch (text[begin])
+		{
+			case '\"':
+			{
+				size_t close = scanner.next();
+				return close == npos ? npos : close + 1;
+			}
+			case '{':
+			case '[':
+			{
+				// Brackets within strings are never reported, so counting them is enough to find the end
+				size_t depth = 1;
+				while (true)
+				{
+					size_t position = scanner.next();
+					if (position == npos)
+						return npos;
+
+					switch (text[position])
+					{
+						case '{':
+						case '[':
+							++depth;
+							break;
+						case '}':
+						case ']':
+							if (--depth == 0)
+								return position + 1;
+							break;
+					}
+				}
+			}
+			case '}':
+			case ']':
+			case ',':
+			case ':':
+				return npos;
+			default:
+				// Numbers and literals are reported by their first character only, so there is nothing to consume
+				return chcl::JSON_Scanner::TokenEnd(text, begin);
+		}
+	}
+
+	bool KeyMatches(std::string_view rawKey, std::string_view key, std::string &decodedKey)
+	{
+		// Decoding never lengthens a string, so shorter keys can be rejected before decoding
+		if (rawKey.length() < key.length())
+			return false;
+		if (rawKey.find('\\') == std::string_view::npos)
+			return rawKey == key;
+
+		chcl::JSON_Tape::Unescape(rawKey, decodedKey);
+		return decodedKey == key;
+	}
+
+	/**
+	 * @brief Finds a member of the object whose opening bracket was just consumed from the scanner
+	 * @return Position of the member's value, or npos if there is no such member
+	 */
+	size_t FindMember(std::string_view text, chcl::JSON_Scanner &scanner, std::string_view key, std::string &decodedKey)
+	{
+		size_t position = scanner.next();
+		while (position != npos && text[position] == '\"')
+		{
+			size_t close = scanner.next();
+			size_t colon = scanner.next();
+			if (colon == npos || text[colon] != ':')
+				return npos;
+
+			size_t value = scanner.next();
+			if (value == npos)
+				return npos;
+			if (KeyMatches(text.substr(position + 1, close - position - 1), key, decodedKey))
+				return value;
+
+			if (SkipElement(text, scanner, value) == npos)
+				return npos;
+			position = scanner.next();
+			if (position == npos || text[position] != ',')
+				return npos;
+			position = scanner.next();
+		}
+		return npos;
+	}
+
+	/**
+	 * @brief Finds an element of the array whose opening bracket was just consumed from the scanner
+	 * @return Position of the element, or npos if the array is too short
+	 */
+	size_t FindElement(std::string_view text, chcl::JSON_Scanner &scanner, size_t index)
+	{
+		size_t position = scanner.next();
+		if (position == npos || text[position] == ']')
+			return npos;
+
+		for (size_t i = 0; i < index; ++i)
+		{
+			if (SkipElement(text, scanner, position) == npos)
+				return npos;
+			size_t separator = scanner.next();
+			if (separator == npos || text[separator] != ',')
+				return npos;
+			position = scanner.next();
+			if (position == npos)
+				return npos;
+		}
+		return position;
+	}
+}
+
+chcl::JSON_Path::JSON_Path(std::string_view path)
+{
+	if (path.empty() || path.front() == '/')
+		parsePointer(path);
+	else
+		parseDotted(path);
+
+	if (!m_valid)
+		m_steps.clear();
+}
+
+void chcl::JSON_Path::parsePointer(std::string_view path)
+{
+	size_t begin = 0;
+	while (begin < path.length())
+	{
+		// Skip the '/' that starts every reference token
+		++begin;
+		size_t end = path.find('/', begin);
+		if (end == std::string_view::npos)
+			end = path.length();
+
+		std::string key;
+		for (size_t i = begin; i < end; ++i)
+		{
+			if (path[i] != '~')
+			{
+				key += path[i];
+				continue;
+			}
+
+			// "~0" stands for '~' and "~1" for '/'
+			if (i + 1 < end && (path[i + 1] == '0' || path[i + 1] == '1'))
+				key += path[++i] == '0' ? '~' : '/';
+			else
+				m_valid = false;
+		}
+		addStep(std::move(key));
+		begin = end;
+	}
+}
+
+void chcl::JSON_Path::parseDotted(std::string_view path)
+{
+	size_t position = 0;
+	while (position < path.length() && m_valid)
+	{
+		if (path[position] == '[')
+		{
+			size_t close = path.find(']', position);
+			if (close == std::string_view::npos)
+			{
+				m_valid = false;
+				return;
+			}
+
+			addStep(std::string(path.substr(position + 1, close - position - 1)));
+			if (m_steps.back().index == npos)
+				m_valid = false;
+			position = close + 1;
+		}
+		else
+		{
+			size_t end = path.find_first_of(".[", position);
+			if (end == std::string_view::npos)
+				end = path.length();
+			if (end == position)
+			{
+				m_valid = false;
+				return;
+			}
+
+			addStep(std::string(path.substr(position, end - position)));
+			position = end;
+		}
+
+		if (position < path.length() && path[position] == '.')
+		{
+			++position;
+			if (position == path.length())
+				m_valid = false;
+		}
+	}
+}
+
+void chcl::JSON_Path::addStep(std::string key)
+{
+	Step step;
+
+	// Indices follow JSON Pointer rules: only digits, with no leading zeros
+	bool isIndex = !key.empty() && (key.length() == 1 || key.front() != '0');
+	for (char c : key)
+		isIndex &= c >= '0' && c <= '9';
+	if (isIndex && std::from_chars(key.data(), key.data() + key.length(), step.index).ec != std::errc())
+		step.index = npos;
+
+	step.key = std::move(key);
+	m_steps.push_back(std::move(step));
+}
+
+std::string_view chcl::JSON_Path::find(std::string_view text) const
+{
+	if (!m_valid)
+		return std::string_view();
+
+	JSON_Scanner scanner{ text };
+	std::string decodedKey;
+	size_t position = scanner.next();
+	for (const Step &step : m_steps)
+	{
+		if (position == npos)
+			return std::string_view();
+
+		if (text[position] == '{')
+			position = FindMember(text, scanner, step.key, decodedKey);
+		else if (text[position] == '[' && step.index != npos)
+			position = FindElement(text, scanner, step.index);
+		else
+			return std::string_view();
+	}
+
+	if (position == npos)
+		return std::string_view();
+	size_t end = SkipElement(text, scanner, position);
+	if (end == npos || end == position)
+		return std::string_view();
+	return text.substr(position, end - position);
+}
+
+size_t chcl::JSON_Path::find(const JSON_Tape &tape, size_t node) const
+{
+	if (!m_valid || node >= tape.size())
+		return npos;
+
+	for (const Step &step : m_steps)
+	{
+		const JSON_Node &container = tape[node];
+		if (container.type == JSON_Type::Object)
+			node = tape.findMember(node, step.key);
+		else if (container.type == JSON_Type::Array && step.index < container.count)
+		{
+			node = node + 1;
+			for (size_t i = 0; i < step.index; ++i)
+				node = tape[node].next;
+		}
+		else
+			return npos;
+
+		if (node == npos)
+			return npos;
+	}
+	return node;
+}
+
+std::shared_ptr<const chcl::JSON_Tape> chcl::JSON_Path::query(std::string_view text) const
+{
+	std::string_view element = find(text);
+	if (element.empty())
+		return nullptr;
+
+	auto tape = std::make_shared<const JSON_Tape>(std::string(element));
+	return tape->valid() ? tape : nullptr;
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "JSON_Parser.h"
+#include "JSON_Tape.h"
+
+namespace chcl
+{
+	/**
+	 * @brief Precompiled path to an element deep within a JSON document.
+	 *
+	 * Paths are written either as a JSON Pointer (RFC 6901), such as "/metrics/cpu/3/load",
+	 * or in dotted form, such as "metrics.cpu[3].load" or "metrics.cpu.3.load". Keys containing '.' or '[' need the pointer form.
+	 * Queries on text walk the document with JSON_Scanner, skipping over unrelated siblings by their brackets
+	 * without building nodes for them, and only parse the element the path leads to.
+	 * Skipped siblings are not validated, so a malformed document may still yield a result.
+	 */
+	class JSON_Path
+	{
+	public:
+		static constexpr size_t npos = ~size_t(0);
+
+		struct Step
+		{
+			std::string key; ///< Member name to look up in an object
+			size_t index = npos; ///< Position to look up in an array, or npos if the step is not a number
+		};
+
+		/**
+		 * @param path JSON Pointer if empty or starting with '/', dotted path otherwise
+		 */
+		explicit JSON_Path(std::string_view path);
+
+		/// @brief Whether the path was well-formed
+		inline bool valid() const { return m_valid; }
+		inline const std::vector<Step>& steps() const { return m_steps; }
+
+		/**
+		 * @brief Finds the element the path leads to
+		 * @param text JSON document
+		 * @return Raw text of the element, or an empty view if the path leads nowhere
+		 */
+		std::string_view find(std::string_view text) const;
+
+		/**
+		 * @brief Finds the element the path leads to in a document that has already been parsed
+		 * @param tape Parsed document
+		 * @param node Tape index the path is relative to
+		 * @return Tape index of the element, or npos if the path leads nowhere
+		 */
+		size_t find(const JSON_Tape &tape, size_t node = 0) const;
+
+		/**
+		 * @brief Parses only the element the path leads to
+		 * @return Tape holding a copy of the element, or nullptr if the path leads nowhere or the element is malformed
+		 */
+		std::shared_ptr<const JSON_Tape> query(std::string_view text) const;
+
+		/**
+		 * @brief Decodes the element the path leads to through JSON_Stream's operator>>
+		 * @return Whether the element was found
+		 */
+		template <typename T>
+		bool read(std::string_view text, T &out) const
+		{
+			auto tape = query(text);
+			if (!tape)
+				return false;
+
+			JSON_Stream elemStream{ std::move(tape), 0 };
+			elemStream >> out;
+			return true;
+		}
+
+	private:
+		std::vector<Step> m_steps;
+		bool m_valid = true;
+
+		void parsePointer(std::string_view path);
+		void parseDotted(std::string_view path);
+		void addStep(std::string key);
+	};
+}
\ No newline at end of file
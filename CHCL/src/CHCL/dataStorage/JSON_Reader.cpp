@@ -0,0 +1,293 @@
+#include "JSON_Reader.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+#include "JSON_Strings.h"
+#include "JSON_Tape.h"
+
+#ifdef _WIN32
+	#include <fcntl.h>
+	#include <io.h>
+#else
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+namespace
+{
+#ifdef _WIN32
+	int OpenFile(const std::string &filename) { return _open(filename.c_str(), _O_RDONLY | _O_BINARY); }
+	long long ReadFile(int fd, void *dest, size_t size) { return _read(fd, dest, (unsigned int)std::min<size_t>(size, INT_MAX)); }
+	void CloseFile(int fd) { _close(fd); }
+#else
+	int OpenFile(const std::string &filename) { return ::open(filename.c_str(), O_RDONLY); }
+	long long ReadFile(int fd, void *dest, size_t size) { return ::read(fd, dest, std::min<size_t>(size, INT_MAX)); }
+	void CloseFile(int fd) { ::close(fd); }
+#endif
+
+	inline bool IsWhitespace(char c)
+	{
+		return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+	}
+
+	inline bool IsTokenEnd(char c)
+	{
+		switch (c)
+		{
+			case ',':
+			case ':':
+			case '{':
+			case '}':
+			case '[':
+			case ']':
+			case '\"':
+				return true;
+			default:
+				return IsWhitespace(c);
+		}
+	}
+}
+
+chcl::JSON_Reader::JSON_Reader(std::istream &stream, size_t chunkSize) :
+	m_stream(&stream),
+	m_chunkSize(std::max<size_t>(chunkSize, 1)),
+	m_buffer(m_chunkSize)
+{
+	m_data = m_buffer.data();
+}
+
+chcl::JSON_Reader::JSON_Reader(int fileDescriptor, size_t chunkSize) :
+	m_fileDescriptor(fileDescriptor),
+	m_chunkSize(std::max<size_t>(chunkSize, 1)),
+	m_buffer(m_chunkSize)
+{
+	m_data = m_buffer.data();
+	m_failed = fileDescriptor < 0;
+}
+
+chcl::JSON_Reader::JSON_Reader(const std::string &filename, size_t chunkSize) :
+	JSON_Reader(OpenFile(filename), chunkSize)
+{
+	m_ownsFile = m_fileDescriptor >= 0;
+}
+
+chcl::JSON_Reader::JSON_Reader(const char *data, size_t length) :
+	m_sourceEnd(true),
+	m_data(data),
+	m_end(length)
+{}
+
+chcl::JSON_Reader::~JSON_Reader()
+{
+	if (m_ownsFile)
+		CloseFile(m_fileDescriptor);
+}
+
+bool chcl::JSON_Reader::next(JSON_Event &event)
+{
+	if (m_failed || m_state == State::Done)
+		return false;
+
+	m_text = {};
+
+	while (true)
+	{
+		if (!skipWhitespace())
+			return fail();
+
+		char c = m_data[m_pos];
+
+		if (m_state == State::Colon)
+		{
+			if (c != ':')
+				return fail();
+			++m_pos;
+			m_state = State::Value;
+			continue;
+		}
+
+		if (m_state == State::AfterValue)
+		{
+			if (c == ',')
+			{
+				++m_pos;
+				m_state = m_containers.back() == '{' ? State::Key : State::Value;
+				continue;
+			}
+		}
+		// Closing brackets are accepted straight after an opening bracket or a trailing comma
+		else if (m_containers.empty() || c != (m_state == State::Key ? '}' : ']'))
+			break;
+
+		if (c != (m_containers.back() == '{' ? '}' : ']'))
+			return fail();
+
+		++m_pos;
+		event = c == '}' ? JSON_Event::EndObject : JSON_Event::EndArray;
+		m_containers.pop_back();
+		endValue();
+		return true;
+	}
+
+	char c = m_data[m_pos];
+
+	if (m_state == State::Key)
+	{
+		if (c != '\"' || !readString())
+			return fail();
+		event = JSON_Event::Key;
+		m_state = State::Colon;
+		return true;
+	}
+
+	switch (c)
+	{
+		case '{':
+		case '[':
+			++m_pos;
+			m_containers.push_back(c);
+			event = c == '{' ? JSON_Event::StartObject : JSON_Event::StartArray;
+			m_state = c == '{' ? State::Key : State::Value;
+			return true;
+		case '\"':
+			if (!readString())
+				return fail();
+			event = JSON_Event::String;
+			break;
+		case ',':
+		case ':':
+		case '}':
+		case ']':
+			return fail();
+		default:
+			event = readToken();
+			break;
+	}
+
+	endValue();
+	return true;
+}
+
+bool chcl::JSON_Reader::fill()
+{
+	if (m_sourceEnd)
+		return false;
+
+	size_t unread = m_end - m_pos;
+	std::memmove(m_buffer.data(), m_buffer.data() + m_pos, unread);
+	m_pos = 0;
+	m_end = unread;
+
+	// Only grows when a single token is longer than the buffer
+	if (m_buffer.size() < m_end + m_chunkSize)
+		m_buffer.resize(m_end + m_chunkSize);
+	m_data = m_buffer.data();
+
+	long long bytesRead = 0;
+	if (m_stream)
+	{
+		m_stream->read(m_buffer.data() + m_end, m_chunkSize);
+		bytesRead = m_stream->gcount();
+	}
+	else
+		bytesRead = ReadFile(m_fileDescriptor, m_buffer.data() + m_end, m_chunkSize);
+
+	if (bytesRead <= 0)
+	{
+		m_sourceEnd = true;
+		return false;
+	}
+
+	m_end += (size_t)bytesRead;
+	return true;
+}
+
+bool chcl::JSON_Reader::skipWhitespace()
+{
+	while (true)
+	{
+		while (m_pos < m_end && IsWhitespace(m_data[m_pos]))
+			++m_pos;
+
+		if (m_pos < m_end)
+			return true;
+		if (!fill())
+			return false;
+	}
+}
+
+bool chcl::JSON_Reader::readString()
+{
+	size_t length = 1;
+	bool escaped = false;
+
+	while (true)
+	{
+		std::string_view window(m_data + m_pos, m_end - m_pos);
+		size_t special = JSON_Strings::FindQuoteOrBackslash(window, length);
+
+		// An escape is only complete once the character after the backslash is available
+		while (special != std::string_view::npos && window[special] == '\\' && special + 1 < window.length())
+		{
+			escaped = true;
+			special = JSON_Strings::FindQuoteOrBackslash(window, special + 2);
+		}
+
+		if (special != std::string_view::npos && window[special] == '\"')
+		{
+			std::string_view raw = window.substr(1, special - 1);
+			if (escaped)
+			{
+				JSON_Tape::Unescape(raw, m_unescaped);
+				m_text = m_unescaped;
+			}
+			else
+				m_text = raw;
+
+			m_pos += special + 1;
+			return true;
+		}
+
+		// Resume from the unfinished escape, or the end of the window
+		length = special == std::string_view::npos ? window.length() : special;
+		if (!fill())
+			return false;
+	}
+}
+
+chcl::JSON_Event chcl::JSON_Reader::readToken()
+{
+	size_t length = 0;
+	while (true)
+	{
+		while (m_pos + length < m_end && !IsTokenEnd(m_data[m_pos + length]))
+			++length;
+
+		// A token running into the end of the text is complete
+		if (m_pos + length < m_end || !fill())
+			break;
+	}
+
+	std::string_view token(m_data + m_pos, length);
+	m_pos += length;
+
+	if (token == "true") return JSON_Event::True;
+	if (token == "false") return JSON_Event::False;
+	if (token == "null") return JSON_Event::Null;
+
+	m_text = token;
+	return JSON_Event::Number;
+}
+
+void chcl::JSON_Reader::endValue()
+{
+	m_state = m_containers.empty() ? State::Done : State::AfterValue;
+}
+
+bool chcl::JSON_Reader::fail()
+{
+	m_failed = true;
+	return false;
+}
\ No newline at end of file
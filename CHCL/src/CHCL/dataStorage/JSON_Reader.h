@@ -0,0 +1,198 @@
+#pragma once
+
+#include <charconv>
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace chcl
+{
+	enum class JSON_Event : uint8_t
+	{
+		StartObject, EndObject,
+		StartArray, EndArray,
+		Key, String, Number,
+		True, False, Null
+	};
+
+	/**
+	 * @brief Visitor with no-op handlers for every JSON_Reader event.
+	 *
+	 * Derive from it and redeclare only the handlers needed; JSON_Reader::visit calls them on the derived type.
+	 * When only some value overloads are redeclared, add `using JSON_Visitor::value;` to keep the others visible.
+	 */
+	struct JSON_Visitor
+	{
+		void startObject() {}
+		void endObject() {}
+		void startArray() {}
+		void endArray() {}
+		void key(std::string_view) {}
+
+		void value(std::string_view) {}
+		void value(int64_t) {}
+		void value(double) {}
+		void value(bool) {}
+		void value(std::nullptr_t) {}
+	};
+
+	/**
+	 * @brief Pull-based JSON reader that never holds more than a chunk of the document in memory.
+	 *
+	 * Text is read from an istream or file descriptor in bounded chunks; a token spanning a chunk boundary
+	 * is kept contiguous by growing the buffer only as far as that token needs.
+	 * In-memory or memory-mapped documents are read in place without any copying.
+	 */
+	class JSON_Reader
+	{
+	public:
+		static constexpr size_t DefaultChunkSize = 64 * 1024;
+
+		/**
+		 * @brief Reads from an input stream
+		 * @param stream Stream to read from, which must outlive the reader
+		 * @param chunkSize Number of bytes to request from the stream at a time
+		 */
+		explicit JSON_Reader(std::istream &stream, size_t chunkSize = DefaultChunkSize);
+
+		/**
+		 * @brief Reads from an open file descriptor, starting at its current position
+		 * The descriptor is not closed by the reader
+		 */
+		explicit JSON_Reader(int fileDescriptor, size_t chunkSize = DefaultChunkSize);
+
+		/**
+		 * @brief Opens and reads a file
+		 */
+		explicit JSON_Reader(const std::string &filename, size_t chunkSize = DefaultChunkSize);
+
+		/**
+		 * @brief Reads a document already in memory, such as a mapped file, without copying it
+		 * @param data JSON text, which must outlive the reader
+		 * @param length Length of the text in bytes
+		 */
+		JSON_Reader(const char *data, size_t length);
+
+		JSON_Reader(const JSON_Reader&) = delete;
+		JSON_Reader& operator=(const JSON_Reader&) = delete;
+		~JSON_Reader();
+
+		/**
+		 * @brief Reads the next event of the document
+		 * @param event Type of the event read
+		 * @return False once the top level element has ended, or if the document is malformed
+		 */
+		bool next(JSON_Event &event);
+
+		/**
+		 * @brief Text of the last Key, String or Number event
+		 * Strings and keys are unescaped, numbers are left as written.
+		 * The text is only valid until the next call to next()
+		 */
+		inline std::string_view text() const { return m_text; }
+
+		/// @brief Number of objects and arrays currently open
+		inline size_t depth() const { return m_containers.size(); }
+
+		inline bool failed() const { return m_failed; }
+		inline explicit operator bool() const { return !m_failed; }
+
+		/**
+		 * @brief Reads the rest of the document, passing each event to a visitor as a typed value
+		 * Numbers are passed as int64_t when they are integers that fit, and as double otherwise
+		 * @param visitor Object with the handlers of JSON_Visitor
+		 * @return Whether the document was well formed
+		 */
+		template <typename Visitor>
+		bool visit(Visitor &&visitor)
+		{
+			JSON_Event event;
+			while (next(event))
+			{
+				switch (event)
+				{
+					case JSON_Event::StartObject: visitor.startObject(); break;
+					case JSON_Event::EndObject: visitor.endObject(); break;
+					case JSON_Event::StartArray: visitor.startArray(); break;
+					case JSON_Event::EndArray: visitor.endArray(); break;
+					case JSON_Event::Key: visitor.key(m_text); break;
+					case JSON_Event::String: visitor.value(m_text); break;
+					case JSON_Event::True: visitor.value(true); break;
+					case JSON_Event::False: visitor.value(false); break;
+					case JSON_Event::Null: visitor.value(nullptr); break;
+					case JSON_Event::Number:
+					{
+						const char *end = m_text.data() + m_text.length();
+						int64_t integer = 0;
+						auto [intEnd, intError] = std::from_chars(m_text.data(), end, integer);
+						if (intError == std::errc() && intEnd == end)
+						{
+							visitor.value(integer);
+							break;
+						}
+
+						double real = 0.0;
+						auto [realEnd, realError] = std::from_chars(m_text.data(), end, real);
+						if (realError != std::errc() || realEnd != end)
+						{
+							m_failed = true;
+							return false;
+						}
+						visitor.value(real);
+						break;
+					}
+				}
+			}
+			return !m_failed;
+		}
+
+	private:
+		enum class State : uint8_t
+		{
+			Value, ///< Expecting an element, or the end of an array
+			Key, ///< Expecting a member name, or the end of an object
+			Colon, ///< Expecting the colon following a member name
+			AfterValue, ///< Expecting a separator or the end of the enclosing container
+			Done
+		};
+
+		// Source
+		std::istream *m_stream = nullptr;
+		int m_fileDescriptor = -1;
+		bool m_ownsFile = false;
+		bool m_sourceEnd = false;
+		size_t m_chunkSize = DefaultChunkSize;
+
+		// Window of text currently readable, either inside m_buffer or the caller's memory
+		std::vector<char> m_buffer;
+		const char *m_data = nullptr;
+		size_t m_pos = 0;
+		size_t m_end = 0;
+
+		std::vector<char> m_containers; ///< '{' or '[' for each open container
+		State m_state = State::Value;
+		bool m_failed = false;
+
+		std::string_view m_text;
+		std::string m_unescaped;
+
+		/**
+		 * @brief Reads another chunk, first moving the unread text to the start of the buffer
+		 * Invalidates pointers into the window, so scanning positions must be kept relative to m_pos
+		 * @return False if nothing more could be read
+		 */
+		bool fill();
+
+		/// @brief Skips whitespace, reading more text as needed. Returns false at the end of the text
+		bool skipWhitespace();
+		/// @brief Reads the string starting at m_pos into m_text
+		bool readString();
+		/// @brief Reads the number or literal starting at m_pos
+		JSON_Event readToken();
+
+		void endValue();
+		bool fail();
+	};
+}
\ No newline at end of file
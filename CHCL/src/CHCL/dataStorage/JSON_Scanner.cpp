@@ -0,0 +1,227 @@
+#include "JSON_Scanner.h"
+
+#include <cstring>
+
+#include "CHCL/misc/CPUFeatures.h"
+
+// SSE2 is part of the x86-64 baseline, and MSVC reports it through _M_X64/_M_IX86_FP rather than __SSE2__.
+// The AVX2 classifier is compiled on any x86 target and used when the CPU supports it
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define CHCL_JSON_SSE2
+#endif
+
+namespace
+{
+	/**
+	 * @brief Character classes of a 64 byte block, one bit per byte
+	 */
+	struct BlockMasks
+	{
+		uint64_t quote = 0;
+		uint64_t backslash = 0;
+		uint64_t op = 0; ///< Brackets, colons and commas
+		uint64_t whitespace = 0;
+	};
+
+#ifdef CHCL_X86
+	CHCL_TARGET("avx2") BlockMasks ClassifyAVX2(const char *block)
+	{
+		const __m256i quote = _mm256_set1_epi8('\"');
+		const __m256i backslash = _mm256_set1_epi8('\\');
+		const __m256i caseBit = _mm256_set1_epi8(0x20);
+		const __m256i openBracket = _mm256_set1_epi8('{');
+		const __m256i closeBracket = _mm256_set1_epi8('}');
+		const __m256i colon = _mm256_set1_epi8(':');
+		const __m256i comma = _mm256_set1_epi8(',');
+		const __m256i space = _mm256_set1_epi8(' ');
+		const __m256i tab = _mm256_set1_epi8('\t');
+		const __m256i newline = _mm256_set1_epi8('\n');
+		const __m256i carriageReturn = _mm256_set1_epi8('\r');
+
+		BlockMasks masks;
+		for (size_t half = 0; half < 2; ++half)
+		{
+			__m256i chars = _mm256_loadu_si256((const __m256i*)(block + half * 32));
+			// '[' and ']' differ from '{' and '}' only by the 0x20 bit
+			__m256i folded = _mm256_or_si256(chars, caseBit);
+
+			__m256i op = _mm256_or_si256(
+				_mm256_or_si256(_mm256_cmpeq_epi8(folded, openBracket), _mm256_cmpeq_epi8(folded, closeBracket)),
+				_mm256_or_si256(_mm256_cmpeq_epi8(chars, colon), _mm256_cmpeq_epi8(chars, comma)));
+			__m256i whitespace = _mm256_or_si256(
+				_mm256_or_si256(_mm256_cmpeq_epi8(chars, space), _mm256_cmpeq_epi8(chars, tab)),
+				_mm256_or_si256(_mm256_cmpeq_epi8(chars, newline), _mm256_cmpeq_epi8(chars, carriageReturn)));
+
+			size_t shift = half * 32;
+			masks.quote |= uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chars, quote)))) << shift;
+			masks.backslash |= uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chars, backslash)))) << shift;
+			masks.op |= uint64_t(uint32_t(_mm256_movemask_epi8(op))) << shift;
+			masks.whitespace |= uint64_t(uint32_t(_mm256_movemask_epi8(whitespace))) << shift;
+		}
+		return masks;
+	}
+#endif
+
+#ifdef CHCL_JSON_SSE2
+	BlockMasks ClassifySSE2(const char *block)
+	{
+		const __m128i quote = _mm_set1_epi8('\"');
+		const __m128i backslash = _mm_set1_epi8('\\');
+		const __m128i caseBit = _mm_set1_epi8(0x20);
+		const __m128i openBracket = _mm_set1_epi8('{');
+		const __m128i closeBracket = _mm_set1_epi8('}');
+		const __m128i colon = _mm_set1_epi8(':');
+		const __m128i comma = _mm_set1_epi8(',');
+		const __m128i space = _mm_set1_epi8(' ');
+		const __m128i tab = _mm_set1_epi8('\t');
+		const __m128i newline = _mm_set1_epi8('\n');
+		const __m128i carriageReturn = _mm_set1_epi8('\r');
+
+		BlockMasks masks;
+		for (size_t quarter = 0; quarter < 4; ++quarter)
+		{
+			__m128i chars = _mm_loadu_si128((const __m128i*)(block + quarter * 16));
+			// '[' and ']' differ from '{' and '}' only by the 0x20 bit
+			__m128i folded = _mm_or_si128(chars, caseBit);
+
+			__m128i op = _mm_or_si128(
+				_mm_or_si128(_mm_cmpeq_epi8(folded, openBracket), _mm_cmpeq_epi8(folded, closeBracket)),
+				_mm_or_si128(_mm_cmpeq_epi8(chars, colon), _mm_cmpeq_epi8(chars, comma)));
+			__m128i whitespace = _mm_or_si128(
+				_mm_or_si128(_mm_cmpeq_epi8(chars, space), _mm_cmpeq_epi8(chars, tab)),
+				_mm_or_si128(_mm_cmpeq_epi8(chars, newline), _mm_cmpeq_epi8(chars, carriageReturn)));
+
+			size_t shift = quarter * 16;
+			masks.quote |= uint64_t(_mm_movemask_epi8(_mm_cmpeq_epi8(chars, quote))) << shift;
+			masks.backslash |= uint64_t(_mm_movemask_epi8(_mm_cmpeq_epi8(chars, backslash))) << shift;
+			masks.op |= uint64_t(_mm_movemask_epi8(op)) << shift;
+			masks.whitespace |= uint64_t(_mm_movemask_epi8(whitespace)) << shift;
+		}
+		return masks;
+	}
+#else
+	BlockMasks ClassifyScalar(const char *block)
+	{
+		BlockMasks masks;
+		for (size_t i = 0; i < chcl::JSON_Scanner::BlockSize; ++i)
+		{
+			uint64_t bit = uint64_t(1) << i;
+			switch (block[i])
+			{
+				case '\"':
+					masks.quote |= bit;
+					break;
+				case '\\':
+					masks.backslash |= bit;
+					break;
+				case '{':
+				case '}':
+				case '[':
+				case ']':
+				case ':':
+				case ',':
+					masks.op |= bit;
+					break;
+				case ' ':
+				case '\t':
+				case '\n':
+				case '\r':
+					masks.whitespace |= bit;
+					break;
+			}
+		}
+		return masks;
+	}
+#endif
+
+	BlockMasks Classify(const char *block)
+	{
+#ifdef CHCL_X86
+		if (chcl::CPUFeatures::HasAVX2())
+			return ClassifyAVX2(block);
+#endif
+#ifdef CHCL_JSON_SSE2
+		return ClassifySSE2(block);
+#else
+		return ClassifyScalar(block);
+#endif
+	}
+
+	/**
+	 * @brief Sets each bit to the parity of all bits at or below it
+	 * Turns a mask of quotes into a mask of the characters between each opening and closing quote
+	 */
+	inline uint64_t PrefixXor(uint64_t bits)
+	{
+		bits ^= bits << 1;
+		bits ^= bits << 2;
+		bits ^= bits << 4;
+		bits ^= bits << 8;
+		bits ^= bits << 16;
+		bits ^= bits << 32;
+		return bits;
+	}
+}
+
+void chcl::JSON_Scanner::scanBlock()
+{
+	const char *block = m_text.data() + m_blockBegin;
+
+	// The final partial block is padded with whitespace, which is never structural
+	char padded[BlockSize];
+	if (m_text.length() - m_blockBegin < BlockSize)
+	{
+		std::memset(padded, ' ', BlockSize);
+		std::memcpy(padded, block, m_text.length() - m_blockBegin);
+		block = padded;
+	}
+	m_blockBegin += BlockSize;
+
+	BlockMasks masks = Classify(block);
+
+	// A character is escaped when it follows an odd length run of backslashes.
+	// Adding each run's start to the run carries across it, so runs starting on odd bits flip the parity of the bit after them.
+	constexpr uint64_t evenBits = 0x5555555555555555;
+	uint64_t carriedEscape = m_escaped ? 1 : 0;
+	uint64_t backslash = masks.backslash & ~carriedEscape;
+	uint64_t followsBackslash = (backslash << 1) | carriedEscape;
+	uint64_t oddRunStarts = backslash & ~evenBits & ~followsBackslash;
+	uint64_t runEnds = oddRunStarts + backslash;
+	m_escaped = runEnds < oddRunStarts;
+	uint64_t escaped = (evenBits ^ (runEnds << 1)) & followsBackslash;
+
+	uint64_t quotes = masks.quote & ~escaped;
+	// Includes each opening quote but not the closing one
+	uint64_t inString = PrefixXor(quotes) ^ (m_inString ? ~uint64_t(0) : 0);
+	m_inString = inString >> 63;
+
+	uint64_t token = ~(masks.op | masks.whitespace | masks.quote) & ~inString;
+	uint64_t tokenStarts = token & ~((token << 1) | (m_inToken ? 1 : 0));
+	m_inToken = token >> 63;
+
+	m_structurals = (masks.op & ~inString) | quotes | tokenStarts;
+}
+
+size_t chcl::JSON_Scanner::TokenEnd(std::string_view text, size_t index)
+{
+	while (index < text.length())
+	{
+		switch (text[index])
+		{
+			case ',':
+			case ':':
+			case '{':
+			case '}':
+			case '[':
+			case ']':
+			case '\"':
+			case ' ':
+			case '\t':
+			case '\n':
+			case '\r':
+				return index;
+		}
+		++index;
+	}
+	return index;
+}
\ No newline at end of file
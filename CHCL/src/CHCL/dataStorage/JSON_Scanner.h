@@ -0,0 +1,65 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <string_view>
+
+namespace chcl
+{
+	/**
+	 * @brief Finds the structural characters of a JSON document, 64 bytes at a time.
+	 *
+	 * Each block is classified with SIMD compares into quote, backslash, operator and whitespace bitmasks, which are
+	 * then combined with carries from the previous block to find escaped characters and string contents.
+	 * AVX2 is used when the CPU supports it, with SSE2 or a scalar fallback otherwise.
+	 * The positions produced are every unescaped quote, every bracket, colon and comma outside of a string,
+	 * and the first character of every number or literal.
+	 */
+	class JSON_Scanner
+	{
+	public:
+		static constexpr size_t npos = ~size_t(0);
+		static constexpr size_t BlockSize = 64;
+
+		explicit JSON_Scanner(std::string_view text) : m_text(text) {}
+
+		/**
+		 * @brief Gets the position of the next structural character
+		 * @return Offset in the text, or npos once the end has been reached
+		 */
+		inline size_t next()
+		{
+			while (!m_structurals)
+			{
+				if (m_blockBegin >= m_text.length())
+					return npos;
+				scanBlock();
+			}
+
+			size_t position = m_blockBegin - BlockSize + std::countr_zero(m_structurals);
+			m_structurals &= m_structurals - 1;
+			return position;
+		}
+
+		/// @brief Whether the text ended inside a string
+		inline bool unterminatedString() const { return m_inString; }
+
+		/**
+		 * @brief Finds the end of a number or literal, whose first character is all next() reports
+		 * @return Index one past the end of the unquoted token starting at index
+		 */
+		static size_t TokenEnd(std::string_view text, size_t index);
+
+	private:
+		std::string_view m_text;
+		size_t m_blockBegin = 0; ///< Start of the next block to scan
+		uint64_t m_structurals = 0; ///< Structural positions of the last block not yet returned
+
+		// Carried between blocks
+		bool m_escaped = false; ///< First character of the next block is escaped
+		bool m_inString = false; ///< Next block starts inside a string
+		bool m_inToken = false; ///< Last character of the previous block was part of a number or literal
+
+		void scanBlock();
+	};
+}
\ No newline at end of file
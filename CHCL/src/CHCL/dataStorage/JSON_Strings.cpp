@@ -0,0 +1,487 @@
+#include "JSON_Strings.h"
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+
+#include "CHCL/misc/CPUFeatures.h"
+
+// SSE2 is part of the x86-64 baseline, and MSVC reports it through _M_X64/_M_IX86_FP rather than __SSE2__.
+// The AVX2 kernels are compiled on any x86 target and used when the CPU supports them
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define CHCL_JSON_SSE2
+#endif
+
+namespace
+{
+	using chcl::JSON_Strings::npos;
+
+	/// @brief Characters a search stops at, combined as flags
+	enum Special : uint8_t
+	{
+		Quote = 1,
+		Backslash = 2,
+		Control = 4
+	};
+
+	template <uint8_t special>
+	constexpr bool IsSpecial(unsigned char c)
+	{
+		return ((special & Quote) && c == '\"') || ((special & Backslash) && c == '\\') || ((special & Control) && c < 0x20);
+	}
+
+#ifdef CHCL_X86
+	/**
+	 * @brief Searches 32 characters at a time
+	 * @param from Advanced past every whole vector searched, so the caller can search the rest
+	 * @return Position of the first special character, or npos if there was none in a whole vector
+	 */
+	template <uint8_t special>
+	CHCL_TARGET("avx2") size_t FindAVX2(std::string_view text, size_t &from)
+	{
+		const __m256i quote = _mm256_set1_epi8('\"');
+		const __m256i backslash = _mm256_set1_epi8('\\');
+		const __m256i lastControl = _mm256_set1_epi8(0x1F);
+		for (; from + 32 <= text.length(); from += 32)
+		{
+			__m256i chars = _mm256_loadu_si256((const __m256i*)(text.data() + from));
+			__m256i found = _mm256_setzero_si256();
+			if constexpr ((special & Quote) != 0)
+				found = _mm256_or_si256(found, _mm256_cmpeq_epi8(chars, quote));
+			if constexpr ((special & Backslash) != 0)
+				found = _mm256_or_si256(found, _mm256_cmpeq_epi8(chars, backslash));
+			// Bytes no greater than 0x1F, compared unsigned
+			if constexpr ((special & Control) != 0)
+				found = _mm256_or_si256(found, _mm256_cmpeq_epi8(_mm256_min_epu8(chars, lastControl), chars));
+
+			uint32_t mask = uint32_t(_mm256_movemask_epi8(found));
+			if (mask)
+				return from + std::countr_zero(mask);
+		}
+		return npos;
+	}
+#endif
+
+#ifdef CHCL_JSON_SSE2
+	/// @brief Searches 16 characters at a time, in the same way as FindAVX2
+	template <uint8_t special>
+	size_t FindSSE2(std::string_view text, size_t &from)
+	{
+		const __m128i quote = _mm_set1_epi8('\"');
+		const __m128i backslash = _mm_set1_epi8('\\');
+		const __m128i lastControl = _mm_set1_epi8(0x1F);
+		for (; from + 16 <= text.length(); from += 16)
+		{
+			__m128i chars = _mm_loadu_si128((const __m128i*)(text.data() + from));
+			__m128i found = _mm_setzero_si128();
+			if constexpr ((special & Quote) != 0)
+				found = _mm_or_si128(found, _mm_cmpeq_epi8(chars, quote));
+			if constexpr ((special & Backslash) != 0)
+				found = _mm_or_si128(found, _mm_cmpeq_epi8(chars, backslash));
+			if constexpr ((special & Control) != 0)
+				found = _mm_or_si128(found, _mm_cmpeq_epi8(_mm_min_epu8(chars, lastControl), chars));
+
+			uint32_t mask = uint32_t(_mm_movemask_epi8(found));
+			if (mask)
+				return from + std::countr_zero(mask);
+		}
+		return npos;
+	}
+#endif
+
+	/**
+	 * @brief Finds the first character at or after from for which match returns true, one character at a time
+	 * Used for the tail that does not fill a whole vector
+	 */
+	template <typename Match>
+	size_t FindScalar(std::string_view text, size_t from, Match &&match)
+	{
+		for (size_t i = from; i < text.length(); ++i)
+		{
+			if (match(static_cast<unsigned char>(text[i])))
+				return i;
+		}
+		return npos;
+	}
+
+	/**
+	 * @brief Finds the first special character at or after from, with the widest vectors the CPU supports
+	 * The tail left by wider vectors is searched with narrower ones, and the last few characters one at a time
+	 */
+	template <uint8_t special>
+	size_t Find(std::string_view text, size_t from)
+	{
+#ifdef CHCL_X86
+		if (chcl::CPUFeatures::HasAVX2())
+		{
+			size_t found = FindAVX2<special>(text, from);
+			if (found != npos)
+				return found;
+		}
+#endif
+#ifdef CHCL_JSON_SSE2
+		size_t found = FindSSE2<special>(text, from);
+		if (found != npos)
+			return found;
+#endif
+		return FindScalar(text, from, IsSpecial<special>);
+	}
+
+	/// @returns Value of a hex digit, or -1
+	int HexValue(char c)
+	{
+		if (c >= '0' && c <= '9') return c - '0';
+		if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+		if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+		return -1;
+	}
+
+	/**
+	 * @brief Reads the four hex digits of a \\u escape
+	 * @param index Position of the backslash
+	 */
+	bool ReadUnicodeEscape(std::string_view raw, size_t index, uint32_t &codeUnit)
+	{
+		if (index + 6 > raw.length() || raw[index] != '\\' || raw[index + 1] != 'u')
+			return false;
+
+		codeUnit = 0;
+		for (size_t i = index + 2; i < index + 6; ++i)
+		{
+			int digit = HexValue(raw[i]);
+			if (digit < 0)
+				return false;
+			codeUnit = (codeUnit << 4) | uint32_t(digit);
+		}
+		return true;
+	}
+
+	size_t WriteUtf8(uint32_t codePoint, char *out)
+	{
+		if (codePoint < 0x80)
+		{
+			out[0] = char(codePoint);
+			return 1;
+		}
+		if (codePoint < 0x800)
+		{
+			out[0] = char(0xC0 | (codePoint >> 6));
+			out[1] = char(0x80 | (codePoint & 0x3F));
+			return 2;
+		}
+		if (codePoint < 0x10000)
+		{
+			out[0] = char(0xE0 | (codePoint >> 12));
+			out[1] = char(0x80 | ((codePoint >> 6) & 0x3F));
+			out[2] = char(0x80 | (codePoint & 0x3F));
+			return 3;
+		}
+		out[0] = char(0xF0 | (codePoint >> 18));
+		out[1] = char(0x80 | ((codePoint >> 12) & 0x3F));
+		out[2] = char(0x80 | ((codePoint >> 6) & 0x3F));
+		out[3] = char(0x80 | (codePoint & 0x3F));
+		return 4;
+	}
+
+#ifdef CHCL_X86
+	/**
+	 * @brief Error classes of a pair of adjacent bytes, for ValidUtf8AVX2.
+	 * Each table lookup gives the errors a byte could take part in, and a pair is an error if all three agree on one
+	 */
+	namespace Utf8Error
+	{
+		constexpr uint8_t TooShort = 1 << 0; ///< Lead byte followed by a byte that is not a continuation
+		constexpr uint8_t TooLong = 1 << 1; ///< ASCII byte followed by a continuation
+		constexpr uint8_t Overlong3 = 1 << 2;
+		constexpr uint8_t TooLarge = 1 << 3; ///< Past U+10FFFF
+		constexpr uint8_t Surrogate = 1 << 4;
+		constexpr uint8_t Overlong2 = 1 << 5;
+		constexpr uint8_t TooLarge1000 = 1 << 6; ///< Past U+10FFFF, with a continuation of 1000____
+		constexpr uint8_t Overlong4 = 1 << 6; ///< Shares a bit with TooLarge1000, as they never come from the same lead
+		constexpr uint8_t TwoContinuations = 1 << 7; ///< Allowed only where a three or four byte sequence needs it
+		/// @brief Errors decided by the high nibble of the first byte alone
+		constexpr uint8_t Carry = TooShort | TooLong | TwoContinuations;
+
+		/// @brief Indexed by the high nibble of the first byte
+		constexpr uint8_t FirstHigh[16] = {
+			TooLong, TooLong, TooLong, TooLong, TooLong, TooLong, TooLong, TooLong,
+			TwoContinuations, TwoContinuations, TwoContinuations, TwoContinuations,
+			TooShort | Overlong2,
+			TooShort,
+			TooShort | Overlong3 | Surrogate,
+			TooShort | TooLarge | TooLarge1000 | Overlong4
+		};
+
+		/// @brief Indexed by the low nibble of the first byte
+		constexpr uint8_t FirstLow[16] = {
+			Carry | Overlong3 | Overlong2 | Overlong4,
+			Carry | Overlong2,
+			Carry,
+			Carry,
+			Carry | TooLarge,
+			Carry | TooLarge | TooLarge1000,
+			Carry | TooLarge | TooLarge1000,
+			Carry | TooLarge | TooLarge1000,
+			Carry | TooLarge | TooLarge1000,
+			Carry | TooLarge | TooLarge1000,
+			Carry | TooLarge | TooLarge1000,
+			Carry | TooLarge | TooLarge1000,
+			Carry | TooLarge | TooLarge1000,
+			Carry | TooLarge | TooLarge1000 | Surrogate,
+			Carry | TooLarge | TooLarge1000,
+			Carry | TooLarge | TooLarge1000
+		};
+
+		/// @brief Indexed by the high nibble of the second byte
+		constexpr uint8_t SecondHigh[16] = {
+			TooShort, TooShort, TooShort, TooShort, TooShort, TooShort, TooShort, TooShort,
+			TooLong | Overlong2 | TwoContinuations | Overlong3 | TooLarge1000 | Overlong4,
+			TooLong | Overlong2 | TwoContinuations | Overlong3 | TooLarge,
+			TooLong | Overlong2 | TwoContinuations | Surrogate | TooLarge,
+			TooLong | Overlong2 | TwoContinuations | Surrogate | TooLarge,
+			TooShort, TooShort, TooShort, TooShort
+		};
+	}
+
+	/// @returns Vector of the bytes count places before each byte, reaching back into the previous vector
+	template <int count>
+	CHCL_TARGET("avx2") inline __m256i PreviousBytes(__m256i chars, __m256i previous)
+	{
+		return _mm256_alignr_epi8(chars, _mm256_permute2x128_si256(previous, chars, 0x21), 16 - count);
+	}
+
+	/// @brief Loads a 16 entry table into both lanes, for _mm256_shuffle_epi8 to look up
+	CHCL_TARGET("avx2") inline __m256i LoadTable(const uint8_t (&table)[16])
+	{
+		return _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)table));
+	}
+
+	/**
+	 * @brief Validates UTF-8 32 bytes at a time, with the lookup tables of Keiser and Lemire's validator
+	 *
+	 * Every byte is classified together with the byte before it through three nibble lookups, which catches every error
+	 * except a missing or surplus third or fourth byte. Those are found by checking which bytes two and three places
+	 * after a lead must be continuations. Vectors of ASCII only need checking that no sequence was left open before them.
+	 */
+	CHCL_TARGET("avx2") bool ValidUtf8AVX2(std::string_view text)
+	{
+		const __m256i firstHigh = LoadTable(Utf8Error::FirstHigh);
+		const __m256i firstLow = LoadTable(Utf8Error::FirstLow);
+		const __m256i secondHigh = LoadTable(Utf8Error::SecondHigh);
+		const __m256i lowNibble = _mm256_set1_epi8(0x0F);
+		const __m256i highBit = _mm256_set1_epi8(char(0x80));
+		// Subtracted with saturation, these leave the high bit set only on bytes of at least 0xE0 and 0xF0
+		const __m256i thirdByteLead = _mm256_set1_epi8(char(0xE0 - 0x80));
+		const __m256i fourthByteLead = _mm256_set1_epi8(char(0xF0 - 0x80));
+		// Lead bytes that need more continuations than the vector has left after them
+		const __m256i incompleteLimit = _mm256_setr_epi8(
+			-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+			-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, char(0xF0 - 1), char(0xE0 - 1), char(0xC0 - 1));
+
+		__m256i previous = _mm256_setzero_si256();
+		__m256i incomplete = _mm256_setzero_si256();
+		__m256i error = _mm256_setzero_si256();
+		for (size_t i = 0; i < text.length(); i += 32)
+		{
+			__m256i chars;
+			if (i + 32 <= text.length())
+				chars = _mm256_loadu_si256((const __m256i*)(text.data() + i));
+			else
+			{
+				// Padded with zeros, which are ASCII and so end a sequence left open by the text
+				alignas(32) char tail[32] = {};
+				std::memcpy(tail, text.data() + i, text.length() - i);
+				chars = _mm256_load_si256((const __m256i*)tail);
+			}
+
+			if (_mm256_movemask_epi8(chars) == 0)
+				error = _mm256_or_si256(error, incomplete);
+			else
+			{
+				__m256i previous1 = PreviousBytes<1>(chars, previous);
+				__m256i pairErrors = _mm256_and_si256(
+					_mm256_and_si256(
+						_mm256_shuffle_epi8(firstHigh, _mm256_and_si256(_mm256_srli_epi16(previous1, 4), lowNibble)),
+						_mm256_shuffle_epi8(firstLow, _mm256_and_si256(previous1, lowNibble))),
+					_mm256_shuffle_epi8(secondHigh, _mm256_and_si256(_mm256_srli_epi16(chars, 4), lowNibble)));
+
+				// Two continuations in a row are only valid as the third or fourth byte of a sequence
+				__m256i mustContinue = _mm256_and_si256(_mm256_or_si256(
+					_mm256_subs_epu8(PreviousBytes<2>(chars, previous), thirdByteLead),
+					_mm256_subs_epu8(PreviousBytes<3>(chars, previous), fourthByteLead)), highBit);
+				error = _mm256_or_si256(error, _mm256_xor_si256(mustContinue, pairErrors));
+			}
+
+			if (!_mm256_testz_si256(error, error))
+				return false;
+			incomplete = _mm256_subs_epu8(chars, incompleteLimit);
+			previous = chars;
+		}
+		return _mm256_testz_si256(incomplete, incomplete);
+	}
+#endif
+}
+
+size_t chcl::JSON_Strings::FindQuoteOrBackslash(std::string_view text, size_t from)
+{
+	return Find<Quote | Backslash>(text, from);
+}
+
+size_t chcl::JSON_Strings::FindBackslash(std::string_view text, size_t from)
+{
+	return Find<Backslash>(text, from);
+}
+
+size_t chcl::JSON_Strings::FindEscapable(std::string_view text, size_t from)
+{
+	return Find<Quote | Backslash | Control>(text, from);
+}
+
+size_t chcl::JSON_Strings::Unescape(std::string_view raw, char *out)
+{
+	char *begin = out;
+	size_t runBegin = 0;
+	while (true)
+	{
+		size_t backslash = FindBackslash(raw, runBegin);
+		size_t runEnd = backslash == npos ? raw.length() : backslash;
+		if (runEnd > runBegin)
+		{
+			std::memcpy(out, raw.data() + runBegin, runEnd - runBegin);
+			out += runEnd - runBegin;
+		}
+
+		if (backslash == npos)
+			break;
+		if (backslash + 1 == raw.length())
+		{
+			*out++ = '\\';
+			break;
+		}
+
+		runBegin = backslash + 2;
+		char escaped = raw[backslash + 1];
+		switch (escaped)
+		{
+			case 'b': *out++ = '\b'; break;
+			case 'f': *out++ = '\f'; break;
+			case 'n': *out++ = '\n'; break;
+			case 'r': *out++ = '\r'; break;
+			case 't': *out++ = '\t'; break;
+			case 'u':
+			{
+				uint32_t codePoint;
+				if (!ReadUnicodeEscape(raw, backslash, codePoint))
+				{
+					*out++ = escaped;
+					break;
+				}
+				runBegin = backslash + 6;
+
+				if (codePoint >= 0xD800 && codePoint <= 0xDFFF)
+				{
+					// A high surrogate must be followed by an escaped low surrogate to form a code point
+					uint32_t low;
+					if (codePoint <= 0xDBFF && ReadUnicodeEscape(raw, runBegin, low) && low >= 0xDC00 && low <= 0xDFFF)
+					{
+						codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+						runBegin += 6;
+					}
+					else
+						codePoint = 0xFFFD;
+				}
+				out += WriteUtf8(codePoint, out);
+				break;
+			}
+			default:
+				*out++ = escaped;
+		}
+	}
+	return size_t(out - begin);
+}
+
+size_t chcl::JSON_Strings::EscapeSequence(char c, char *out)
+{
+	out[0] = '\\';
+	switch (c)
+	{
+		case '\"': out[1] = '\"'; return 2;
+		case '\\': out[1] = '\\'; return 2;
+		case '\b': out[1] = 'b'; return 2;
+		case '\f': out[1] = 'f'; return 2;
+		case '\n': out[1] = 'n'; return 2;
+		case '\r': out[1] = 'r'; return 2;
+		case '\t': out[1] = 't'; return 2;
+	}
+
+	constexpr char Digits[] = "0123456789abcdef";
+	unsigned char code = static_cast<unsigned char>(c);
+	out[1] = 'u';
+	out[2] = '0';
+	out[3] = '0';
+	out[4] = Digits[code >> 4];
+	out[5] = Digits[code & 0xF];
+	return 6;
+}
+
+bool chcl::JSON_Strings::ValidUtf8(std::string_view text)
+{
+#ifdef CHCL_X86
+	if (CPUFeatures::HasAVX2())
+		return ValidUtf8AVX2(text);
+#endif
+
+	// Without AVX2, ASCII is skipped a vector at a time and only multi-byte sequences are decoded
+	const unsigned char *data = reinterpret_cast<const unsigned char*>(text.data());
+	size_t i = 0;
+	while (i < text.length())
+	{
+#ifdef CHCL_JSON_SSE2
+		while (i + 16 <= text.length() && _mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(text.data() + i))) == 0)
+			i += 16;
+#endif
+		size_t nonAscii = FindScalar(text, i, [](unsigned char c) { return c >= 0x80; });
+		if (nonAscii == npos)
+			return true;
+		i = nonAscii;
+
+		unsigned char lead = data[i];
+		size_t length;
+		uint32_t minimum;
+		uint32_t codePoint;
+		if (lead >= 0xC2 && lead <= 0xDF)
+		{
+			length = 2;
+			minimum = 0x80;
+			codePoint = lead & 0x1F;
+		}
+		else if ((lead & 0xF0) == 0xE0)
+		{
+			length = 3;
+			minimum = 0x800;
+			codePoint = lead & 0x0F;
+		}
+		else if (lead >= 0xF0 && lead <= 0xF4)
+		{
+			length = 4;
+			minimum = 0x10000;
+			codePoint = lead & 0x07;
+		}
+		else
+			return false;
+
+		if (i + length > text.length())
+			return false;
+		for (size_t j = 1; j < length; ++j)
+		{
+			if ((data[i + j] & 0xC0) != 0x80)
+				return false;
+			codePoint = (codePoint << 6) | (data[i + j] & 0x3F);
+		}
+
+		if (codePoint < minimum || codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF))
+			return false;
+		i += length;
+	}
+	return true;
+}
\ No newline at end of file
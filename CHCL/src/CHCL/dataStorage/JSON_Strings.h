@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+namespace chcl
+{
+	/**
+	 * @brief Namespace containing the string routines shared by the JSON readers and writers.
+	 *
+	 * Searches compare 32 bytes at a time with AVX2 or 16 with SSE2, with a scalar fallback,
+	 * so runs of plain characters are skipped and copied in bulk rather than one character at a time.
+	 * AVX2 is used when the CPU supports it, whatever the library was compiled for.
+	 */
+	namespace JSON_Strings
+	{
+		constexpr size_t npos = ~size_t(0);
+
+		/// @returns Position of the first quote or backslash at or after from, or npos
+		size_t FindQuoteOrBackslash(std::string_view text, size_t from = 0);
+
+		/// @returns Position of the first backslash at or after from, or npos
+		size_t FindBackslash(std::string_view text, size_t from = 0);
+
+		/// @returns Position of the first character that must be escaped in a JSON string at or after from, or npos
+		size_t FindEscapable(std::string_view text, size_t from = 0);
+
+		/**
+		 * @brief Resolves the escape sequences of a string's contents, including \\uXXXX and surrogate pairs
+		 * \\u escapes are written as UTF-8, and unpaired surrogates as U+FFFD.
+		 * Unknown escapes resolve to the escaped character
+		 * @param raw String text without its surrounding quotes
+		 * @param out Destination with room for at least raw.length() characters, as decoding never lengthens a string
+		 * @return Number of characters written
+		 */
+		size_t Unescape(std::string_view raw, char *out);
+
+		/**
+		 * @brief Writes the escape sequence for a character that FindEscapable stopped at
+		 * @param out Destination with room for 6 characters
+		 * @return Number of characters written
+		 */
+		size_t EscapeSequence(char c, char *out);
+
+		/**
+		 * @brief Escapes a string's contents for JSON, without surrounding quotes
+		 * @param append Called as append(const char *data, size_t length) for each piece of output
+		 */
+		template <typename Append>
+		void Escape(std::string_view str, Append &&append)
+		{
+			size_t runBegin = 0;
+			for (size_t special = FindEscapable(str); special != npos; special = FindEscapable(str, runBegin))
+			{
+				append(str.data() + runBegin, special - runBegin);
+
+				char sequence[6];
+				append(sequence, EscapeSequence(str[special], sequence));
+				runBegin = special + 1;
+			}
+			append(str.data() + runBegin, str.length() - runBegin);
+		}
+
+		/**
+		 * @brief Checks that text is well-formed UTF-8
+		 * Overlong forms, surrogates and code points past U+10FFFF are rejected.
+		 * With AVX2 every byte is checked with table lookups 32 at a time, otherwise only ASCII is skipped in bulk
+		 */
+		bool ValidUtf8(std::string_view text);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,303 @@
+#include "JSON_Tape.h"
+
+#include "JSON_Scanner.h"
+#include "JSON_Strings.h"
+
+namespace
+{
+	chcl::JSON_Type TokenType(std::string_view token)
+	{
+		if (token == "true") return chcl::JSON_Type::True;
+		if (token == "false") return chcl::JSON_Type::False;
+		if (token == "null") return chcl::JSON_Type::Null;
+		return chcl::JSON_Type::Number;
+	}
+}
+
+chcl::JSON_Tape::JSON_Tape(std::string source) :
+	m_ownedSource(std::move(source)),
+	m_source(m_ownedSource)
+{
+	if (!parse())
+		m_nodes.clear();
+}
+
+chcl::JSON_Tape::JSON_Tape(const char *data, size_t length) :
+	m_source(data, length)
+{
+	if (!parse())
+		m_nodes.clear();
+}
+
+chcl::JSON_Tape::JSON_Tape(std::string source, std::vector<JSON_Node> nodes) :
+	m_ownedSource(std::move(source)),
+	m_source(m_ownedSource),
+	m_nodes(std::move(nodes))
+{
+	for (JSON_Node &node : m_nodes)
+	{
+		if (node.type == JSON_Type::String)
+			node.count = uint32_t(m_stringCount++);
+		m_binary |= node.format != JSON_NumberFormat::Text;
+	}
+}
+
+bool chcl::JSON_Tape::assign(const char *data, size_t length)
+{
+	m_ownedSource.clear();
+	m_source = std::string_view(data, length);
+	if (!parse())
+		m_nodes.clear();
+	return valid();
+}
+
+void chcl::JSON_Tape::ownSource()
+{
+	if (m_source.data() == m_ownedSource.data())
+		return;
+
+	// Nodes refer to the source by offset, so they stay valid in the copy
+	m_ownedSource.assign(m_source);
+	m_source = m_ownedSource;
+}
+
+std::string chcl::JSON_Tape::json(size_t index) const
+{
+	if (!m_binary)
+		return std::string(text(index));
+
+	std::string out;
+	appendJson(index, out);
+	return out;
+}
+
+void chcl::JSON_Tape::appendJson(size_t index, std::string &out) const
+{
+	const JSON_Node &node = m_nodes[index];
+	switch (node.type)
+	{
+		case JSON_Type::Object:
+			out.push_back('{');
+			for (size_t key = index + 1; key < node.next; key = m_nodes[key + 1].next)
+			{
+				if (key != index + 1)
+					out.push_back(',');
+				out += text(key);
+				out.push_back(':');
+				appendJson(key + 1, out);
+			}
+			out.push_back('}');
+			break;
+		case JSON_Type::Array:
+			out.push_back('[');
+			for (size_t element = index + 1; element < node.next; element = m_nodes[element].next)
+			{
+				if (element != index + 1)
+					out.push_back(',');
+				appendJson(element, out);
+			}
+			out.push_back(']');
+			break;
+		case JSON_Type::Number:
+			if (node.format != JSON_NumberFormat::Text)
+			{
+				visitNumber(index, [&out](auto value)
+					{
+						// Single precision values are rendered at double precision, which keeps their exact value when read as a double
+						using Rendered = std::conditional_t<std::is_same_v<decltype(value), float>, double, decltype(value)>;
+						if constexpr (std::is_floating_point_v<Rendered>)
+						{
+							if (!std::isfinite(value))
+							{
+								out += "null";
+								return;
+							}
+						}
+
+						char buffer[32];
+						auto [end, error] = std::to_chars(buffer, buffer + sizeof(buffer), Rendered(value));
+						out.append(buffer, end);
+					});
+				break;
+			}
+			[[fallthrough]];
+		default:
+			out += text(index);
+	}
+}
+
+bool chcl::JSON_Tape::readString(size_t index, std::string &out) const
+{
+	const JSON_Node &node = m_nodes[index];
+	if (node.type != JSON_Type::String)
+	{
+		out.clear();
+		return false;
+	}
+
+	Unescape(m_source.substr(node.begin + 1, node.end - node.begin - 2), out);
+	return true;
+}
+
+void chcl::JSON_Tape::Unescape(std::string_view raw, std::string &out)
+{
+	out.resize(raw.length());
+	out.resize(Unescape(raw, out.data()));
+}
+
+size_t chcl::JSON_Tape::Unescape(std::string_view raw, char *out)
+{
+	return JSON_Strings::Unescape(raw, out);
+}
+
+size_t chcl::JSON_Tape::findMember(size_t object, std::string_view key) const
+{
+	if (m_nodes[object].type != JSON_Type::Object)
+		return npos;
+
+	std::string decodedKey;
+	for (size_t keyIndex = object + 1; keyIndex < m_nodes[object].next; keyIndex = m_nodes[keyIndex + 1].next)
+	{
+		std::string_view rawKey = text(keyIndex);
+		rawKey = rawKey.substr(1, rawKey.length() - 2);
+
+		// Only decode keys that actually contain escapes
+		if (rawKey.find('\\') == std::string_view::npos)
+		{
+			if (rawKey == key)
+				return keyIndex + 1;
+		}
+		else if (readString(keyIndex, decodedKey) && decodedKey == key)
+			return keyIndex + 1;
+	}
+	return npos;
+}
+
+bool chcl::JSON_Tape::parse()
+{
+	enum class State
+	{
+		Value, ///< Expecting an element, or the end of an array
+		Key, ///< Expecting a member name, or the end of an object
+		AfterValue ///< Expecting a separator or the end of the enclosing container
+	};
+
+	// Only structural characters are visited, whitespace and string contents are skipped by the scanner
+	std::string_view text = m_source;
+	JSON_Scanner scanner{ text };
+	std::vector<size_t> &openContainers = m_openContainers;
+	State state = State::Value;
+
+	m_nodes.clear();
+	m_stringCount = 0;
+	m_binary = false;
+	openContainers.clear();
+
+	auto addNode = [this](JSON_Type type, size_t begin, size_t end)
+	{
+		uint32_t count = type == JSON_Type::String ? uint32_t(m_stringCount++) : 0;
+		m_nodes.push_back(JSON_Node{ type, JSON_NumberFormat::Text, count, begin, end, m_nodes.size() + 1 });
+	};
+
+	// The scanner returns opening and closing quotes as a pair
+	auto stringEnd = [&scanner]()
+	{
+		size_t closingQuote = scanner.next();
+		return closingQuote == JSON_Scanner::npos ? npos : closingQuote + 1;
+	};
+
+	while (true)
+	{
+		// Only the parsed element is validated, as anything after it is ignored
+		if (state == State::AfterValue && openContainers.empty())
+			return JSON_Strings::ValidUtf8(text.substr(0, m_nodes[0].end));
+
+		size_t index = scanner.next();
+		if (index == JSON_Scanner::npos)
+			return false;
+
+		char c = text[index];
+
+		if (state == State::AfterValue)
+		{
+			JSON_Node &container = m_nodes[openContainers.back()];
+			bool isObject = container.type == JSON_Type::Object;
+
+			if (c == ',')
+				state = isObject ? State::Key : State::Value;
+			else if (c == (isObject ? '}' : ']'))
+			{
+				container.end = index + 1;
+				container.next = m_nodes.size();
+				openContainers.pop_back();
+			}
+			else
+				return false;
+
+			continue;
+		}
+
+		// Closing brackets are accepted straight after an opening bracket or a trailing comma
+		if (!openContainers.empty() && c == (state == State::Key ? '}' : ']'))
+		{
+			JSON_Node &container = m_nodes[openContainers.back()];
+			if ((container.type == JSON_Type::Object) != (state == State::Key))
+				return false;
+
+			container.end = index + 1;
+			container.next = m_nodes.size();
+			openContainers.pop_back();
+			state = State::AfterValue;
+			continue;
+		}
+
+		// Object members are counted by their key, array elements by their value
+		if (!openContainers.empty() && (state == State::Key || m_nodes[openContainers.back()].type == JSON_Type::Array))
+			++m_nodes[openContainers.back()].count;
+
+		if (state == State::Key)
+		{
+			size_t keyEnd = c == '\"' ? stringEnd() : npos;
+			if (keyEnd == npos)
+				return false;
+			addNode(JSON_Type::String, index, keyEnd);
+
+			size_t colon = scanner.next();
+			if (colon == JSON_Scanner::npos || text[colon] != ':')
+				return false;
+			state = State::Value;
+			continue;
+		}
+
+		switch (c)
+		{
+			case '{':
+			case '[':
+				openContainers.push_back(m_nodes.size());
+				addNode(c == '{' ? JSON_Type::Object : JSON_Type::Array, index, index + 1);
+				state = c == '{' ? State::Key : State::Value;
+				continue;
+			case '\"':
+			{
+				size_t end = stringEnd();
+				if (end == npos)
+					return false;
+				addNode(JSON_Type::String, index, end);
+				break;
+			}
+			case ',':
+			case ':':
+			case '}':
+			case ']':
+				return false;
+			default:
+			{
+				size_t tokenEnd = JSON_Scanner::TokenEnd(text, index);
+				addNode(TokenType(text.substr(index, tokenEnd - index)), index, tokenEnd);
+				break;
+			}
+		}
+
+		state = State::AfterValue;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,325 @@
+#pragma once
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace chcl
+{
+	/**
+	 * @brief Arithmetic types stored as JSON numbers.
+	 * Character types are excluded, as streams treat them as text.
+	 */
+	template <typename T>
+	concept JSON_Number = std::is_arithmetic_v<T> && !std::is_same_v<T, bool> &&
+		!std::is_same_v<T, char> && !std::is_same_v<T, signed char> && !std::is_same_v<T, unsigned char> &&
+		!std::is_same_v<T, wchar_t> && !std::is_same_v<T, char8_t> && !std::is_same_v<T, char16_t> && !std::is_same_v<T, char32_t>;
+
+	enum class JSON_Type : uint8_t
+	{
+		Object, Array, String, Number, True, False, Null
+	};
+
+	/**
+	 * @brief How a Number node's value is stored in the source.
+	 * Text numbers are parsed from their characters. The others, decoded from binary formats, are the bytes of the value in native byte order
+	 */
+	enum class JSON_NumberFormat : uint8_t
+	{
+		Text, Int8, UInt8, Int16, UInt16, Int32, UInt32, Int64, UInt64, Float, Double
+	};
+
+	/**
+	 * @brief Single element of a JSON_Tape
+	 */
+	struct JSON_Node
+	{
+		JSON_Type type;
+		/// @brief Storage of a Number's value. Arrays decoded from packed memory have the format of their elements, which are stored back to back
+		JSON_NumberFormat format = JSON_NumberFormat::Text;
+		uint32_t count = 0; ///< Number of members/elements, for objects and arrays. For strings, the number of strings before this one
+		size_t begin = 0; ///< Offset of the first character of the element in the source
+		size_t end = 0; ///< Offset one past the last character of the element in the source
+		size_t next = 0; ///< Tape index following this element and all of its children
+	};
+
+	/**
+	 * @brief Flat, single-pass parse of a JSON document.
+	 *
+	 * Every element is stored as a node in document order, with containers followed directly by their children.
+	 * Object members are stored as a String key node followed by the value's nodes.
+	 * Element text is not copied: nodes refer to offsets in the source, which the tape either owns or borrows.
+	 * Tapes decoded from binary formats keep numbers as their binary values, so only json() gives the text of every element.
+	 */
+	class JSON_Tape
+	{
+	public:
+		static constexpr size_t npos = ~size_t(0);
+
+		/**
+		 * @brief Parses a JSON document
+		 * @param source JSON text. Only the first element is parsed, anything after it is ignored
+		 */
+		explicit JSON_Tape(std::string source);
+
+		/**
+		 * @brief Parses a JSON document without copying it
+		 * @param data JSON text, which must outlive the tape
+		 * @param length Length of the text in bytes
+		 */
+		JSON_Tape(const char *data, size_t length);
+
+		/**
+		 * @brief Adopts nodes already built over a source, such as by a decoder of a binary encoding
+		 * @param source JSON text and binary numbers the nodes refer to
+		 * @param nodes Nodes laid out as parse() would produce them. Strings are numbered here, so their count can be left at 0
+		 */
+		JSON_Tape(std::string source, std::vector<JSON_Node> nodes);
+
+		/**
+		 * @brief Creates an empty, invalid tape to assign documents to later
+		 */
+		JSON_Tape() = default;
+
+		// Nodes refer to the source by offset, so the tape is pinned in place
+		JSON_Tape(const JSON_Tape&) = delete;
+		JSON_Tape& operator=(const JSON_Tape&) = delete;
+
+		/**
+		 * @brief Parses another document without copying it, reusing the storage of the previous one
+		 * @param data JSON text, which must outlive the tape or the next call to assign
+		 * @param length Length of the text in bytes
+		 * @return Whether the text held a well-formed element
+		 */
+		bool assign(const char *data, size_t length);
+
+		/**
+		 * @brief Copies a borrowed source into the tape, so the original text no longer has to outlive it
+		 * Does nothing if the tape already owns its source
+		 */
+		void ownSource();
+
+		/// @brief Whether the source held a well-formed element
+		inline bool valid() const { return !m_nodes.empty(); }
+
+		inline size_t size() const { return m_nodes.size(); }
+		/// @brief Number of String nodes, including member names. Each string's count is its position among them
+		inline size_t stringCount() const { return m_stringCount; }
+		inline const JSON_Node& operator[](size_t index) const { return m_nodes[index]; }
+
+		inline std::string_view source() const { return m_source; }
+		/// @brief Raw source text of an element, including quotes and brackets. Meaningless for elements holding binary numbers
+		inline std::string_view text(size_t index) const
+		{
+			const JSON_Node &node = m_nodes[index];
+			return m_source.substr(node.begin, node.end - node.begin);
+		}
+
+		/// @brief Whether some numbers are stored as binary values rather than text
+		inline bool binary() const { return m_binary; }
+
+		/**
+		 * @brief Compact JSON text of an element
+		 * Elements of text documents are copied from the source, and those of binary documents are rendered
+		 */
+		std::string json(size_t index) const;
+
+		/**
+		 * @brief Decodes a String node, resolving escape sequences
+		 * @return Whether the node was a string
+		 */
+		bool readString(size_t index, std::string &out) const;
+
+		/**
+		 * @brief Decodes a Number node
+		 * @return Whether the node was a number that could be represented as T
+		 */
+		template <JSON_Number T>
+		bool readNumber(size_t index, T &out) const
+		{
+			const JSON_Node &node = m_nodes[index];
+			if (node.type != JSON_Type::Number)
+				return false;
+			if (node.format == JSON_NumberFormat::Text)
+				return ParseNumber(m_source.data() + node.begin, m_source.data() + node.end, out);
+			return visitNumber(index, [&out](auto value) { return ConvertNumber(value, out); });
+		}
+
+		/**
+		 * @brief Calls a function with the value of a binary Number node, as the type it is stored as
+		 * @return Result of the function
+		 */
+		template <typename Function>
+		decltype(auto) visitNumber(size_t index, Function &&function) const
+		{
+			const char *data = m_source.data() + m_nodes[index].begin;
+			switch (m_nodes[index].format)
+			{
+				case JSON_NumberFormat::Int8: return function(LoadNumber<int8_t>(data));
+				case JSON_NumberFormat::UInt8: return function(LoadNumber<uint8_t>(data));
+				case JSON_NumberFormat::Int16: return function(LoadNumber<int16_t>(data));
+				case JSON_NumberFormat::UInt16: return function(LoadNumber<uint16_t>(data));
+				case JSON_NumberFormat::Int32: return function(LoadNumber<int32_t>(data));
+				case JSON_NumberFormat::UInt32: return function(LoadNumber<uint32_t>(data));
+				case JSON_NumberFormat::Int64: return function(LoadNumber<int64_t>(data));
+				case JSON_NumberFormat::UInt64: return function(LoadNumber<uint64_t>(data));
+				case JSON_NumberFormat::Float: return function(LoadNumber<float>(data));
+				default: return function(LoadNumber<double>(data));
+			}
+		}
+
+		/**
+		 * @brief Decodes an array of numbers straight into memory
+		 * @param array Tape index of an Array node
+		 * @param out Destination for count numbers
+		 * @return Whether the node was an array of exactly count numbers. Some of out may be written even if not
+		 */
+		template <JSON_Number T>
+		bool readNumbers(size_t array, T *out, size_t count) const
+		{
+			const JSON_Node &node = m_nodes[array];
+			if (node.type != JSON_Type::Array || node.count != count)
+				return false;
+
+			// Arrays decoded from packed memory of the same type are copied as a whole
+			if (node.format != JSON_NumberFormat::Text && node.format == NumberFormatOf<T>())
+			{
+				std::memcpy(out, m_source.data() + node.begin, count * sizeof(T));
+				return true;
+			}
+
+			// Numbers have no children, so as long as every element is a number they occupy consecutive nodes
+			for (size_t i = 0; i < count; ++i)
+			{
+				if (!readNumber(array + 1 + i, out[i]))
+					return false;
+			}
+			return true;
+		}
+
+		/**
+		 * @brief Converts number text without regard to locale
+		 * Integers also accept text in floating point form, such as 3.0 or 1e3
+		 * @return Whether the whole text was a valid number
+		 */
+		template <JSON_Number T>
+		static bool ParseNumber(const char *begin, const char *end, T &out)
+		{
+			auto [numberEnd, error] = std::from_chars(begin, end, out);
+			if (error == std::errc() && numberEnd == end)
+				return true;
+
+			if constexpr (std::is_integral_v<T>)
+			{
+				double real = 0.0;
+				auto [realEnd, realError] = std::from_chars(begin, end, real);
+				if (realError == std::errc() && realEnd == end)
+					return ConvertNumber(real, out);
+			}
+			return false;
+		}
+
+		/**
+		 * @brief Converts a number to another arithmetic type, with the same rules as ParseNumber
+		 * Reals are truncated to integers, and the conversion fails if the value does not fit in T
+		 */
+		template <JSON_Number T, typename From> requires std::is_arithmetic_v<From>
+		static bool ConvertNumber(From value, T &out)
+		{
+			if constexpr (std::is_integral_v<T> && std::is_integral_v<From>)
+			{
+				if (!std::in_range<T>(value))
+					return false;
+			}
+			else if constexpr (std::is_integral_v<T>)
+			{
+				// Converting a value that does not fit in T is undefined, so the range is checked first
+				double real = std::trunc(double(value));
+				constexpr double lowest = double(std::numeric_limits<T>::min());
+				const double limit = std::ldexp(1.0, std::numeric_limits<T>::digits);
+				if (!(real >= lowest && real < limit))
+					return false;
+				out = static_cast<T>(real);
+				return true;
+			}
+			else if constexpr (std::is_floating_point_v<From> && sizeof(T) < sizeof(From))
+			{
+				if (std::isfinite(value) && std::abs(value) > std::numeric_limits<T>::max())
+					return false;
+			}
+			out = static_cast<T>(value);
+			return true;
+		}
+
+		/// @returns Format of binary numbers stored as T, or Text if no format has T's layout
+		template <typename T> requires std::is_arithmetic_v<T>
+		static constexpr JSON_NumberFormat NumberFormatOf()
+		{
+			if constexpr (std::is_floating_point_v<T>)
+			{
+				if constexpr (std::is_same_v<T, float>) return JSON_NumberFormat::Float;
+				else if constexpr (std::is_same_v<T, double>) return JSON_NumberFormat::Double;
+				else return JSON_NumberFormat::Text;
+			}
+			else
+			{
+				constexpr bool sign = std::is_signed_v<T>;
+				if constexpr (sizeof(T) == 1) return sign ? JSON_NumberFormat::Int8 : JSON_NumberFormat::UInt8;
+				else if constexpr (sizeof(T) == 2) return sign ? JSON_NumberFormat::Int16 : JSON_NumberFormat::UInt16;
+				else if constexpr (sizeof(T) == 4) return sign ? JSON_NumberFormat::Int32 : JSON_NumberFormat::UInt32;
+				else if constexpr (sizeof(T) == 8) return sign ? JSON_NumberFormat::Int64 : JSON_NumberFormat::UInt64;
+				else return JSON_NumberFormat::Text;
+			}
+		}
+
+		/**
+		 * @brief Resolves the escape sequences of a string's contents. See JSON_Strings::Unescape
+		 * @param raw String text without its surrounding quotes
+		 * @param out Decoded string, replacing any previous contents
+		 */
+		static void Unescape(std::string_view raw, std::string &out);
+
+		/**
+		 * @brief Resolves the escape sequences of a string's contents into caller-provided memory
+		 * @param raw String text without its surrounding quotes
+		 * @param out Destination with room for at least raw.length() characters, as decoding never lengthens a string
+		 * @return Number of characters written
+		 */
+		static size_t Unescape(std::string_view raw, char *out);
+
+		/**
+		 * @brief Finds the value of an object member
+		 * @param object Tape index of an Object node
+		 * @param key Unescaped member name
+		 * @return Tape index of the member's value, or npos if not found
+		 */
+		size_t findMember(size_t object, std::string_view key) const;
+
+	private:
+		std::string m_ownedSource; ///< Empty if the source is borrowed
+		std::string_view m_source;
+		std::vector<JSON_Node> m_nodes;
+		size_t m_stringCount = 0;
+		bool m_binary = false;
+		std::vector<size_t> m_openContainers; ///< Parse stack, kept so assign does not reallocate it
+
+		bool parse();
+		void appendJson(size_t index, std::string &out) const;
+
+		/// @brief Reads a binary number, which is not necessarily aligned in the source
+		template <typename T>
+		static T LoadNumber(const char *data)
+		{
+			T value;
+			std::memcpy(&value, data, sizeof(T));
+			return value;
+		}
+	};
+}
\ No newline at end of file
@@ -0,0 +1,703 @@
+#include "JSON_Writer.h"
+
+#include "JSON_Strings.h"
+#include "NetworkOrder.h"
+
+namespace
+{
+	// CBOR initial bytes
+	constexpr uint8_t CborIndefiniteArray = 0x9f;
+	constexpr uint8_t CborIndefiniteMap = 0xbf;
+	constexpr uint8_t CborFalse = 0xf4;
+	constexpr uint8_t CborTrue = 0xf5;
+	constexpr uint8_t CborNull = 0xf6;
+	constexpr uint8_t CborFloat32 = 0xfa;
+	constexpr uint8_t CborFloat64 = 0xfb;
+	constexpr uint8_t CborBreak = 0xff;
+
+	// MessagePack type bytes
+	constexpr uint8_t PackNil = 0xc0;
+	constexpr uint8_t PackFalse = 0xc2;
+	constexpr uint8_t PackTrue = 0xc3;
+	constexpr uint8_t PackExt8 = 0xc7;
+	constexpr uint8_t PackExt16 = 0xc8;
+	constexpr uint8_t PackExt32 = 0xc9;
+	constexpr uint8_t PackFloat32 = 0xca;
+	constexpr uint8_t PackFloat64 = 0xcb;
+	constexpr uint8_t PackUint8 = 0xcc;
+	constexpr uint8_t PackInt8 = 0xd0;
+	constexpr uint8_t PackStr8 = 0xd9;
+	constexpr uint8_t PackStr16 = 0xda;
+	constexpr uint8_t PackStr32 = 0xdb;
+	constexpr uint8_t PackArray16 = 0xdc;
+	constexpr uint8_t PackArray32 = 0xdd;
+	constexpr uint8_t PackMap16 = 0xde;
+	constexpr uint8_t PackMap32 = 0xdf;
+
+	/// @brief Size of the placeholder written for a MessagePack container header
+	constexpr size_t PackHeaderSize = 5;
+
+	/// @returns Number of bytes written to out, holding value big endian in the given width
+	template <typename T>
+	size_t StoreBigEndian(uint8_t *out, T value)
+	{
+		value = chcl::NetworkOrder::convertTo(chcl::Endianness::Big, value);
+		std::memcpy(out, &value, sizeof(T));
+		return sizeof(T);
+	}
+}
+
+chcl::JSON_Writer::JSON_Writer(Buffer &out, Style style) :
+	m_out(&out),
+	m_style(style)
+{}
+
+chcl::JSON_Writer::JSON_Writer(Buffer &out, Format format) :
+	m_out(&out),
+	m_style(Style::Compact),
+	m_format(format)
+{}
+
+chcl::JSON_Writer::~JSON_Writer()
+{
+	flush();
+}
+
+chcl::JSON_Writer& chcl::JSON_Writer::beginObject()
+{
+	beginValue(true);
+	if (m_format != Format::Text)
+	{
+		beginBinaryContainer(true);
+		return *this;
+	}
+
+	write('{');
+	m_frames.push_back(Frame{ true });
+	return *this;
+}
+
+chcl::JSON_Writer& chcl::JSON_Writer::endObject()
+{
+	if (m_format != Format::Text)
+	{
+		endBinaryContainer();
+		return *this;
+	}
+
+	Frame frame = m_frames.back();
+	m_frames.pop_back();
+
+	if (!frame.empty && m_style == Style::Pretty)
+		newLine(m_frames.size());
+	write('}');
+	return *this;
+}
+
+chcl::JSON_Writer& chcl::JSON_Writer::beginArray()
+{
+	beginValue(true);
+	if (m_format != Format::Text)
+	{
+		beginBinaryContainer(false);
+		return *this;
+	}
+
+	write('[');
+	Frame frame{ false };
+	frame.body = m_out->size();
+	m_frames.push_back(frame);
+	return *this;
+}
+
+chcl::JSON_Writer& chcl::JSON_Writer::endArray()
+{
+	if (m_format != Format::Text)
+	{
+		endBinaryContainer();
+		return *this;
+	}
+
+	Frame frame = m_frames.back();
+	m_frames.pop_back();
+
+	if (!frame.empty && m_style == Style::Pretty)
+	{
+		if (frame.multiline)
+			newLine(m_frames.size());
+		else
+			write(' ');
+	}
+	write(']');
+	return *this;
+}
+
+chcl::JSON_Writer& chcl::JSON_Writer::key(std::string_view label)
+{
+	// A key anywhere but directly inside an object would make the output invalid
+	if (m_frames.empty() || !m_frames.back().object)
+		return *this;
+
+	Frame &frame = m_frames.back();
+	if (m_format != Format::Text)
+	{
+		++frame.count;
+		writeBinaryString(label);
+		m_afterKey = true;
+		return *this;
+	}
+
+	if (!frame.empty)
+		write(',');
+	frame.empty = false;
+
+	if (m_style == Style::Pretty)
+		newLine(m_frames.size());
+
+	writeString(label);
+	write(m_style == Style::Pretty ? std::string_view(": ") : std::string_view(":"));
+	m_afterKey = true;
+	return *this;
+}
+
+chcl::JSON_Writer& chcl::JSON_Writer::value(std::string_view str)
+{
+	beginValue(false);
+	if (m_format == Format::Text)
+		writeString(str);
+	else
+		writeBinaryString(str);
+	return *this;
+}
+
+chcl::JSON_Writer& chcl::JSON_Writer::value(bool val)
+{
+	beginValue(false);
+	if (m_format == Format::Cbor)
+		write(char(val ? CborTrue : CborFalse));
+	else if (m_format == Format::MessagePack)
+		write(char(val ? PackTrue : PackFalse));
+	else
+		write(val ? std::string_view("true") : std::string_view("false"));
+	return *this;
+}
+
+chcl::JSON_Writer& chcl::JSON_Writer::value(std::nullptr_t)
+{
+	beginValue(false);
+	if (m_format == Format::Text)
+		write("null");
+	else
+		writeBinaryNull();
+	return *this;
+}
+
+chcl::JSON_Writer& chcl::JSON_Writer::rawValue(std::string_view json)
+{
+	if (m_format != Format::Text)
+	{
+		JSON_Tape tape{ json.data(), json.length() };
+		return tape.valid() ? element(tape) : value(nullptr);
+	}
+
+	beginValue(json.find('\n') != std::string_view::npos);
+
+	if (m_style == Style::Compact)
+	{
+		// Whitespace between tokens is dropped, while strings are copied as they are
+		size_t runBegin = 0;
+		bool inString = false, escaped = false;
+		for (size_t i = 0; i < json.length(); ++i)
+		{
+			const char c = json[i];
+			if (inString)
+			{
+				if (escaped)
+					escaped = false;
+				else if (c == '\\')
+					escaped = true;
+				else if (c == '\"')
+					inString = false;
+			}
+			else if (c == '\"')
+				inString = true;
+			else if (c == ' ' || c == '\t' || c == '\n' || c == '\r')
+			{
+				if (i > runBegin)
+					write(json.substr(runBegin, i - runBegin));
+				runBegin = i + 1;
+			}
+		}
+		write(json.substr(runBegin));
+		return *this;
+	}
+
+	size_t lineBegin = 0;
+	size_t lineEnd;
+	while ((lineEnd = json.find('\n', lineBegin)) != std::string_view::npos)
+	{
+		write(json.substr(lineBegin, lineEnd - lineBegin));
+		newLine(m_frames.size());
+		lineBegin = lineEnd + 1;
+	}
+	write(json.substr(lineBegin));
+	return *this;
+}
+
+chcl::JSON_Writer& chcl::JSON_Writer::element(const JSON_Tape &tape, size_t index)
+{
+	std::string scratch;
+	writeElement(tape, index, scratch);
+	return *this;
+}
+
+void chcl::JSON_Writer::flush()
+{
+	if (!m_sink || !m_staging.size())
+		return;
+
+	// A single line array may still be broken onto separate lines, so its elements are held back
+	size_t settled = singleLineArray() ? m_frames.back().body : m_staging.size();
+	if (!settled)
+		return;
+
+	m_sink((const char*)m_staging.data(), settled);
+	size_t held = m_staging.size() - settled;
+	std::memmove(m_staging.data(), (const char*)m_staging.data() + settled, held);
+	m_staging.setSize(held);
+	if (held)
+		m_frames.back().body = 0;
+}
+
+void chcl::JSON_Writer::write(const char *data, size_t size)
+{
+	m_out->append(data, size);
+
+	// MessagePack headers are patched once their container ends, so open containers must stay staged
+	if (m_sink && m_staging.size() >= StagingSize && (m_format != Format::MessagePack || m_frames.empty()))
+		flush();
+}
+
+void chcl::JSON_Writer::newLine(size_t indent)
+{
+	char line[64];
+	line[0] = '\n';
+	while (true)
+	{
+		size_t tabs = std::min(indent, sizeof(line) - 1);
+		std::fill(line + 1, line + 1 + tabs, '\t');
+		write(line, tabs + 1);
+
+		if (tabs == indent)
+			break;
+		indent -= tabs;
+		line[0] = '\t';
+	}
+}
+
+void chcl::JSON_Writer::beginValue(bool container)
+{
+	if (m_afterKey || m_frames.empty())
+	{
+		m_afterKey = false;
+		return;
+	}
+
+	if (m_format != Format::Text)
+	{
+		++m_frames.back().count;
+		return;
+	}
+
+	// Object values always follow a key, so this is an array element
+	Frame &frame = m_frames.back();
+	if (m_style == Style::Pretty && container && !frame.multiline)
+	{
+		// Like JSON_Stream, an array holding a container puts every element on its own line
+		if (!frame.empty)
+			breakLines(frame);
+		frame.multiline = true;
+	}
+
+	if (!frame.empty)
+		write(',');
+
+	if (m_style == Style::Pretty)
+	{
+		if (frame.multiline)
+			newLine(m_frames.size());
+		else
+			write(' ');
+	}
+	frame.empty = false;
+}
+
+void chcl::JSON_Writer::breakLines(const Frame &frame)
+{
+	// Elements were written as " a, b, c", and are all plain values or single line raw text
+	std::string elements((const char*)(*m_out)[frame.body], m_out->size() - frame.body);
+	m_out->setSize(frame.body);
+
+	size_t begin = 1, depth = 0;
+	bool inString = false;
+	for (size_t i = begin; i <= elements.length(); ++i)
+	{
+		if (i < elements.length())
+		{
+			char c = elements[i];
+			if (inString)
+			{
+				if (c == '\\')
+					++i;
+				else if (c == '\"')
+					inString = false;
+				continue;
+			}
+
+			if (c == '\"')
+				inString = true;
+			else if (c == '[' || c == '{')
+				++depth;
+			else if (c == ']' || c == '}')
+				--depth;
+			if (c != ',' || depth)
+				continue;
+		}
+
+		if (begin > 1)
+			write(',');
+		newLine(m_frames.size());
+		write(elements.data() + begin, i - begin);
+		// Skip the space after the comma
+		begin = i + 2;
+	}
+}
+
+void chcl::JSON_Writer::writeString(std::string_view str)
+{
+	write('\"');
+
+	JSON_Strings::Escape(str, [this](const char *data, size_t length) { write(data, length); });
+
+	write('\"');
+}
+
+void chcl::JSON_Writer::writeElement(const JSON_Tape &tape, size_t index, std::string &scratch)
+{
+	const JSON_Node &node = tape[index];
+	switch (node.type)
+	{
+		case JSON_Type::Object:
+			beginObject();
+			for (size_t child = index + 1; child < node.next; child = tape[child + 1].next)
+			{
+				tape.readString(child, scratch);
+				key(scratch);
+				writeElement(tape, child + 1, scratch);
+			}
+			endObject();
+			break;
+		case JSON_Type::Array:
+			// Arrays decoded from packed memory are written back as a single typed array
+			if (m_format != Format::Text && node.format != JSON_NumberFormat::Text && node.count)
+			{
+				tape.visitNumber(index + 1, [&](auto first)
+					{
+						beginValue(false);
+						writeTypedArray(tape.source().data() + node.begin, node.end - node.begin, TypedArrayTag<decltype(first)>());
+					});
+				break;
+			}
+			beginArray();
+			for (size_t child = index + 1; child < node.next; child = tape[child].next)
+				writeElement(tape, child, scratch);
+			endArray();
+			break;
+		case JSON_Type::String:
+			tape.readString(index, scratch);
+			value(scratch);
+			break;
+		case JSON_Type::Number:
+			if (node.format != JSON_NumberFormat::Text)
+			{
+				tape.visitNumber(index, [this](auto number) { value(number); });
+				break;
+			}
+			if (m_format != Format::Text)
+			{
+				// Keep integers as integers, rather than letting them read as doubles
+				std::string_view text = tape.text(index);
+				const char *end = text.data() + text.length();
+				int64_t integer;
+				uint64_t unsignedInteger;
+				if (auto [integerEnd, error] = std::from_chars(text.data(), end, integer); error == std::errc() && integerEnd == end)
+					value(integer);
+				else if (auto [unsignedEnd, unsignedError] = std::from_chars(text.data(), end, unsignedInteger); unsignedError == std::errc() && unsignedEnd == end)
+					value(unsignedInteger);
+				else
+				{
+					double real = 0.0;
+					JSON_Tape::ParseNumber(text.data(), end, real);
+					value(real);
+				}
+				break;
+			}
+			rawValue(tape.text(index));
+			break;
+		default:
+			if (m_format == Format::Text)
+				rawValue(tape.text(index));
+			else if (node.type == JSON_Type::Null)
+				value(nullptr);
+			else
+				value(node.type == JSON_Type::True);
+	}
+}
+
+void chcl::JSON_Writer::beginBinaryContainer(bool object)
+{
+	Frame frame{ object };
+	frame.header = m_out->size();
+	m_frames.push_back(frame);
+
+	if (m_format == Format::Cbor)
+		write(char(object ? CborIndefiniteMap : CborIndefiniteArray));
+	else
+	{
+		const char placeholder[PackHeaderSize] = {};
+		write(placeholder, PackHeaderSize);
+	}
+}
+
+void chcl::JSON_Writer::endBinaryContainer()
+{
+	Frame frame = m_frames.back();
+	m_frames.pop_back();
+
+	if (m_format == Format::Cbor)
+	{
+		write(char(CborBreak));
+		return;
+	}
+
+	// Use the smallest header for the final size, and close the gap left by the placeholder
+	uint8_t header[PackHeaderSize];
+	size_t headerSize = 1;
+	if (frame.count < 16)
+		header[0] = uint8_t((frame.object ? 0x80 : 0x90) | frame.count);
+	else if (frame.count <= 0xffff)
+	{
+		header[0] = frame.object ? PackMap16 : PackArray16;
+		headerSize += StoreBigEndian(header + 1, uint16_t(frame.count));
+	}
+	else
+	{
+		header[0] = frame.object ? PackMap32 : PackArray32;
+		headerSize += StoreBigEndian(header + 1, uint32_t(frame.count));
+	}
+
+	uint8_t *out = (uint8_t*)(*m_out)[frame.header];
+	size_t bodySize = m_out->size() - frame.header - PackHeaderSize;
+	std::memcpy(out, header, headerSize);
+	if (headerSize < PackHeaderSize)
+	{
+		std::memmove(out + headerSize, out + PackHeaderSize, bodySize);
+		m_out->setSize(m_out->size() - (PackHeaderSize - headerSize));
+	}
+
+	if (m_frames.empty() && m_sink && m_staging.size() >= StagingSize)
+		flush();
+}
+
+void chcl::JSON_Writer::writeHead(uint8_t major, uint64_t argument)
+{
+	uint8_t head[9];
+	size_t size = 1;
+	major <<= 5;
+	if (argument < 24)
+		head[0] = uint8_t(major | argument);
+	else if (argument <= 0xff)
+	{
+		head[0] = major | 24;
+		head[size++] = uint8_t(argument);
+	}
+	else if (argument <= 0xffff)
+	{
+		head[0] = major | 25;
+		size += StoreBigEndian(head + 1, uint16_t(argument));
+	}
+	else if (argument <= 0xffffffff)
+	{
+		head[0] = major | 26;
+		size += StoreBigEndian(head + 1, uint32_t(argument));
+	}
+	else
+	{
+		head[0] = major | 27;
+		size += StoreBigEndian(head + 1, argument);
+	}
+	write((const char*)head, size);
+}
+
+void chcl::JSON_Writer::writeBinaryString(std::string_view str)
+{
+	if (m_format == Format::Cbor)
+		writeHead(3, str.length());
+	else
+	{
+		uint8_t head[5];
+		size_t size = 1;
+		if (str.length() < 32)
+			head[0] = uint8_t(0xa0 | str.length());
+		else if (str.length() <= 0xff)
+		{
+			head[0] = PackStr8;
+			head[size++] = uint8_t(str.length());
+		}
+		else if (str.length() <= 0xffff)
+		{
+			head[0] = PackStr16;
+			size += StoreBigEndian(head + 1, uint16_t(str.length()));
+		}
+		else
+		{
+			head[0] = PackStr32;
+			size += StoreBigEndian(head + 1, uint32_t(str.length()));
+		}
+		write((const char*)head, size);
+	}
+	write(str);
+}
+
+void chcl::JSON_Writer::writeBinaryNull()
+{
+	write(char(m_format == Format::Cbor ? CborNull : PackNil));
+}
+
+void chcl::JSON_Writer::writeBinaryInteger(int64_t number)
+{
+	if (number >= 0)
+	{
+		writeBinaryUnsigned(uint64_t(number));
+		return;
+	}
+
+	if (m_format == Format::Cbor)
+	{
+		writeHead(1, uint64_t(-1 - number));
+		return;
+	}
+
+	// Negative fixint, then int8 to int64 in order
+	uint8_t out[9];
+	size_t size = 1;
+	if (number >= -32)
+		out[0] = uint8_t(number);
+	else if (number >= INT8_MIN)
+	{
+		out[0] = PackInt8;
+		out[size++] = uint8_t(number);
+	}
+	else if (number >= INT16_MIN)
+	{
+		out[0] = PackInt8 + 1;
+		size += StoreBigEndian(out + 1, uint16_t(number));
+	}
+	else if (number >= INT32_MIN)
+	{
+		out[0] = PackInt8 + 2;
+		size += StoreBigEndian(out + 1, uint32_t(number));
+	}
+	else
+	{
+		out[0] = PackInt8 + 3;
+		size += StoreBigEndian(out + 1, uint64_t(number));
+	}
+	write((const char*)out, size);
+}
+
+void chcl::JSON_Writer::writeBinaryUnsigned(uint64_t number)
+{
+	if (m_format == Format::Cbor)
+	{
+		writeHead(0, number);
+		return;
+	}
+
+	// Positive fixint, then uint8 to uint64 in order
+	uint8_t out[9];
+	size_t size = 1;
+	if (number < 128)
+		out[0] = uint8_t(number);
+	else if (number <= 0xff)
+	{
+		out[0] = PackUint8;
+		out[size++] = uint8_t(number);
+	}
+	else if (number <= 0xffff)
+	{
+		out[0] = PackUint8 + 1;
+		size += StoreBigEndian(out + 1, uint16_t(number));
+	}
+	else if (number <= 0xffffffff)
+	{
+		out[0] = PackUint8 + 2;
+		size += StoreBigEndian(out + 1, uint32_t(number));
+	}
+	else
+	{
+		out[0] = PackUint8 + 3;
+		size += StoreBigEndian(out + 1, number);
+	}
+	write((const char*)out, size);
+}
+
+void chcl::JSON_Writer::writeBinaryFloat(double number, bool single)
+{
+	uint8_t out[9];
+	size_t size = 1;
+	if (single || double(float(number)) == number)
+	{
+		out[0] = m_format == Format::Cbor ? CborFloat32 : PackFloat32;
+		size += StoreBigEndian(out + 1, std::bit_cast<uint32_t>(float(number)));
+	}
+	else
+	{
+		out[0] = m_format == Format::Cbor ? CborFloat64 : PackFloat64;
+		size += StoreBigEndian(out + 1, std::bit_cast<uint64_t>(number));
+	}
+	write((const char*)out, size);
+}
+
+void chcl::JSON_Writer::writeTypedArray(const void *data, size_t size, uint8_t tag)
+{
+	if (m_format == Format::Cbor)
+	{
+		// Tag, then a byte string of the elements in native order
+		writeHead(6, tag);
+		writeHead(2, size);
+	}
+	else
+	{
+		uint8_t head[6];
+		size_t headSize = 1;
+		if (size <= 0xff)
+		{
+			head[0] = PackExt8;
+			head[headSize++] = uint8_t(size);
+		}
+		else if (size <= 0xffff)
+		{
+			head[0] = PackExt16;
+			headSize += StoreBigEndian(head + 1, uint16_t(size));
+		}
+		else
+		{
+			head[0] = PackExt32;
+			headSize += StoreBigEndian(head + 1, uint32_t(size));
+		}
+		head[headSize++] = tag;
+		write((const char*)head, headSize);
+	}
+	write((const char*)data, size);
+}
\ No newline at end of file
@@ -0,0 +1,299 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <concepts>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "Buffer.h"
+#include "JSON_Tape.h"
+
+namespace chcl
+{
+	/**
+	 * @brief Writes JSON text in a single pass, straight into a Buffer or an output iterator.
+	 *
+	 * Pretty output puts each object member on its own indented line and keeps arrays of plain values
+	 * on a single line, while arrays holding a container put every element on its own line, matching the
+	 * layout of JSON_Stream. Compact output contains no whitespace.
+	 * The same calls can instead produce CBOR or MessagePack, in which case arrays written through values()
+	 * become packed typed arrays (RFC 8746 tags in CBOR, and ext types with the same numbers in MessagePack).
+	 * To use with custom classes, overload operator<< with JSON_Writer as lhs.
+	 */
+	class JSON_Writer
+	{
+	public:
+		enum class Style : uint8_t
+		{
+			Compact, Pretty
+		};
+
+		enum class Format : uint8_t
+		{
+			Text, Cbor, MessagePack
+		};
+
+		/**
+		 * @brief Appends to a buffer
+		 * @param out Buffer to append to, which must outlive the writer
+		 */
+		explicit JSON_Writer(Buffer &out, Style style = Style::Pretty);
+
+		/**
+		 * @brief Appends to a buffer in the given format
+		 * Text is written in the compact style
+		 */
+		JSON_Writer(Buffer &out, Format format);
+
+		/**
+		 * @brief Writes through an output iterator, such as std::back_inserter or std::ostreambuf_iterator
+		 * Text is staged in a small internal buffer, and passed to the iterator when it fills up or on flush()
+		 */
+		template <typename OutputIt> requires std::output_iterator<OutputIt, char>
+		explicit JSON_Writer(OutputIt out, Style style = Style::Pretty) :
+			JSON_Writer(m_staging, style)
+		{
+			m_sink = [out](const char *data, size_t size) mutable { out = std::copy(data, data + size, out); };
+		}
+
+		/**
+		 * @brief Writes through an output iterator in the given format
+		 * MessagePack containers are only passed on once the outermost one is complete, as their headers hold their sizes
+		 */
+		template <typename OutputIt> requires std::output_iterator<OutputIt, char>
+		JSON_Writer(OutputIt out, Format format) :
+			JSON_Writer(m_staging, format)
+		{
+			m_sink = [out](const char *data, size_t size) mutable { out = std::copy(data, data + size, out); };
+		}
+
+		JSON_Writer(const JSON_Writer&) = delete;
+		JSON_Writer& operator=(const JSON_Writer&) = delete;
+		~JSON_Writer();
+
+		JSON_Writer& beginObject();
+		JSON_Writer& endObject();
+		JSON_Writer& beginArray();
+		JSON_Writer& endArray();
+
+		/**
+		 * @brief Writes the name of the next object member
+		 * Ignored unless the innermost open container is an object
+		 */
+		JSON_Writer& key(std::string_view label);
+
+		JSON_Writer& value(std::string_view str);
+		inline JSON_Writer& value(const char *str) { return value(std::string_view(str)); }
+		JSON_Writer& value(bool val);
+		JSON_Writer& value(std::nullptr_t);
+
+		/**
+		 * @brief Writes a number, using the shortest text that reads back to the same value
+		 * Non-finite floating point values have no JSON representation and are written as null
+		 */
+		template <typename T> requires (std::is_arithmetic_v<T> && !std::is_same_v<T, bool>)
+		JSON_Writer& value(T number)
+		{
+			beginValue(false);
+			writeNumber(number);
+			return *this;
+		}
+
+		/**
+		 * @brief Writes an array of numbers straight from memory
+		 * In binary formats the array is written as a single packed typed array
+		 */
+		template <typename T> requires (std::is_arithmetic_v<T> && !std::is_same_v<T, bool>)
+		JSON_Writer& values(const T *data, size_t count)
+		{
+			if constexpr (TypedArrayTag<T>() != 0)
+			{
+				if (m_format != Format::Text)
+				{
+					beginValue(false);
+					writeTypedArray(data, count * sizeof(T), TypedArrayTag<T>());
+					return *this;
+				}
+			}
+
+			beginArray();
+			for (size_t i = 0; i < count; ++i)
+			{
+				beginValue(false);
+				writeNumber(data[i]);
+			}
+			return endArray();
+		}
+
+		/**
+		 * @brief Writes already formatted JSON text as the next value
+		 * In compact mode, whitespace outside of strings is removed.
+		 * In pretty mode, each line after the first is indented to the current depth.
+		 * In binary formats the text is parsed and re-encoded, and malformed text is written as null
+		 */
+		JSON_Writer& rawValue(std::string_view json);
+
+		/**
+		 * @brief Rewrites a parsed element, so it takes on the writer's layout and format
+		 * @param tape Parsed document
+		 * @param index Tape index of the element
+		 */
+		JSON_Writer& element(const JSON_Tape &tape, size_t index = 0);
+
+		/**
+		 * @brief Passes any staged text to the output iterator
+		 */
+		void flush();
+
+		inline Style style() const { return m_style; }
+		inline Format format() const { return m_format; }
+		inline size_t depth() const { return m_frames.size(); }
+
+	private:
+		struct Frame
+		{
+			bool object;
+			bool empty = true;
+			bool multiline = false; ///< Pretty arrays become multiline once they contain a container
+			size_t body = 0; ///< Position of a pretty array's first element, while its elements may still be moved onto separate lines
+			size_t header = 0; ///< Position of a MessagePack container's header, patched once its size is known
+			size_t count = 0; ///< Number of MessagePack members or elements written so far
+		};
+
+		static constexpr size_t StagingSize = 4096;
+
+		Buffer *m_out;
+		Buffer m_staging;
+		std::function<void(const char*, size_t)> m_sink;
+		Style m_style;
+		Format m_format = Format::Text;
+
+		std::vector<Frame> m_frames;
+		bool m_afterKey = false;
+
+		inline void write(char c) { write(&c, 1); }
+		inline void write(std::string_view text) { write(text.data(), text.length()); }
+		void write(const char *data, size_t size);
+
+		void newLine(size_t indent);
+		/// @brief Writes the separator and indentation needed before the next value
+		void beginValue(bool container);
+		/// @brief Moves the plain values already written to a single line array onto lines of their own
+		void breakLines(const Frame &frame);
+		/// @returns Whether the innermost container is a pretty array still on a single line, which must stay staged
+		inline bool singleLineArray() const
+		{
+			return m_style == Style::Pretty && m_format == Format::Text && !m_frames.empty() && !m_frames.back().object && !m_frames.back().multiline;
+		}
+		void writeString(std::string_view str);
+		void writeElement(const JSON_Tape &tape, size_t index, std::string &scratch);
+
+		// Binary formats
+		void beginBinaryContainer(bool object);
+		void endBinaryContainer();
+		/// @brief Writes a CBOR initial byte and its argument
+		void writeHead(uint8_t major, uint64_t argument);
+		void writeBinaryString(std::string_view str);
+		void writeBinaryNull();
+		void writeBinaryInteger(int64_t number);
+		void writeBinaryUnsigned(uint64_t number);
+		/// @brief Writes a float in single precision when that is exact, and in double precision otherwise
+		void writeBinaryFloat(double number, bool single);
+		void writeTypedArray(const void *data, size_t size, uint8_t tag);
+
+		/**
+		 * @returns RFC 8746 tag of a typed array of T in native byte order, or 0 if there is none
+		 * The tag bits are 0b010fsell: float, signed, little endian and log2 of the element size
+		 */
+		template <typename T>
+		static constexpr uint8_t TypedArrayTag()
+		{
+			constexpr uint8_t littleEndian = std::endian::native == std::endian::little ? 0b100 : 0;
+			if constexpr (std::is_floating_point_v<T>)
+			{
+				if constexpr (sizeof(T) == 4) return 0b1010000 | littleEndian | 1;
+				else if constexpr (sizeof(T) == 8) return 0b1010000 | littleEndian | 2;
+				else return 0;
+			}
+			else
+			{
+				constexpr uint8_t sign = std::is_signed_v<T> ? 0b1000 : 0;
+				if constexpr (sizeof(T) == 1) return 0b1000000 | sign;
+				else if constexpr (sizeof(T) == 2) return 0b1000000 | sign | littleEndian | 1;
+				else if constexpr (sizeof(T) == 4) return 0b1000000 | sign | littleEndian | 2;
+				else if constexpr (sizeof(T) == 8) return 0b1000000 | sign | littleEndian | 3;
+				else return 0;
+			}
+		}
+
+		template <typename T>
+		void writeNumber(T number)
+		{
+			if constexpr (std::is_floating_point_v<T>)
+			{
+				if (!std::isfinite(number))
+				{
+					if (m_format == Format::Text)
+						write("null");
+					else
+						writeBinaryNull();
+					return;
+				}
+
+				if (m_format != Format::Text)
+				{
+					writeBinaryFloat(double(number), sizeof(T) <= sizeof(float));
+					return;
+				}
+			}
+			else if (m_format != Format::Text)
+			{
+				if constexpr (std::is_signed_v<T>)
+					writeBinaryInteger(int64_t(number));
+				else
+					writeBinaryUnsigned(uint64_t(number));
+				return;
+			}
+
+			char text[32];
+			auto [end, error] = std::to_chars(text, text + sizeof(text), number);
+			write(text, end - text);
+		}
+	};
+
+	/**
+	 * @brief Types that can be written with JSON_Writer's operator<<
+	 */
+	template <typename T>
+	concept JSON_Writable = requires(JSON_Writer &writer, const T &value) { writer << value; };
+
+	template <typename T> requires (std::is_arithmetic_v<T> && !std::is_same_v<T, bool>)
+	JSON_Writer& operator<<(JSON_Writer &writer, T number) { return writer.value(number); }
+
+	inline JSON_Writer& operator<<(JSON_Writer &writer, bool val) { return writer.value(val); }
+	inline JSON_Writer& operator<<(JSON_Writer &writer, const char *str) { return writer.value(str); }
+	inline JSON_Writer& operator<<(JSON_Writer &writer, std::string_view str) { return writer.value(str); }
+	inline JSON_Writer& operator<<(JSON_Writer &writer, const std::string &str) { return writer.value(str); }
+
+	template <JSON_Writable T>
+	JSON_Writer& operator<<(JSON_Writer &writer, const std::vector<T> &elem)
+	{
+		if constexpr (std::is_arithmetic_v<T> && !std::is_same_v<T, bool>)
+			return writer.values(elem.data(), elem.size());
+		else
+		{
+			writer.beginArray();
+			for (const T &item : elem)
+				writer << item;
+			return writer.endArray();
+		}
+	}
+}
\ No newline at end of file
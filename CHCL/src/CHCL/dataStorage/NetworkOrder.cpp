@@ -0,0 +1,93 @@
+#include "NetworkOrder.h"
+
+#include "CHCL/misc/CPUFeatures.h"
+
+namespace
+{
+	template <typename T>
+	void ReverseScalar(T *values, size_t begin, size_t count)
+	{
+		for (size_t i = begin; i < count; ++i)
+			values[i] = chcl::NetworkOrder::byteswap(values[i]);
+	}
+
+#ifdef CHCL_X86
+	/// @brief Shuffle mask reversing the bytes within each element of a 16 byte block
+	template <typename T>
+	constexpr auto SwapMask = []()
+	{
+		struct { alignas(16) uint8_t bytes[16]; } mask{};
+		for (uint8_t i = 0; i < 16; ++i)
+			mask.bytes[i] = uint8_t(i - i % sizeof(T) + sizeof(T) - 1 - i % sizeof(T));
+		return mask;
+	}();
+
+	enum class Kernel
+	{
+		Scalar, SSSE3, AVX2
+	};
+
+	Kernel SelectedKernel()
+	{
+		static const Kernel kernel = chcl::CPUFeatures::HasAVX2() ? Kernel::AVX2 : chcl::CPUFeatures::HasSSSE3() ? Kernel::SSSE3 : Kernel::Scalar;
+		return kernel;
+	}
+
+	template <typename T>
+	CHCL_TARGET("ssse3") void ReverseSSSE3(T *values, size_t count)
+	{
+		const __m128i mask = _mm_load_si128((const __m128i*)SwapMask<T>.bytes);
+		constexpr size_t step = 16 / sizeof(T);
+
+		size_t done = 0;
+		for (; done + step <= count; done += step)
+		{
+			__m128i block = _mm_loadu_si128((const __m128i*)(values + done));
+			_mm_storeu_si128((__m128i*)(values + done), _mm_shuffle_epi8(block, mask));
+		}
+		ReverseScalar(values, done, count);
+	}
+
+	template <typename T>
+	CHCL_TARGET("avx2") void ReverseAVX2(T *values, size_t count)
+	{
+		const __m128i mask = _mm_load_si128((const __m128i*)SwapMask<T>.bytes);
+		const __m256i wideMask = _mm256_broadcastsi128_si256(mask);
+		constexpr size_t wideStep = 32 / sizeof(T), step = 16 / sizeof(T);
+
+		size_t done = 0;
+		for (; done + wideStep <= count; done += wideStep)
+		{
+			__m256i block = _mm256_loadu_si256((const __m256i*)(values + done));
+			_mm256_storeu_si256((__m256i*)(values + done), _mm256_shuffle_epi8(block, wideMask));
+		}
+		for (; done + step <= count; done += step)
+		{
+			__m128i block = _mm_loadu_si128((const __m128i*)(values + done));
+			_mm_storeu_si128((__m128i*)(values + done), _mm_shuffle_epi8(block, mask));
+		}
+		ReverseScalar(values, done, count);
+	}
+#endif
+
+	template <typename T>
+	void ReverseArray(T *values, size_t count)
+	{
+#ifdef CHCL_X86
+		switch (SelectedKernel())
+		{
+			case Kernel::AVX2:
+				return ReverseAVX2(values, count);
+			case Kernel::SSSE3:
+				return ReverseSSSE3(values, count);
+			case Kernel::Scalar:
+				break;
+		}
+#endif
+		ReverseScalar(values, 0, count);
+	}
+}
+
+void chcl::NetworkOrder::reverseArray16(uint16_t *values, size_t count) { ReverseArray(values, count); }
+void chcl::NetworkOrder::reverseArray32(uint32_t *values, size_t count) { ReverseArray(values, count); }
+void chcl::NetworkOrder::reverseArray64(uint64_t *values, size_t count) { ReverseArray(values, count); }
\ No newline at end of file
@@ -1,6 +1,15 @@
 #pragma once
 
+#include <bit>
+#include <cstdint>
+#include <cstring>
 #include <istream>
+#include <span>
+#include <type_traits>
+
+#if defined(_MSC_VER)
+	#include <stdlib.h>
+#endif
 
 namespace chcl
 {
@@ -12,17 +21,132 @@ namespace chcl
 
 	namespace NetworkOrder
 	{
+		/**
+		 * @brief Endianness of the machine the library was compiled for
+		 */
+		constexpr Endianness Native = std::endian::native == std::endian::big ? Endianness::Big : Endianness::Little;
+
+		/**
+		 * @brief Checks whether data stored in the given endianness must be swapped to be read natively
+		 * Endianness::Default is treated as native
+		 */
+		constexpr bool NeedsSwap(Endianness endian)
+		{
+			return endian != Endianness::Default && endian != Native;
+		}
+
+		/**
+		 * @brief Reverses the byte order of an integer
+		 * Compiles to a single bswap/rev instruction on supported compilers
+		 * @param value Value to swap
+		 * @return Value with reversed byte order
+		 */
 		template <typename T> requires std::is_integral<T>::value
-		T reverse(T *value)
+		constexpr T byteswap(T value)
 		{
-			T result = 0;
+			using U = std::make_unsigned_t<T>;
+			U bits = static_cast<U>(value);
 
-			for (size_t i = 0; i < sizeof(T); ++i)
+			if constexpr (sizeof(T) == 1)
+				return value;
+			else if (std::is_constant_evaluated())
+			{
+				U result = 0;
+				for (size_t i = 0; i < sizeof(T); ++i)
+				{
+					result = (result << 8) | (bits & 0xff);
+					bits >>= 8;
+				}
+				return static_cast<T>(result);
+			}
+#if defined(_MSC_VER) && !defined(__clang__)
+			else if constexpr (sizeof(T) == 2)
+				return static_cast<T>(_byteswap_ushort(bits));
+			else if constexpr (sizeof(T) == 4)
+				return static_cast<T>(_byteswap_ulong(bits));
+			else if constexpr (sizeof(T) == 8)
+				return static_cast<T>(_byteswap_uint64(bits));
+#else
+			else if constexpr (sizeof(T) == 2)
+				return static_cast<T>(__builtin_bswap16(bits));
+			else if constexpr (sizeof(T) == 4)
+				return static_cast<T>(__builtin_bswap32(bits));
+			else if constexpr (sizeof(T) == 8)
+				return static_cast<T>(__builtin_bswap64(bits));
+#endif
+			else
 			{
-				std::memcpy(((uint8_t*)&result) + i, ((uint8_t*)value) + sizeof(T) - i - 1, 1);
+				T result;
+				const uint8_t *src = (const uint8_t*)&value;
+				uint8_t *dest = (uint8_t*)&result;
+				for (size_t i = 0; i < sizeof(T); ++i)
+					dest[i] = src[sizeof(T) - i - 1];
+				return result;
 			}
+		}
 
-			return result;
+		template <typename T> requires std::is_integral<T>::value
+		T reverse(T *value)
+		{
+			return byteswap(*value);
+		}
+
+		/**
+		 * @brief Converts a value stored in the given endianness to native order
+		 */
+		template <typename T> requires std::is_integral<T>::value
+		constexpr T convertFrom(Endianness endian, T value)
+		{
+			return NeedsSwap(endian) ? byteswap(value) : value;
+		}
+
+		/**
+		 * @brief Converts a native value to the given endianness
+		 */
+		template <typename T> requires std::is_integral<T>::value
+		constexpr T convertTo(Endianness endian, T value)
+		{
+			return convertFrom(endian, value);
+		}
+
+		// Bulk kernels, dispatched at runtime to SSSE3/AVX2 when the CPU supports them
+		void reverseArray16(uint16_t *values, size_t count);
+		void reverseArray32(uint32_t *values, size_t count);
+		void reverseArray64(uint64_t *values, size_t count);
+
+		/**
+		 * @brief Reverses the byte order of every element of an array in place
+		 * @param values Pointer to first element
+		 * @param count Number of elements
+		 */
+		template <typename T> requires std::is_integral<T>::value
+		void reverseArray(T *values, size_t count)
+		{
+			if constexpr (sizeof(T) == 2)
+				reverseArray16((uint16_t*)values, count);
+			else if constexpr (sizeof(T) == 4)
+				reverseArray32((uint32_t*)values, count);
+			else if constexpr (sizeof(T) == 8)
+				reverseArray64((uint64_t*)values, count);
+		}
+
+		/**
+		 * @brief Converts an array stored in the given endianness to native order, in place
+		 */
+		template <typename T> requires std::is_integral<T>::value
+		void convertFrom(Endianness endian, std::span<T> values)
+		{
+			if (NeedsSwap(endian))
+				reverseArray(values.data(), values.size());
+		}
+
+		/**
+		 * @brief Converts a native array to the given endianness, in place
+		 */
+		template <typename T> requires std::is_integral<T>::value
+		void convertTo(Endianness endian, std::span<T> values)
+		{
+			convertFrom(endian, values);
 		}
 	};
 }
\ No newline at end of file
@@ -0,0 +1,185 @@
+#include "Snapshot.h"
+
+#include <fstream>
+
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace
+{
+	constexpr size_t AlignUp(size_t value, size_t alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	void SwapHeader(chcl::Snapshot::Header &header)
+	{
+		using chcl::NetworkOrder::byteswap;
+		header.version = byteswap(header.version);
+		header.count = byteswap(header.count);
+		header.rows = byteswap(header.rows);
+		header.cols = byteswap(header.cols);
+		header.dataOffset = byteswap(header.dataOffset);
+	}
+}
+
+size_t chcl::Snapshot::DataTypeSize(DataType type)
+{
+	switch (type)
+	{
+		case DataType::Int8:
+		case DataType::UInt8:
+			return 1;
+		case DataType::Int16:
+		case DataType::UInt16:
+			return 2;
+		case DataType::Int32:
+		case DataType::UInt32:
+		case DataType::Float32:
+			return 4;
+		case DataType::Int64:
+		case DataType::UInt64:
+		case DataType::Float64:
+			return 8;
+		default:
+			return 0;
+	}
+}
+
+void chcl::Snapshot::Write(Buffer &out, DataType type, size_t count, size_t rows, size_t cols, const void *data)
+{
+	WriteHeader(out, type, count, rows, cols);
+	out.append(data, count * rows * cols * DataTypeSize(type));
+}
+
+void chcl::Snapshot::WriteHeader(Buffer &out, DataType type, size_t count, size_t rows, size_t cols)
+{
+	Header header = {};
+	std::memcpy(header.magic, Magic, sizeof(Magic));
+	header.version = Version;
+	header.dataType = type;
+	header.endian = uint8_t(NetworkOrder::Native);
+	header.count = count;
+	header.rows = rows;
+	header.cols = cols;
+	header.dataOffset = AlignUp(sizeof(Header), DataAlignment);
+
+	size_t begin = out.size();
+	size_t dataSize = count * rows * cols * DataTypeSize(type);
+	out.reserve(begin + header.dataOffset + dataSize);
+
+	const uint8_t padding[DataAlignment] = {};
+	out.append(header);
+	out.append(padding, header.dataOffset - sizeof(Header));
+}
+
+bool chcl::Snapshot::SaveToFile(const std::string &filename, const Buffer &snapshot)
+{
+	std::ofstream file{ filename, std::ios::binary };
+	file.write((const char*)snapshot.data(), snapshot.size());
+	return file.good();
+}
+
+chcl::Snapshot::View::View(const void *data, size_t size) :
+	m_data((const uint8_t*)data)
+{
+	if (!data || size < sizeof(Header))
+		return;
+
+	std::memcpy(&m_header, data, sizeof(Header));
+	if (std::memcmp(m_header.magic, Magic, sizeof(Magic)) != 0)
+		return;
+
+	if (m_header.endian != uint8_t(Endianness::Big) && m_header.endian != uint8_t(Endianness::Little))
+		return;
+	if (m_header.endian != uint8_t(NetworkOrder::Native))
+		SwapHeader(m_header);
+
+	// Versions start at 1, and anything newer than this build is unknown
+	if (m_header.version == 0 || m_header.version > Version)
+		return;
+
+	size_t typeSize = DataTypeSize(m_header.dataType);
+	if (typeSize == 0 || m_header.dataOffset < sizeof(Header) || m_header.dataOffset > size)
+		return;
+
+	// Shape must fit in the remaining data, checked without overflowing
+	uint64_t available = (size - m_header.dataOffset) / typeSize;
+	if (m_header.rows && m_header.cols && m_header.count)
+	{
+		if (m_header.rows > available || m_header.cols > available / m_header.rows)
+			return;
+		if (m_header.count > available / (m_header.rows * m_header.cols))
+			return;
+	}
+
+	m_valid = true;
+}
+
+#ifdef _WIN32
+chcl::Snapshot::MappedFile::MappedFile(const std::string &filename)
+{
+	HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return;
+
+	LARGE_INTEGER fileSize;
+	if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+	{
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping)
+		{
+			m_data = (const uint8_t*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			if (m_data)
+			{
+				m_size = (size_t)fileSize.QuadPart;
+				m_handle = mapping;
+			}
+			else
+				CloseHandle(mapping);
+		}
+	}
+	CloseHandle(file);
+}
+
+chcl::Snapshot::MappedFile::~MappedFile()
+{
+	if (m_data)
+		UnmapViewOfFile(m_data);
+	if (m_handle)
+		CloseHandle((HANDLE)m_handle);
+}
+#else
+chcl::Snapshot::MappedFile::MappedFile(const std::string &filename)
+{
+	int file = ::open(filename.c_str(), O_RDONLY);
+	if (file < 0)
+		return;
+
+	struct stat fileInfo;
+	if (::fstat(file, &fileInfo) == 0 && fileInfo.st_size > 0)
+	{
+		void *mapping = ::mmap(nullptr, (size_t)fileInfo.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+		if (mapping != MAP_FAILED)
+		{
+			m_data = (const uint8_t*)mapping;
+			m_size = (size_t)fileInfo.st_size;
+		}
+	}
+	::close(file);
+}
+
+chcl::Snapshot::MappedFile::~MappedFile()
+{
+	if (m_data)
+		::munmap((void*)m_data, m_size);
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,207 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <type_traits>
+
+#include "Buffer.h"
+#include "NetworkOrder.h"
+
+namespace chcl
+{
+	/**
+	 * @brief Versioned binary container for arrays of numeric values.
+	 *
+	 * A snapshot is a fixed header describing the element type, endianness and shape (count x rows x cols),
+	 * followed by the raw elements at an aligned offset. Snapshots written on a machine of the same endianness
+	 * can be viewed in place (e.g. from a memory mapped file) without touching the elements.
+	 * See Snapshot_Integration.h for Matrix, DynamicMatrix and VectorN support.
+	 */
+	namespace Snapshot
+	{
+		constexpr char Magic[4] = { 'C', 'H', 'S', 'N' };
+		constexpr uint16_t Version = 1;
+		/// @brief Alignment of element data from the start of the snapshot
+		constexpr size_t DataAlignment = 64;
+
+		enum class DataType : uint8_t
+		{
+			Unknown,
+			Int8, UInt8,
+			Int16, UInt16,
+			Int32, UInt32,
+			Int64, UInt64,
+			Float32, Float64
+		};
+
+		template <typename T>
+		constexpr DataType DataTypeOf()
+		{
+			if constexpr (std::is_same_v<T, float> && sizeof(float) == 4) return DataType::Float32;
+			else if constexpr (std::is_same_v<T, double> && sizeof(double) == 8) return DataType::Float64;
+			else if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool>)
+			{
+				constexpr bool isSigned = std::is_signed_v<T>;
+				switch (sizeof(T))
+				{
+					case 1: return isSigned ? DataType::Int8 : DataType::UInt8;
+					case 2: return isSigned ? DataType::Int16 : DataType::UInt16;
+					case 4: return isSigned ? DataType::Int32 : DataType::UInt32;
+					case 8: return isSigned ? DataType::Int64 : DataType::UInt64;
+				}
+			}
+			return DataType::Unknown;
+		}
+
+		size_t DataTypeSize(DataType type);
+
+		/// @brief Stored as is, so every byte is spelled out and the layout is the same on every compiler
+		struct Header
+		{
+			char magic[4];
+			uint16_t version; ///< Starts at 1
+			DataType dataType;
+			uint8_t endian; ///< Endianness of the header fields and elements
+			uint8_t reserved[8]; ///< Written as zero
+			uint64_t count; ///< Number of items (vectors/matrices) stored
+			uint64_t rows; ///< Rows per item
+			uint64_t cols; ///< Columns per item
+			uint64_t dataOffset; ///< Offset of the first element from the start of the snapshot
+		};
+
+		static_assert(sizeof(DataType) == 1);
+		static_assert(sizeof(Header) == 48);
+		static_assert(offsetof(Header, version) == 4 && offsetof(Header, dataType) == 6 && offsetof(Header, endian) == 7);
+		static_assert(offsetof(Header, reserved) == 8 && offsetof(Header, count) == 16 && offsetof(Header, rows) == 24);
+		static_assert(offsetof(Header, cols) == 32 && offsetof(Header, dataOffset) == 40);
+
+		/**
+		 * @brief Appends a snapshot of raw element data to a buffer
+		 * @param out Buffer to append to. Should be empty so that element data stays aligned
+		 * @param type Element type
+		 * @param count Number of items
+		 * @param rows Rows per item
+		 * @param cols Columns per item
+		 * @param data Pointer to count * rows * cols contiguous elements
+		 */
+		void Write(Buffer &out, DataType type, size_t count, size_t rows, size_t cols, const void *data);
+
+		/**
+		 * @brief Appends only the header of a snapshot, for element data that is appended separately
+		 * Reserves room for the elements, which must then be appended in full, count * rows * cols of them
+		 */
+		void WriteHeader(Buffer &out, DataType type, size_t count, size_t rows, size_t cols);
+
+		template <typename T>
+		void Write(Buffer &out, const T *values, size_t count, size_t rows, size_t cols)
+		{
+			static_assert(DataTypeOf<T>() != DataType::Unknown, "Snapshots only store integer and floating point elements");
+			Write(out, DataTypeOf<T>(), count, rows, cols, values);
+		}
+
+		/**
+		 * @brief Writes a snapshot buffer to a file
+		 * @return Whether the whole snapshot was written
+		 */
+		bool SaveToFile(const std::string &filename, const Buffer &snapshot);
+
+		/**
+		 * @brief Read-only memory mapping of a whole file.
+		 */
+		class MappedFile
+		{
+		private:
+			const uint8_t *m_data = nullptr;
+			size_t m_size = 0;
+			void *m_handle = nullptr; ///< Platform mapping handle, if any
+
+		public:
+			MappedFile(const std::string &filename);
+			MappedFile(const MappedFile&) = delete;
+			MappedFile& operator=(const MappedFile&) = delete;
+			~MappedFile();
+
+			inline const void* data() const { return m_data; }
+			inline size_t size() const { return m_size; }
+
+			inline explicit operator bool() const { return m_data != nullptr; }
+		};
+
+		/**
+		 * @brief Validated view of a snapshot in memory. Does not own or copy the data.
+		 */
+		class View
+		{
+		private:
+			const uint8_t *m_data = nullptr;
+			Header m_header = {};
+			bool m_valid = false;
+
+		public:
+			View(const void *data, size_t size);
+			View(const Buffer &buffer) : View(buffer.data(), buffer.size()) {}
+			View(const MappedFile &file) : View(file.data(), file.size()) {}
+
+			inline const Header& header() const { return m_header; }
+			inline size_t count() const { return m_header.count; }
+			inline size_t rows() const { return m_header.rows; }
+			inline size_t cols() const { return m_header.cols; }
+			inline size_t elementCount() const { return m_header.count * m_header.rows * m_header.cols; }
+			inline DataType dataType() const { return m_header.dataType; }
+			/// @brief Whether the elements can be used in place on this machine
+			inline bool isNative() const { return m_header.endian == uint8_t(NetworkOrder::Native); }
+
+			inline const void* rawData() const { return m_data + m_header.dataOffset; }
+
+			inline explicit operator bool() const { return m_valid; }
+
+			/**
+			 * @brief Gets the elements in place, without any copying or conversion
+			 * @return Span over all elements, empty if the snapshot is invalid, stores another type or is not native
+			 */
+			template <typename T>
+			std::span<const T> values() const
+			{
+				if (!m_valid || DataTypeOf<T>() != m_header.dataType || !isNative())
+					return {};
+				if ((uintptr_t)rawData() % alignof(T) != 0)
+					return {};
+				return std::span<const T>((const T*)rawData(), elementCount());
+			}
+
+			/**
+			 * @brief Copies elements out of the snapshot, converting them to native order if needed
+			 * @param dest Array of at least count elements
+			 * @param first Index of the first element to copy
+			 * @param count Number of elements to copy. Copies up to the last element by default
+			 * @return Whether the snapshot stores elements of type T and the range was valid
+			 */
+			template <typename T>
+			bool copyValues(T *dest, size_t first = 0, size_t count = ~size_t(0)) const
+			{
+				if (!m_valid || DataTypeOf<T>() != m_header.dataType || first > elementCount())
+					return false;
+
+				if (count > elementCount() - first)
+				{
+					if (count != ~size_t(0))
+						return false;
+					count = elementCount() - first;
+				}
+
+				std::memcpy(dest, (const T*)rawData() + first, count * sizeof(T));
+				if (!isNative())
+				{
+					using BitsType = std::conditional_t<sizeof(T) == 1, uint8_t,
+						std::conditional_t<sizeof(T) == 2, uint16_t,
+						std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>>>;
+					NetworkOrder::reverseArray((BitsType*)dest, count);
+				}
+				return true;
+			}
+		};
+	}
+}
\ No newline at end of file
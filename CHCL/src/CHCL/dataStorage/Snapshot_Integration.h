@@ -0,0 +1,162 @@
+#pragma once
+
+#include <span>
+#include <type_traits>
+
+#include "chcl/dataStorage/Snapshot.h"
+
+#include "chcl/geometry/VectorN.h"
+#include "chcl/geometry/DynamicVector.h"
+
+#include "chcl/maths/Matrix.h"
+#include "chcl/maths/DynamicMatrix.h"
+
+namespace chcl
+{
+	namespace Snapshot
+	{
+		/**
+		 * @brief Checks that an item type is exactly its elements with no padding, so arrays of it can be viewed in place
+		 */
+		template <typename Item, typename T, size_t elements>
+		constexpr bool IsPackedItem = std::is_standard_layout_v<Item> && sizeof(Item) == sizeof(T) * elements;
+
+		template <size_t rows, size_t cols, typename T>
+		void Write(Buffer &out, std::span<const Matrix<rows, cols, T>> mats)
+		{
+			static_assert(IsPackedItem<Matrix<rows, cols, T>, T, rows * cols>, "Matrix must be tightly packed to snapshot");
+			Write(out, (const T*)mats.data(), mats.size(), rows, cols);
+		}
+
+		template <size_t rows, size_t cols, typename T>
+		void Write(Buffer &out, const Matrix<rows, cols, T> &mat)
+		{
+			Write(out, mat.data(), 1, rows, cols);
+		}
+
+		template <size_t dims, typename T>
+		void Write(Buffer &out, std::span<const VectorN<dims, T>> vecs)
+		{
+			static_assert(IsPackedItem<VectorN<dims, T>, T, dims>, "Vector must be tightly packed to snapshot");
+			Write(out, (const T*)vecs.data(), vecs.size(), dims, 1);
+		}
+
+		template <size_t dims, typename T>
+		void Write(Buffer &out, const VectorN<dims, T> &vec)
+		{
+			Write(out, vec.data(), 1, dims, 1);
+		}
+
+		template <typename T>
+		void Write(Buffer &out, const DynamicMatrix<T> &mat)
+		{
+			Write(out, mat.data(), 1, mat.rows(), mat.cols());
+		}
+
+		template <typename T>
+		void Write(Buffer &out, const DynamicVector<T> &vec)
+		{
+			Write(out, vec.data(), 1, vec.size(), 1);
+		}
+
+		/**
+		 * @brief Stores an array of equally sized dynamic matrices contiguously
+		 * @return Whether all matrices had the same shape. Nothing is written if not
+		 */
+		template <typename T>
+		bool Write(Buffer &out, std::span<const DynamicMatrix<T>> mats)
+		{
+			size_t rows = mats.empty() ? 0 : mats[0].rows();
+			size_t cols = mats.empty() ? 0 : mats[0].cols();
+			for (const DynamicMatrix<T> &mat : mats)
+				if (mat.rows() != rows || mat.cols() != cols)
+					return false;
+
+			static_assert(DataTypeOf<T>() != DataType::Unknown, "Snapshots only store integer and floating point elements");
+			WriteHeader(out, DataTypeOf<T>(), mats.size(), rows, cols);
+			for (const DynamicMatrix<T> &mat : mats)
+				out.append(mat.data(), mat.count() * sizeof(T));
+			return true;
+		}
+
+		/**
+		 * @brief Views the matrices stored in a snapshot in place
+		 * @return Span of matrices, empty if the snapshot does not store native rows x cols matrices of T
+		 */
+		template <size_t rows, size_t cols, typename T>
+		std::span<const Matrix<rows, cols, T>> ViewMatrices(const View &view)
+		{
+			static_assert(IsPackedItem<Matrix<rows, cols, T>, T, rows * cols>, "Matrix must be tightly packed to view in place");
+			if (view.rows() != rows || view.cols() != cols)
+				return {};
+
+			std::span<const T> values = view.values<T>();
+			return std::span<const Matrix<rows, cols, T>>((const Matrix<rows, cols, T>*)values.data(), values.empty() ? 0 : view.count());
+		}
+
+		/**
+		 * @brief Views the vectors stored in a snapshot in place
+		 * @return Span of vectors, empty if the snapshot does not store native vectors of T with dims components
+		 */
+		template <size_t dims, typename T>
+		std::span<const VectorN<dims, T>> ViewVectors(const View &view)
+		{
+			static_assert(IsPackedItem<VectorN<dims, T>, T, dims>, "Vector must be tightly packed to view in place");
+			if (view.rows() != dims || view.cols() != 1)
+				return {};
+
+			std::span<const T> values = view.values<T>();
+			return std::span<const VectorN<dims, T>>((const VectorN<dims, T>*)values.data(), values.empty() ? 0 : view.count());
+		}
+
+		/**
+		 * @brief Copies one matrix out of a snapshot, converting endianness if needed
+		 * @return Whether the snapshot held a matrix of the right shape and type at that index
+		 */
+		template <size_t rows, size_t cols, typename T>
+		bool Read(const View &view, Matrix<rows, cols, T> &mat, size_t index = 0)
+		{
+			if (view.rows() != rows || view.cols() != cols || index >= view.count())
+				return false;
+
+			return view.copyValues(mat.data(), index * rows * cols, rows * cols);
+		}
+
+		template <size_t dims, typename T>
+		bool Read(const View &view, VectorN<dims, T> &vec, size_t index = 0)
+		{
+			if (view.rows() != dims || view.cols() != 1 || index >= view.count())
+				return false;
+
+			return view.copyValues(vec.data(), index * dims, dims);
+		}
+
+		template <typename T>
+		bool Read(const View &view, DynamicMatrix<T> &mat, size_t index = 0)
+		{
+			if (index >= view.count())
+				return false;
+
+			DynamicMatrix<T> result(view.rows(), view.cols());
+			if (!view.copyValues(result.data(), index * result.count(), result.count()))
+				return false;
+
+			mat = std::move(result);
+			return true;
+		}
+
+		template <typename T>
+		bool Read(const View &view, DynamicVector<T> &vec, size_t index = 0)
+		{
+			if (view.cols() != 1 || index >= view.count())
+				return false;
+
+			DynamicVector<T> result(view.rows());
+			if (!view.copyValues(result.data(), index * result.size(), result.size()))
+				return false;
+
+			vec = std::move(result);
+			return true;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,502 @@
+#include "AsyncFileReader.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#else
+	#include <cerrno>
+	#include <fcntl.h>
+	#include <sys/stat.h>
+	#include <sys/uio.h>
+	#include <unistd.h>
+#endif
+
+#ifdef __linux__
+	#include <linux/io_uring.h>
+	#include <sys/mman.h>
+	#include <sys/syscall.h>
+#endif
+
+namespace
+{
+#ifdef _WIN32
+	using NativeFile = HANDLE;
+	const NativeFile InvalidFile = INVALID_HANDLE_VALUE;
+
+	NativeFile OpenFile(const std::string &filename)
+	{
+		return CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	}
+
+	void CloseFile(NativeFile file) { CloseHandle(file); }
+
+	size_t FileSize(NativeFile file)
+	{
+		LARGE_INTEGER size;
+		return GetFileSizeEx(file, &size) ? (size_t)size.QuadPart : 0;
+	}
+
+	long long ReadAt(NativeFile file, void *dest, size_t size, size_t offset)
+	{
+		OVERLAPPED position = {};
+		position.Offset = (DWORD)offset;
+		position.OffsetHigh = (DWORD)((unsigned long long)offset >> 32);
+
+		DWORD bytesRead = 0;
+		if (!ReadFile(file, dest, (DWORD)std::min<size_t>(size, 1 << 30), &bytesRead, &position))
+			return GetLastError() == ERROR_HANDLE_EOF ? 0 : -1;
+		return bytesRead;
+	}
+#else
+	using NativeFile = int;
+	const NativeFile InvalidFile = -1;
+
+	NativeFile OpenFile(const std::string &filename) { return ::open(filename.c_str(), O_RDONLY); }
+
+	void CloseFile(NativeFile file) { ::close(file); }
+
+	size_t FileSize(NativeFile file)
+	{
+		struct stat info;
+		return ::fstat(file, &info) == 0 ? (size_t)info.st_size : 0;
+	}
+
+	long long ReadAt(NativeFile file, void *dest, size_t size, size_t offset)
+	{
+		long long result;
+		do
+			result = ::pread(file, dest, size, (off_t)offset);
+		while (result < 0 && errno == EINTR);
+		return result;
+	}
+#endif
+}
+
+/**
+ * @brief Shared state for the read backends.
+ * Chunk i is always read into slot i % inFlight, and a slot is only reused once its chunk has been consumed.
+ */
+class chcl::AsyncFileReader::Backend
+{
+public:
+	struct Slot
+	{
+		Buffer buffer;
+		size_t bytes = 0;
+		bool ready = false;
+#ifndef _WIN32
+		iovec target = {}; ///< Remaining destination of an outstanding io_uring read
+#endif
+	};
+
+	Backend(NativeFile file, size_t chunkSize, size_t inFlight) :
+		m_file(file),
+		m_fileSize(FileSize(file)),
+		m_chunkSize(chunkSize),
+		m_inFlight(inFlight),
+		m_slots(inFlight)
+	{
+		m_chunkCount = (m_fileSize + m_chunkSize - 1) / m_chunkSize;
+	}
+
+	virtual ~Backend()
+	{
+		CloseFile(m_file);
+	}
+
+	virtual bool next(Chunk &chunk) = 0;
+	virtual bool usingIoUring() const { return false; }
+
+	inline size_t fileSize() const { return m_fileSize; }
+	inline bool failed() const { return m_failed; }
+
+protected:
+	NativeFile m_file;
+	size_t m_fileSize, m_chunkSize, m_inFlight, m_chunkCount;
+	std::vector<Slot> m_slots;
+	std::atomic<bool> m_failed = false;
+
+	size_t m_nextIssue = 0; ///< Next chunk to start reading
+	size_t m_nextConsume = 0; ///< Next chunk to deliver
+
+	inline Slot& slotFor(size_t chunkIndex) { return m_slots[chunkIndex % m_inFlight]; }
+	inline size_t expectedSize(size_t chunkIndex) const { return std::min(m_chunkSize, m_fileSize - chunkIndex * m_chunkSize); }
+
+	void prepareSlot(Slot &slot)
+	{
+		slot.buffer.setSize(0);
+		slot.buffer.reserve(m_chunkSize);
+		slot.bytes = 0;
+		slot.ready = false;
+	}
+
+	/// @brief Hands a completed slot's buffer to the consumer, taking the consumer's old buffer in exchange
+	void deliver(Slot &slot, Chunk &chunk)
+	{
+		std::swap(chunk.data, slot.buffer);
+		chunk.data.setSize(slot.bytes);
+		chunk.offset = m_nextConsume * m_chunkSize;
+		slot.ready = false;
+		++m_nextConsume;
+	}
+};
+
+namespace
+{
+	/**
+	 * @brief Issues positional reads from a small pool of threads.
+	 */
+	class ThreadPoolBackend : public chcl::AsyncFileReader::Backend
+	{
+	private:
+		std::mutex m_mutex;
+		std::condition_variable m_workAvailable, m_chunkReady;
+		std::vector<std::thread> m_workers;
+		bool m_stopping = false;
+
+	public:
+		ThreadPoolBackend(NativeFile file, size_t chunkSize, size_t inFlight) :
+			Backend(file, chunkSize, inFlight)
+		{
+			size_t workerCount = std::clamp<size_t>(std::thread::hardware_concurrency(), 1, std::min<size_t>(inFlight, 4));
+			for (size_t i = 0; i < workerCount; ++i)
+				m_workers.emplace_back(&ThreadPoolBackend::work, this);
+		}
+
+		~ThreadPoolBackend()
+		{
+			{
+				std::lock_guard lock(m_mutex);
+				m_stopping = true;
+			}
+			m_workAvailable.notify_all();
+			for (std::thread &worker : m_workers)
+				worker.join();
+		}
+
+		bool next(chcl::AsyncFileReader::Chunk &chunk) override
+		{
+			std::unique_lock lock(m_mutex);
+			if (m_nextConsume >= m_chunkCount)
+				return false;
+
+			Slot &slot = slotFor(m_nextConsume);
+			m_chunkReady.wait(lock, [&]() { return slot.ready || m_failed; });
+			if (m_failed)
+				return false;
+
+			deliver(slot, chunk);
+			lock.unlock();
+			m_workAvailable.notify_all();
+			return true;
+		}
+
+	private:
+		void work()
+		{
+			std::unique_lock lock(m_mutex);
+			while (true)
+			{
+				m_workAvailable.wait(lock, [this]()
+					{
+						return m_stopping || m_failed || m_nextIssue >= m_chunkCount || m_nextIssue < m_nextConsume + m_inFlight;
+					});
+				if (m_stopping || m_failed || m_nextIssue >= m_chunkCount)
+					return;
+
+				size_t chunkIndex = m_nextIssue++;
+				Slot &slot = slotFor(chunkIndex);
+				prepareSlot(slot);
+				lock.unlock();
+
+				size_t expected = expectedSize(chunkIndex);
+				uint8_t *dest = (uint8_t*)slot.buffer.data();
+				size_t bytes = 0;
+				while (bytes < expected)
+				{
+					long long result = ReadAt(m_file, dest + bytes, expected - bytes, chunkIndex * m_chunkSize + bytes);
+					if (result <= 0)
+						break;
+					bytes += (size_t)result;
+				}
+
+				lock.lock();
+				slot.bytes = bytes;
+				slot.ready = true;
+				if (bytes < expected)
+					m_failed = true;
+				m_chunkReady.notify_all();
+			}
+		}
+	};
+
+#ifdef __linux__
+	/**
+	 * @brief Issues reads through an io_uring instance, driven entirely from the consumer's thread.
+	 * Uses the raw system calls so there is no dependency on liburing.
+	 */
+	class IoUringBackend : public chcl::AsyncFileReader::Backend
+	{
+	private:
+		int m_ring = -1;
+		void *m_sqRing = nullptr, *m_cqRing = nullptr;
+		size_t m_sqRingSize = 0, m_cqRingSize = 0, m_sqesSize = 0;
+		io_uring_sqe *m_sqes = nullptr;
+		io_uring_cqe *m_cqes = nullptr;
+		unsigned *m_sqTail = nullptr, *m_sqMask = nullptr, *m_sqArray = nullptr;
+		unsigned *m_cqHead = nullptr, *m_cqTail = nullptr, *m_cqMask = nullptr;
+		size_t m_outstanding = 0;
+
+	public:
+		IoUringBackend(NativeFile file, size_t chunkSize, size_t inFlight) :
+			Backend(file, chunkSize, inFlight)
+		{}
+
+		~IoUringBackend()
+		{
+			// Outstanding reads still target the slot buffers, so they must finish first
+			while (m_outstanding > 0 && waitForCompletion())
+				reap();
+
+			if (m_sqes)
+				::munmap(m_sqes, m_sqesSize);
+			if (m_cqRing && m_cqRing != m_sqRing)
+				::munmap(m_cqRing, m_cqRingSize);
+			if (m_sqRing)
+				::munmap(m_sqRing, m_sqRingSize);
+			if (m_ring >= 0)
+				::close(m_ring);
+		}
+
+		/**
+		 * @brief Sets up the ring
+		 * @return False if io_uring is unsupported or blocked, in which case the thread pool should be used
+		 */
+		bool init()
+		{
+			io_uring_params params = {};
+			m_ring = (int)::syscall(__NR_io_uring_setup, (unsigned)m_inFlight, &params);
+			if (m_ring < 0)
+				return false;
+
+			m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+			m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+			bool singleMap = params.features & IORING_FEAT_SINGLE_MMAP;
+			if (singleMap)
+				m_sqRingSize = m_cqRingSize = std::max(m_sqRingSize, m_cqRingSize);
+
+			m_sqRing = ::mmap(nullptr, m_sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring, IORING_OFF_SQ_RING);
+			if (m_sqRing == MAP_FAILED)
+			{
+				m_sqRing = nullptr;
+				return false;
+			}
+
+			m_cqRing = singleMap ? m_sqRing : ::mmap(nullptr, m_cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring, IORING_OFF_CQ_RING);
+			if (m_cqRing == MAP_FAILED)
+			{
+				m_cqRing = nullptr;
+				return false;
+			}
+
+			m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+			void *sqes = ::mmap(nullptr, m_sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring, IORING_OFF_SQES);
+			if (sqes == MAP_FAILED)
+				return false;
+			m_sqes = (io_uring_sqe*)sqes;
+
+			uint8_t *sq = (uint8_t*)m_sqRing, *cq = (uint8_t*)m_cqRing;
+			m_sqTail = (unsigned*)(sq + params.sq_off.tail);
+			m_sqMask = (unsigned*)(sq + params.sq_off.ring_mask);
+			m_sqArray = (unsigned*)(sq + params.sq_off.array);
+			m_cqHead = (unsigned*)(cq + params.cq_off.head);
+			m_cqTail = (unsigned*)(cq + params.cq_off.tail);
+			m_cqMask = (unsigned*)(cq + params.cq_off.ring_mask);
+			m_cqes = (io_uring_cqe*)(cq + params.cq_off.cqes);
+
+			return true;
+		}
+
+		bool usingIoUring() const override { return true; }
+
+		bool next(chcl::AsyncFileReader::Chunk &chunk) override
+		{
+			if (m_nextConsume >= m_chunkCount || m_failed)
+				return false;
+
+			// Keep the ring topped up before waiting, so reads overlap with the consumer
+			while (m_nextIssue < m_chunkCount && m_nextIssue < m_nextConsume + m_inFlight)
+			{
+				Slot &slot = slotFor(m_nextIssue);
+				prepareSlot(slot);
+				if (!submit(m_nextIssue))
+				{
+					m_failed = true;
+					return false;
+				}
+				++m_nextIssue;
+			}
+
+			Slot &slot = slotFor(m_nextConsume);
+			while (!slot.ready && !m_failed)
+			{
+				reap();
+				if (!slot.ready && !m_failed && !waitForCompletion())
+					m_failed = true;
+			}
+			if (m_failed)
+				return false;
+
+			deliver(slot, chunk);
+			return true;
+		}
+
+	private:
+		bool submit(size_t chunkIndex)
+		{
+			Slot &slot = slotFor(chunkIndex);
+			slot.target.iov_base = (uint8_t*)slot.buffer.data() + slot.bytes;
+			slot.target.iov_len = expectedSize(chunkIndex) - slot.bytes;
+
+			// Only this thread writes the tail, so a relaxed read of it is enough
+			unsigned tail = *m_sqTail;
+			unsigned index = tail & *m_sqMask;
+			io_uring_sqe &sqe = m_sqes[index];
+			sqe = {};
+			sqe.opcode = IORING_OP_READV;
+			sqe.fd = m_file;
+			sqe.off = chunkIndex * m_chunkSize + slot.bytes;
+			sqe.addr = (unsigned long long)&slot.target;
+			sqe.len = 1;
+			sqe.user_data = chunkIndex;
+			m_sqArray[index] = index;
+			std::atomic_ref<unsigned>(*m_sqTail).store(tail + 1, std::memory_order_release);
+
+			long result;
+			do
+				result = ::syscall(__NR_io_uring_enter, m_ring, 1u, 0u, 0u, nullptr, 0);
+			while (result < 0 && errno == EINTR);
+
+			if (result < 0)
+				return false;
+
+			++m_outstanding;
+			return true;
+		}
+
+		bool waitForCompletion()
+		{
+			long result;
+			do
+				result = ::syscall(__NR_io_uring_enter, m_ring, 0u, 1u, (unsigned)IORING_ENTER_GETEVENTS, nullptr, 0);
+			while (result < 0 && errno == EINTR);
+			return result >= 0;
+		}
+
+		void reap()
+		{
+			unsigned head = *m_cqHead;
+			unsigned tail = std::atomic_ref<unsigned>(*m_cqTail).load(std::memory_order_acquire);
+
+			for (; head != tail; ++head)
+			{
+				const io_uring_cqe &cqe = m_cqes[head & *m_cqMask];
+				size_t chunkIndex = (size_t)cqe.user_data;
+				Slot &slot = slotFor(chunkIndex);
+				--m_outstanding;
+
+				if (cqe.res == -EINTR || cqe.res == -EAGAIN)
+				{
+					if (!submit(chunkIndex))
+						m_failed = true;
+					continue;
+				}
+
+				if (cqe.res <= 0)
+				{
+					// Errors, or the file shrinking underneath us
+					m_failed = true;
+					continue;
+				}
+
+				slot.bytes += (size_t)cqe.res;
+				if (slot.bytes < expectedSize(chunkIndex))
+				{
+					if (!submit(chunkIndex))
+						m_failed = true;
+				}
+				else
+					slot.ready = true;
+			}
+
+			std::atomic_ref<unsigned>(*m_cqHead).store(head, std::memory_order_release);
+		}
+	};
+#endif
+}
+
+chcl::AsyncFileReader::AsyncFileReader(const std::string &filename, size_t chunkSize, size_t chunksInFlight, [[maybe_unused]] bool allowIoUring)
+{
+	NativeFile file = OpenFile(filename);
+	if (file == InvalidFile)
+		return;
+
+	chunkSize = std::max<size_t>(chunkSize, 1);
+	chunksInFlight = std::max<size_t>(chunksInFlight, 1);
+
+#ifdef __linux__
+	if (allowIoUring)
+	{
+		auto ring = std::make_unique<IoUringBackend>(file, chunkSize, chunksInFlight);
+		if (ring->init())
+		{
+			m_backend = std::move(ring);
+			return;
+		}
+
+		// The ring backend owns the file, so reopen it for the fallback
+		ring.reset();
+		file = OpenFile(filename);
+		if (file == InvalidFile)
+			return;
+	}
+#endif
+
+	m_backend = std::make_unique<ThreadPoolBackend>(file, chunkSize, chunksInFlight);
+}
+
+chcl::AsyncFileReader::~AsyncFileReader() = default;
+
+bool chcl::AsyncFileReader::next(Chunk &chunk)
+{
+	return m_backend && m_backend->next(chunk);
+}
+
+size_t chcl::AsyncFileReader::fileSize() const
+{
+	return m_backend ? m_backend->fileSize() : 0;
+}
+
+bool chcl::AsyncFileReader::failed() const
+{
+	return !m_backend || m_backend->failed();
+}
+
+bool chcl::AsyncFileReader::usingIoUring() const
+{
+	return m_backend && m_backend->usingIoUring();
+}
+
+chcl::AsyncFileReader::operator bool() const
+{
+	return m_backend != nullptr;
+}
\ No newline at end of file
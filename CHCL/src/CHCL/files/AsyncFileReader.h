@@ -0,0 +1,77 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "CHCL/dataStorage/Buffer.h"
+
+namespace chcl
+{
+	/**
+	 * @brief Reads a file ahead of its consumer, keeping several chunks in flight at once.
+	 *
+	 * Chunks are delivered strictly in file order, so the consumer can decompress or parse
+	 * one chunk while the following ones are still being read.
+	 * On Linux reads are issued through io_uring, elsewhere (or if io_uring is unavailable)
+	 * a small pool of threads issues positional reads.
+	 */
+	class AsyncFileReader
+	{
+	public:
+		static constexpr size_t DefaultChunkSize = 1024 * 1024;
+		static constexpr size_t DefaultChunksInFlight = 4;
+
+		struct Chunk
+		{
+			size_t offset = 0; ///< Position of the chunk within the file
+			Buffer data; ///< Chunk contents. Its storage is recycled when passed back to next()
+		};
+
+		/**
+		 * @brief Opens a file and starts reading it
+		 * @param filename File to read
+		 * @param chunkSize Size of each read, in bytes
+		 * @param chunksInFlight Maximum number of chunks being read or waiting for the consumer
+		 * @param allowIoUring Whether io_uring may be used. If false, the thread pool always issues the reads
+		 */
+		AsyncFileReader(const std::string &filename, size_t chunkSize = DefaultChunkSize, size_t chunksInFlight = DefaultChunksInFlight,
+			bool allowIoUring = true);
+		AsyncFileReader(const AsyncFileReader&) = delete;
+		AsyncFileReader& operator=(const AsyncFileReader&) = delete;
+		~AsyncFileReader();
+
+		/**
+		 * @brief Waits for the next chunk in file order
+		 * The previous contents of chunk are reused as a read buffer, so no allocation happens in steady state
+		 * @param chunk Chunk to fill
+		 * @return False once the whole file has been delivered, or if a read failed
+		 */
+		bool next(Chunk &chunk);
+
+		/**
+		 * @brief Passes every chunk, in order, to a consumer on the calling thread
+		 * @param consumer Callable taking a const Chunk&
+		 * @return Whether the whole file was read without errors
+		 */
+		template <typename Consumer>
+		bool readAll(Consumer &&consumer)
+		{
+			Chunk chunk;
+			while (next(chunk))
+				consumer(static_cast<const Chunk&>(chunk));
+			return !failed();
+		}
+
+		size_t fileSize() const;
+		bool failed() const;
+		/// @brief Whether reads are issued through io_uring rather than the thread pool
+		bool usingIoUring() const;
+
+		explicit operator bool() const;
+
+		class Backend;
+
+	private:
+		std::unique_ptr<Backend> m_backend;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+#include "CPUFeatures.h"
+
+#if defined(CHCL_X86) && defined(_MSC_VER)
+	#include <intrin.h>
+#endif
+
+bool chcl::CPUFeatures::DetectSSSE3()
+{
+#ifdef CHCL_X86
+	#ifdef _MSC_VER
+		int registers[4];
+		__cpuid(registers, 1);
+		return registers[2] & (1 << 9);
+	#else
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("ssse3");
+	#endif
+#else
+	return false;
+#endif
+}
+
+bool chcl::CPUFeatures::DetectAVX2()
+{
+#ifdef CHCL_X86
+	#ifdef _MSC_VER
+		int registers[4];
+		__cpuid(registers, 0);
+		const int maxLeaf = registers[0];
+		__cpuid(registers, 1);
+		// AVX registers must also be enabled by the OS, which XGETBV reports
+		const bool avx = (registers[2] & (1 << 27)) && (registers[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+		if (!avx || maxLeaf < 7)
+			return false;
+
+		__cpuidex(registers, 7, 0);
+		return registers[1] & (1 << 5);
+	#else
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2");
+	#endif
+#else
+	return false;
+#endif
+}
\ No newline at end of file
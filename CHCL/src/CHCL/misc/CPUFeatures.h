@@ -0,0 +1,39 @@
+#pragma once
+
+// Kernels for newer instruction sets are compiled for their own target and picked at runtime,
+// so they are used without building the whole library for a newer CPU
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	#define CHCL_X86
+	#include <immintrin.h>
+	#ifdef _MSC_VER
+		#define CHCL_TARGET(isa)
+	#else
+		#define CHCL_TARGET(isa) __attribute__((target(isa)))
+	#endif
+#endif
+
+namespace chcl
+{
+	/**
+	 * @brief Instruction sets supported by the CPU the program is running on.
+	 * Functions marked CHCL_TARGET may only be called once the matching check has passed.
+	 */
+	namespace CPUFeatures
+	{
+		bool DetectSSSE3();
+		/// @brief Checks for AVX2, and that the OS saves the AVX registers
+		bool DetectAVX2();
+
+		inline bool HasSSSE3()
+		{
+			static const bool ssse3 = DetectSSSE3();
+			return ssse3;
+		}
+
+		inline bool HasAVX2()
+		{
+			static const bool avx2 = DetectAVX2();
+			return avx2;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,184 @@
+#include "Logger.h"
+
+#include <algorithm>
+#include <bit>
+#include <utility>
+
+namespace
+{
+	/// @brief Size a batch may grow to before it is written out, even if more messages are queued
+	constexpr size_t BatchSize = 256 * 1024;
+	constexpr size_t MinimumQueueSize = 4096;
+
+	/**
+	 * @brief Queues the current thread writes to, one for each logger it has logged to.
+	 * They are closed when the thread exits, so the background threads can release them once empty.
+	 */
+	struct ThreadQueues
+	{
+		std::vector<std::pair<uint64_t, std::shared_ptr<chcl::LoggerDetail::ThreadQueue>>> queues;
+
+		~ThreadQueues()
+		{
+			for (auto &[loggerID, queue] : queues)
+				queue->close();
+		}
+	};
+
+	thread_local ThreadQueues t_threadQueues;
+}
+
+chcl::LoggerDetail::ThreadQueue::ThreadQueue(size_t capacity) :
+	m_data(new std::byte[capacity]),
+	m_mask(capacity - 1)
+{}
+
+chcl::Logger::Logger(const std::string &filename, OverflowPolicy policy, size_t queueSize, std::chrono::milliseconds flushInterval) :
+	m_file(filename, std::ios::binary | std::ios::app),
+	m_policy(policy),
+	m_queueSize(std::bit_ceil(std::clamp<size_t>(queueSize, MinimumQueueSize, size_t(1) << 31))),
+	m_flushInterval(flushInterval),
+	m_id(s_nextID.fetch_add(1, std::memory_order_relaxed))
+{
+	m_thread = std::thread(&Logger::run, this);
+}
+
+chcl::Logger::~Logger()
+{
+	{
+		std::lock_guard lock(m_mutex);
+		m_stopping = true;
+	}
+	m_wake.notify_one();
+	m_thread.join();
+}
+
+void chcl::Logger::flush()
+{
+	std::unique_lock lock(m_mutex);
+	uint64_t request = ++m_flushRequested;
+	m_wake.notify_one();
+	m_flushed.wait(lock, [&]() { return m_flushCompleted >= request; });
+}
+
+chcl::Logger::operator bool() const
+{
+	return m_file.good();
+}
+
+chcl::LoggerDetail::ThreadQueue* chcl::Logger::registerThread()
+{
+	auto &queues = t_threadQueues.queues;
+	auto found = std::find_if(queues.begin(), queues.end(), [&](const auto &entry) { return entry.first == m_id; });
+
+	if (found == queues.end())
+	{
+		// Queues of destroyed loggers are only held by this thread now
+		std::erase_if(queues, [](const auto &entry) { return entry.second.use_count() == 1; });
+
+		auto queue = std::make_shared<LoggerDetail::ThreadQueue>(m_queueSize);
+		{
+			std::lock_guard lock(m_queuesMutex);
+			m_queues.push_back(queue);
+		}
+		found = queues.emplace(queues.end(), m_id, std::move(queue));
+	}
+
+	s_cachedID = m_id;
+	s_cachedQueue = found->second.get();
+	return s_cachedQueue;
+}
+
+std::byte* chcl::Logger::waitForSpace(LoggerDetail::ThreadQueue &queue, LoggerDetail::RecordFormatter format, size_t argumentsSize)
+{
+	// A record bigger than the whole queue could never fit, but any other fits once the queue has been drained
+	if (m_policy == OverflowPolicy::Block && LoggerDetail::ThreadQueue::RecordSize(argumentsSize) <= queue.capacity())
+	{
+		std::byte *out;
+		while (!(out = queue.reserve(format, argumentsSize)))
+		{
+			// Each pass over the queues reads everything committed so far, which makes room unless the queue filled up again
+			std::unique_lock lock(m_mutex);
+			uint64_t request = ++m_drainRequested;
+			m_wake.notify_one();
+			m_flushed.wait(lock, [&]() { return m_drainCompleted >= request; });
+		}
+		return out;
+	}
+
+	queue.drop();
+	m_droppedCount.fetch_add(1, std::memory_order_relaxed);
+	return nullptr;
+}
+
+void chcl::Logger::run()
+{
+	Buffer batch(BatchSize);
+
+	std::unique_lock lock(m_mutex);
+	while (true)
+	{
+		m_wake.wait_for(lock, m_flushInterval, [&]()
+		{
+			return m_stopping || m_flushRequested > m_flushCompleted || m_drainRequested > m_drainCompleted;
+		});
+		const uint64_t request = m_flushRequested;
+		const uint64_t drainRequest = m_drainRequested;
+		const bool stopping = m_stopping;
+
+		lock.unlock();
+		drain(batch);
+		lock.lock();
+
+		m_flushCompleted = request;
+		m_drainCompleted = drainRequest;
+		m_flushed.notify_all();
+		if (stopping)
+			return;
+	}
+}
+
+void chcl::Logger::drain(Buffer &batch)
+{
+	auto writeBatch = [&]()
+	{
+		m_file.write(static_cast<const char*>(batch.data()), batch.size());
+		batch.setSize(0);
+	};
+
+	std::vector<std::shared_ptr<LoggerDetail::ThreadQueue>> queues;
+	{
+		std::lock_guard lock(m_queuesMutex);
+		queues = m_queues;
+	}
+
+	bool released = false;
+	for (const auto &queue : queues)
+	{
+		// Checked before draining, so a queue is only released once everything its thread wrote has been read
+		const bool closed = queue->closed();
+
+		if (uint64_t dropped = queue->takeDropped())
+			Formatter::FormatTo<"[{} messages dropped]\n">(batch, dropped);
+
+		queue->drain([&](LoggerDetail::RecordFormatter format, const std::byte *arguments)
+		{
+			format(batch, arguments);
+			batch.append('\n');
+			if (batch.size() >= BatchSize)
+				writeBatch();
+		});
+
+		released |= closed;
+	}
+
+	if (batch.size())
+		writeBatch();
+	m_file.flush();
+
+	if (released)
+	{
+		std::lock_guard lock(m_queuesMutex);
+		std::erase_if(m_queues, [](const auto &queue) { return queue->closed() && queue->empty(); });
+	}
+}
\ No newline at end of file
@@ -0,0 +1,354 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include "CHCL/Formatter.h"
+#include "CHCL/dataStorage/Buffer.h"
+
+namespace chcl
+{
+	namespace LoggerDetail
+	{
+		/// @brief Formats the arguments of one record onto the end of a batch
+		using RecordFormatter = void(*)(Buffer &out, const std::byte *arguments);
+
+		struct RecordHeader
+		{
+			RecordFormatter format; ///< nullptr for the padding that skips to the start of the ring
+			uint32_t size; ///< Size of the whole record, including this header
+		};
+
+		/// @brief Every record starts at a multiple of this, so padding always has room for a header
+		constexpr size_t RecordAlignment = 16;
+		static_assert(sizeof(RecordHeader) <= RecordAlignment);
+
+		/// @brief Arguments copied into the queue as text, so they do not need to outlive the log call
+		template <typename T>
+		concept StringArgument = std::is_convertible_v<const T&, std::string_view>;
+
+		template <typename T>
+		concept LogArgument = StringArgument<T> || (std::is_trivially_copyable_v<T> && std::is_default_constructible_v<T>);
+
+		/// @brief Type an argument is read back as on the background thread
+		template <typename T>
+		using StoredType = std::conditional_t<StringArgument<T>, std::string_view, T>;
+
+		/// @brief Format string of a record logged with a runtime format string
+		struct FormatPointer
+		{
+			const char *format;
+		};
+
+		template <typename T>
+		inline size_t EncodedSize(const T &arg)
+		{
+			if constexpr (StringArgument<T>)
+				return sizeof(uint32_t) + std::string_view(arg).length();
+			else
+				return sizeof(T);
+		}
+
+		template <typename T>
+		inline std::byte* Encode(std::byte *out, const T &arg)
+		{
+			if constexpr (StringArgument<T>)
+			{
+				std::string_view text = arg;
+				uint32_t length = uint32_t(text.length());
+				std::memcpy(out, &length, sizeof(length));
+				std::memcpy(out + sizeof(length), text.data(), length);
+				return out + sizeof(length) + length;
+			}
+			else
+			{
+				std::memcpy(out, &arg, sizeof(T));
+				return out + sizeof(T);
+			}
+		}
+
+		template <typename T>
+		StoredType<T> Decode(const std::byte *&in)
+		{
+			if constexpr (StringArgument<T>)
+			{
+				uint32_t length;
+				std::memcpy(&length, in, sizeof(length));
+				std::string_view text{ reinterpret_cast<const char*>(in) + sizeof(length), length };
+				in += sizeof(length) + length;
+				return text;
+			}
+			else
+			{
+				T value;
+				std::memcpy(&value, in, sizeof(T));
+				in += sizeof(T);
+				return value;
+			}
+		}
+
+		template <FormatString formatString, typename ...Ts>
+		void FormatRecord(Buffer &out, [[maybe_unused]] const std::byte *arguments)
+		{
+			// Braced initialization decodes the arguments in order
+			std::tuple<StoredType<Ts>...> values{ Decode<Ts>(arguments)... };
+			std::apply([&](const auto &...values) { Formatter::FormatTo<formatString>(out, values...); }, values);
+		}
+
+		template <typename ...Ts>
+		void FormatRuntimeRecord(Buffer &out, const std::byte *arguments)
+		{
+			FormatPointer format = Decode<FormatPointer>(arguments);
+			std::tuple<StoredType<Ts>...> values{ Decode<Ts>(arguments)... };
+			std::apply([&](const auto &...values) { Formatter::FormatTo(out, format.format, values...); }, values);
+		}
+
+		/**
+		 * @brief Lock-free ring of records written by one thread and read by the logger's background thread
+		 * Positions only ever increase, and are wrapped into the ring when used.
+		 */
+		class ThreadQueue
+		{
+		public:
+			/// @param capacity Size of the ring in bytes, a power of two
+			ThreadQueue(size_t capacity);
+
+			/// @brief Space a record takes in the ring, including its header and alignment
+			static constexpr size_t RecordSize(size_t argumentsSize)
+			{
+				return (sizeof(RecordHeader) + argumentsSize + RecordAlignment - 1) & ~(RecordAlignment - 1);
+			}
+
+			/**
+			 * @brief Starts a record on the writing thread
+			 * @return Where to write the record's arguments, or nullptr if the ring is full
+			 */
+			inline std::byte* reserve(RecordFormatter format, size_t argumentsSize)
+			{
+				const size_t size = RecordSize(argumentsSize);
+				if (size > capacity())
+					return nullptr;
+
+				uint64_t head = m_head.load(std::memory_order_relaxed);
+				size_t offset = head & m_mask;
+
+				// Records are never split, so one that would pass the end of the ring starts again at the beginning
+				if (offset + size > capacity())
+				{
+					const size_t padding = capacity() - offset;
+					m_cachedTail = m_tail.load(std::memory_order_acquire);
+					if (m_cachedTail == head)
+					{
+						// Everything written has been read, so the tail moves past the padding instead of the background thread skipping it
+						m_cachedTail += padding;
+						m_tail.store(m_cachedTail, std::memory_order_relaxed);
+					}
+					else
+					{
+						// The padding is published on its own, so the record can start at the beginning once it has been read
+						if (!hasRoom(head, padding))
+							return nullptr;
+
+						RecordHeader skip{ nullptr, uint32_t(padding) };
+						std::memcpy(m_data.get() + offset, &skip, sizeof(skip));
+						m_head.store(head + padding, std::memory_order_release);
+					}
+					head += padding;
+					offset = 0;
+				}
+
+				if (!hasRoom(head, size))
+					return nullptr;
+
+				RecordHeader header{ format, uint32_t(size) };
+				std::memcpy(m_data.get() + offset, &header, sizeof(header));
+				m_pendingHead = head + size;
+				return m_data.get() + offset + sizeof(RecordHeader);
+			}
+
+			/// @brief Publishes the record started by the last reserve
+			inline void commit() { m_head.store(m_pendingHead, std::memory_order_release); }
+
+			inline void drop() { m_dropped.fetch_add(1, std::memory_order_relaxed); }
+			/// @brief Marks that the writing thread has exited, so nothing more will be written
+			inline void close() { m_closed.store(true, std::memory_order_release); }
+
+			/**
+			 * @brief Reads every published record on the background thread, then frees their space
+			 * @param consumer Callable taking a RecordFormatter and a pointer to the record's arguments
+			 */
+			template <typename Consumer>
+			void drain(Consumer &&consumer)
+			{
+				// The head is loaded first, as the writing thread may move an empty ring's tail past the head before publishing
+				const uint64_t head = m_head.load(std::memory_order_acquire);
+				const uint64_t start = m_tail.load(std::memory_order_relaxed);
+				uint64_t tail = start;
+				while (tail < head)
+				{
+					const std::byte *record = m_data.get() + (tail & m_mask);
+					RecordHeader header;
+					std::memcpy(&header, record, sizeof(header));
+					if (header.format)
+						consumer(header.format, record + sizeof(RecordHeader));
+					tail += header.size;
+				}
+				if (tail != start)
+					m_tail.store(tail, std::memory_order_release);
+			}
+
+			inline uint64_t takeDropped() { return m_dropped.exchange(0, std::memory_order_relaxed); }
+			inline bool closed() const { return m_closed.load(std::memory_order_acquire); }
+			inline bool empty() const { return m_head.load(std::memory_order_acquire) <= m_tail.load(std::memory_order_relaxed); }
+			inline size_t capacity() const { return m_mask + 1; }
+
+		private:
+			std::unique_ptr<std::byte[]> m_data;
+			size_t m_mask;
+
+			// Written by the logging thread, kept off the background thread's cache line
+			alignas(64) std::atomic<uint64_t> m_head{ 0 };
+			uint64_t m_pendingHead = 0;
+			uint64_t m_cachedTail = 0; ///< Last tail seen, so the tail is only reloaded when the ring looks full
+
+			alignas(64) std::atomic<uint64_t> m_tail{ 0 };
+			std::atomic<uint64_t> m_dropped{ 0 };
+			std::atomic<bool> m_closed{ false };
+
+			/// @brief Whether size bytes can be written from head without overwriting anything unread
+			inline bool hasRoom(uint64_t head, size_t size)
+			{
+				if (head + size - m_cachedTail <= capacity())
+					return true;
+				m_cachedTail = m_tail.load(std::memory_order_acquire);
+				return head + size - m_cachedTail <= capacity();
+			}
+		};
+	}
+
+	/**
+	 * @brief Logs to a file, formatting messages on a background thread.
+	 *
+	 * A log call only copies its arguments into a lock-free queue owned by the calling thread, along with a
+	 * function that knows the format string and argument types. The background thread formats the queued
+	 * messages with Formatter, one per line, and appends them to the file in batches.
+	 * Messages from one thread keep their order, but messages from different threads may be written out of order.
+	 */
+	class Logger
+	{
+	public:
+		/// @brief What a log call does when its thread's queue is full
+		enum class OverflowPolicy
+		{
+			Drop, ///< Discard the message. The file notes how many messages were dropped
+			Block ///< Wait for the background thread to make room
+		};
+
+		static constexpr size_t DefaultQueueSize = 64 * 1024;
+		static constexpr std::chrono::milliseconds DefaultFlushInterval{ 10 };
+
+		/**
+		 * @brief Opens a file to append to and starts the background thread
+		 * @param filename File to log to
+		 * @param policy What to do when a thread logs faster than the background thread writes
+		 * @param queueSize Size of each thread's queue in bytes, rounded up to a power of two
+		 * @param flushInterval How long the background thread waits between batches
+		 */
+		Logger(const std::string &filename, OverflowPolicy policy = OverflowPolicy::Drop, size_t queueSize = DefaultQueueSize,
+			std::chrono::milliseconds flushInterval = DefaultFlushInterval);
+		Logger(const Logger&) = delete;
+		Logger& operator=(const Logger&) = delete;
+		/// @brief Writes every queued message before closing the file
+		~Logger();
+
+		/**
+		 * @brief Queues a message with a format string checked at compile time
+		 * Strings are copied, other arguments must be trivially copyable
+		 */
+		template <FormatString formatString, typename ...Ts>
+			requires (LoggerDetail::LogArgument<Ts> && ...)
+		void log(const Ts &...args)
+		{
+			static_assert(formatString.argCount <= sizeof...(Ts), "Format string refers to an argument that was not given");
+			push(&LoggerDetail::FormatRecord<formatString, Ts...>, args...);
+		}
+
+		/**
+		 * @brief Queues a message with a format string parsed when it is written
+		 * @param format Format string, which is not copied and so must outlive the logger, such as a string literal
+		 */
+		template <typename ...Ts>
+			requires (LoggerDetail::LogArgument<Ts> && ...)
+		void log(const char *format, const Ts &...args)
+		{
+			push(&LoggerDetail::FormatRuntimeRecord<Ts...>, LoggerDetail::FormatPointer{ format }, args...);
+		}
+
+		/// @brief Waits until every message queued before the call has been written to the file
+		void flush();
+
+		/// @brief Number of messages dropped because a queue was full
+		inline uint64_t droppedCount() const { return m_droppedCount.load(std::memory_order_relaxed); }
+
+		explicit operator bool() const;
+
+	private:
+		std::ofstream m_file;
+		OverflowPolicy m_policy;
+		size_t m_queueSize;
+		std::chrono::milliseconds m_flushInterval;
+		const uint64_t m_id;
+		std::atomic<uint64_t> m_droppedCount{ 0 };
+
+		std::mutex m_queuesMutex;
+		std::vector<std::shared_ptr<LoggerDetail::ThreadQueue>> m_queues;
+
+		std::mutex m_mutex;
+		std::condition_variable m_wake, m_flushed;
+		uint64_t m_flushRequested = 0, m_flushCompleted = 0;
+		/// @brief Passes over the queues requested by blocked log calls, which unlike flushes wake the background thread early
+		uint64_t m_drainRequested = 0, m_drainCompleted = 0;
+		bool m_stopping = false;
+		std::thread m_thread;
+
+		inline static std::atomic<uint64_t> s_nextID{ 1 };
+		// Queue of the logger this thread last logged to, so most log calls skip looking it up
+		inline static thread_local uint64_t s_cachedID = 0;
+		inline static thread_local LoggerDetail::ThreadQueue *s_cachedQueue = nullptr;
+
+		template <typename ...Ts>
+		void push(LoggerDetail::RecordFormatter format, const Ts &...args)
+		{
+			const size_t argumentsSize = (LoggerDetail::EncodedSize(args) + ... + size_t(0));
+			LoggerDetail::ThreadQueue *queue = s_cachedID == m_id ? s_cachedQueue : registerThread();
+
+			std::byte *out = queue->reserve(format, argumentsSize);
+			if (!out && !(out = waitForSpace(*queue, format, argumentsSize)))
+				return;
+
+			((out = LoggerDetail::Encode(out, args)), ...);
+			queue->commit();
+		}
+
+		/// @brief Creates the calling thread's queue, or finds it after logging to another logger
+		LoggerDetail::ThreadQueue* registerThread();
+		/// @brief Applies the overflow policy to a record that did not fit
+		std::byte* waitForSpace(LoggerDetail::ThreadQueue &queue, LoggerDetail::RecordFormatter format, size_t argumentsSize);
+
+		void run();
+		void drain(Buffer &batch);
+	};
+}
\ No newline at end of file
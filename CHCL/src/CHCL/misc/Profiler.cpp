@@ -1,58 +1,270 @@
 #include "Profiler.h"
 
+#include <algorithm>
+#include <bit>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
 #include "CHCL/Formatter.h"
+#include "CHCL/dataStorage/JSON_Writer.h"
+
+namespace
+{
+	using chcl::Profiler::ProfilerEntry;
+
+	/**
+	 * @brief Profiling state of one thread.
+	 * Kept after the thread exits, so its timings still show up in reports.
+	 */
+	struct ThreadProfile
+	{
+		struct TraceEvent
+		{
+			const ProfilerEntry *entry;
+			chcl::ProfilerClock::ticks time;
+			bool begin;
+		};
+
+		std::string name;
+		ProfilerEntry topLevelEntry{ chcl::Profiler::TopLevelName };
+		ProfilerEntry *currentEntry = &topLevelEntry;
+		bool bad = false;
+
+		/// @brief Ring of the most recent events, sized to a power of two
+		std::vector<TraceEvent> events;
+		uint64_t eventCount = 0; ///< Events recorded in the current session, including overwritten ones
+		uint64_t session = 0; ///< Recording session the events belong to
+	};
+
+	/// @brief Guards the list of threads and the shape of every thread's tree, but not durations
+	std::mutex g_treeMutex;
+	std::vector<std::unique_ptr<ThreadProfile>> g_threads;
+
+	std::atomic<bool> g_recording = false;
+	/// @brief Incremented by every StartRecording, so threads know to start a new ring
+	std::atomic<uint64_t> g_recordingSession = 0;
+	std::atomic<size_t> g_eventsPerThread = chcl::Profiler::DefaultTraceEvents;
+
+	thread_local ThreadProfile *t_profile = nullptr;
+
+	ThreadProfile& CurrentThread()
+	{
+		if (t_profile)
+			return *t_profile;
+
+		std::lock_guard lock(g_treeMutex);
+		auto profile = std::make_unique<ThreadProfile>();
+		profile->name = chcl::Formatter::Format<"thread {}">(g_threads.size());
+		t_profile = profile.get();
+		g_threads.push_back(std::move(profile));
+		return *t_profile;
+	}
+
+	void Record(ThreadProfile &profile, const ProfilerEntry *entry, chcl::ProfilerClock::ticks time, bool begin)
+	{
+		// The ring is only allocated or cleared by the first event of a session, never on the hot path after that
+		uint64_t session = g_recordingSession.load(std::memory_order_relaxed);
+		if (profile.session != session)
+		{
+			profile.events.assign(g_eventsPerThread.load(std::memory_order_relaxed), {});
+			profile.eventCount = 0;
+			profile.session = session;
+		}
 
-static chcl::Profiler::ProfilerEntry * const g_topLevelEntry = new chcl::Profiler::ProfilerEntry(chcl::Profiler::TopLevelName);
-// static std::vector<chcl::Profiler::ProfilerEntry*> g_entries = { g_topLevelEntry};
-static chcl::Profiler::ProfilerEntry *g_currentEntry = g_topLevelEntry;
-static bool g_profilerBad = false;
+		profile.events[profile.eventCount++ & (profile.events.size() - 1)] = { entry, time, begin };
+	}
+
+	void PrintThreads(double ticksPerSecond)
+	{
+		std::lock_guard lock(g_treeMutex);
+		for (const auto &profile : g_threads)
+		{
+			std::cout << chcl::Formatter::Format<"{}:\n">(profile->name);
+			profile->topLevelEntry.print(ticksPerSecond);
+		}
+	}
+
+	/// @return Number of threads merged
+	size_t MergeThreads(ProfilerEntry &merged)
+	{
+		std::lock_guard lock(g_treeMutex);
+		for (const auto &profile : g_threads)
+			merged.merge(profile->topLevelEntry);
+		return g_threads.size();
+	}
+
+	void PrintMerged(double ticksPerSecond)
+	{
+		// Built from copies of the durations, so it needs no lock once merged
+		ProfilerEntry merged{ chcl::Profiler::TopLevelName };
+		size_t threadCount = MergeThreads(merged);
+
+		std::cout << chcl::Formatter::Format<"All {} threads:\n">(threadCount);
+		merged.print(ticksPerSecond);
+	}
+}
 
 void chcl::Profiler::Begin(ProfilerEntry *entry)
 {
-	if (g_profilerBad) return;
-	entry->begin();
+	ThreadProfile &profile = CurrentThread();
+	if (profile.bad) return;
+	chcl::ProfilerClock::ticks time = entry->begin();
+	if (g_recording.load(std::memory_order_relaxed))
+		Record(profile, entry, time, true);
 
-	g_currentEntry = entry;
+	profile.currentEntry = entry;
 }
 
 void chcl::Profiler::End(ProfilerEntry *entry)
 {
-	if (g_profilerBad) return;
+	ThreadProfile &profile = CurrentThread();
+	if (profile.bad) return;
 
-	if (g_currentEntry != entry)
+	if (profile.currentEntry != entry)
 	{
-		std::cout << Formatter::Format("Profiler BAD: got {}, expected {}\n", entry->getName(), g_currentEntry->getName());
-		while (g_currentEntry != g_topLevelEntry)
+		std::cout << Formatter::Format<"Profiler BAD on {}: got {}, expected {}\n">(profile.name, entry->getName(), profile.currentEntry->getName());
+		while (profile.currentEntry != &profile.topLevelEntry)
 		{
-			g_currentEntry->end();
-			g_currentEntry = g_currentEntry->getParentEntry();
+			profile.currentEntry->end();
+			profile.currentEntry = profile.currentEntry->getParentEntry();
 		}
-		g_profilerBad = true;
+		profile.bad = true;
 		return;
 	}
 
-	g_currentEntry->end();
-	g_currentEntry = g_currentEntry->getParentEntry();
+	chcl::ProfilerClock::ticks time = profile.currentEntry->end();
+	if (time && g_recording.load(std::memory_order_relaxed))
+		Record(profile, entry, time, false);
+
+	profile.currentEntry = profile.currentEntry->getParentEntry();
+}
+
+void chcl::Profiler::SetThreadName(const std::string &name)
+{
+	ThreadProfile &profile = CurrentThread();
+	std::lock_guard lock(g_treeMutex);
+	profile.name = name;
 }
 
 void chcl::Profiler::PrintTree()
 {
-	g_topLevelEntry->print();
+	const double ticksPerSecond = ProfilerClock::TicksPerSecond();
+	PrintThreads(ticksPerSecond);
+	PrintMerged(ticksPerSecond);
+}
+
+void chcl::Profiler::PrintThreadTrees()
+{
+	PrintThreads(ProfilerClock::TicksPerSecond());
+}
+
+void chcl::Profiler::PrintMergedTree()
+{
+	PrintMerged(ProfilerClock::TicksPerSecond());
+}
+
+void chcl::Profiler::ForEachThreadTree(const std::function<void(const std::string&, const ProfilerEntry&)> &visitor)
+{
+	std::lock_guard lock(g_treeMutex);
+	for (const auto &profile : g_threads)
+		visitor(profile->name, profile->topLevelEntry);
+}
+
+void chcl::Profiler::MergeThreadTrees(ProfilerEntry &merged)
+{
+	MergeThreads(merged);
+}
+
+void chcl::Profiler::StartRecording(size_t eventsPerThread)
+{
+	g_eventsPerThread.store(std::bit_ceil(std::max<size_t>(eventsPerThread, 2)), std::memory_order_relaxed);
+	g_recordingSession.fetch_add(1, std::memory_order_relaxed);
+	g_recording.store(true, std::memory_order_relaxed);
+}
+
+void chcl::Profiler::StopRecording()
+{
+	g_recording.store(false, std::memory_order_relaxed);
+}
+
+bool chcl::Profiler::ExportTrace(const std::string &filename)
+{
+	std::ofstream file{ filename, std::ios::binary };
+	if (!file)
+		return false;
+
+	std::lock_guard lock(g_treeMutex);
+	const uint64_t session = g_recordingSession.load(std::memory_order_relaxed);
+
+	// Oldest event still held by any thread of the session, for timestamps to start from
+	auto firstEvent = [&](const ThreadProfile &profile) { return profile.eventCount > profile.events.size() ? profile.eventCount - profile.events.size() : 0; };
+	ProfilerClock::ticks origin = std::numeric_limits<ProfilerClock::ticks>::max();
+	for (const auto &profile : g_threads)
+	{
+		if (profile->session == session && profile->eventCount)
+			origin = std::min(origin, profile->events[firstEvent(*profile) & (profile->events.size() - 1)].time);
+	}
+	const double ticksPerMicrosecond = ProfilerClock::TicksPerSecond() / 1e6;
+
+	{
+		JSON_Writer writer{ std::ostreambuf_iterator<char>(file), JSON_Writer::Style::Compact };
+		writer.beginObject().key("traceEvents").beginArray();
+
+		for (size_t thread = 0; thread < g_threads.size(); ++thread)
+		{
+			const ThreadProfile &profile = *g_threads[thread];
+			writer.beginObject().key("name").value("thread_name").key("ph").value("M").key("pid").value(1).key("tid").value(thread)
+				.key("args").beginObject().key("name").value(profile.name).endObject().endObject();
+
+			if (profile.session != session)
+				continue;
+
+			// Scopes that began before the oldest event kept are dropped entirely, as their begin was overwritten
+			size_t depth = 0;
+			for (uint64_t i = firstEvent(profile); i < profile.eventCount; ++i)
+			{
+				const auto &event = profile.events[i & (profile.events.size() - 1)];
+				if (!event.begin && depth == 0)
+					continue;
+				if (event.begin)
+					++depth;
+				else
+					--depth;
+
+				writer.beginObject()
+					.key("name").value(event.entry->getName())
+					.key("ph").value(event.begin ? "B" : "E")
+					.key("ts").value(double(event.time - origin) / ticksPerMicrosecond)
+					.key("pid").value(1)
+					.key("tid").value(thread)
+					.endObject();
+			}
+		}
+
+		writer.endArray().key("displayTimeUnit").value("ns").endObject();
+	}
+
+	return file.good();
 }
 
-void chcl::Profiler::ProfilerEntry::print(int depth) const
+void chcl::Profiler::ProfilerEntry::print(double ticksPerSecond, int depth) const
 {
-	std::cout << chcl::Formatter::Format("{}- {}: {}\n", std::string(depth * 2, ' '), m_scopeName, m_duration);
+	const ProfilerClock::ticks duration = getTicks();
+	std::cout << chcl::Formatter::Format<"{}- {}: {}\n">(std::string(depth * 2, ' '), m_scopeName, ProfilerClock::ToDuration<time_type>(duration, ticksPerSecond));
 
-	time_type child_cumulative = time_type(0);
+	ProfilerClock::ticks child_cumulative = 0;
 	for (auto const &[name, entry] : m_childEntries)
 	{
-		entry->print(depth + 1);
-		child_cumulative += entry->getDuration();
+		entry->print(ticksPerSecond, depth + 1);
+		child_cumulative += entry->getTicks();
 	}
 
-	if (m_childEntries.size() > 0 && child_cumulative < m_duration)
-		std::cout << chcl::Formatter::Format("  {}- *other: {}\n", std::string(depth * 2, ' '), m_duration - child_cumulative);
+	if (m_childEntries.size() > 0 && child_cumulative < duration)
+		std::cout << chcl::Formatter::Format<"  {}- *other: {}\n">(std::string(depth * 2, ' '), ProfilerClock::ToDuration<time_type>(duration - child_cumulative, ticksPerSecond));
 }
 
 chcl::Profiler::ProfilerEntry::ProfilerEntry(const char *scopeName) :
@@ -102,33 +314,33 @@ chcl::Profiler::ProfilerEntry::ProfilerEntry(ProfilerEntry &&other)
 
 chcl::Profiler::ProfilerEntry::~ProfilerEntry()
 {
-	// TODO: Actually implement well
-	// for (auto &[name, childIndex] : m_childEntryIndices)
-	// {
-	// 	g_entries.erase(g_entries.begin() + childIndex);
-	// }
+	for (auto &[name, child] : m_childEntries)
+		delete child;
 }
 
-void chcl::Profiler::ProfilerEntry::begin()
+chcl::ProfilerClock::ticks chcl::Profiler::ProfilerEntry::begin()
 {
 	m_running = true;
-	m_scopeBeginTime = std::chrono::steady_clock::now();
+	m_scopeBeginTicks = ProfilerClock::Now();
+	return m_scopeBeginTicks;
 }
 
-void chcl::Profiler::ProfilerEntry::end()
+chcl::ProfilerClock::ticks chcl::Profiler::ProfilerEntry::end()
 {
 	if (!m_running)
-		return;
+		return 0;
 
+	ProfilerClock::ticks now = ProfilerClock::Now();
+	ProfilerClock::ticks scopeTicks = now - m_scopeBeginTicks;
 	m_running = false;
 
-	time_type scopeDuration = std::chrono::duration_cast<time_type>(std::chrono::steady_clock::now() - m_scopeBeginTime);
-
 	// if (m_parentScope)
 	// 	m_parentScope->m_pauseDuration += m_pauseDuration;
 
-	m_duration += scopeDuration;
+	// Only the owning thread writes, so this does not need to be an atomic add
+	m_duration.store(m_duration.load(std::memory_order_relaxed) + scopeTicks, std::memory_order_relaxed);
 	// m_pauseDuration = time_type(0);
+	return now;
 }
 
 #if 0
@@ -147,25 +359,60 @@ void chcl::Profiler::ProfilerEntry::unpause()
 
 chcl::Profiler::ProfilerEntry* chcl::Profiler::ProfilerEntry::getChildEntry(const char *name)
 {
-	ProfilerEntry *res = m_childEntries[name];
+	// Only the owning thread changes the children, so it can look them up without the lock
+	auto found = m_childEntries.find(name);
+	if (found != m_childEntries.end())
+		return found->second;
 
-	if (res == nullptr)
-		res = addChildEntry(name);
+	return addChildEntry(name);
+}
 
-	return res;
+chcl::Profiler::ProfilerEntry* chcl::Profiler::ProfilerEntry::getChildEntry(const EntryCache *cache)
+{
+	auto found = m_cachedChildren.find(cache);
+	if (found != m_cachedChildren.end())
+		return found->second;
+
+	ProfilerEntry *child = getChildEntry(cache->getName().c_str());
+	m_cachedChildren.emplace(cache, child);
+	return child;
 }
 
 chcl::Profiler::ProfilerEntry* chcl::Profiler::ProfilerEntry::addChildEntry(const char *name)
 {
 	ProfilerEntry *child = new ProfilerEntry(name);
+	child->m_parentEntry = this;
 
+	std::lock_guard lock(g_treeMutex);
 	// g_entries.push_back(child);
 	m_childEntries[name] = child;
-	child->m_parentEntry = this;
 
 	return child;
 }
 
+const chcl::Profiler::ProfilerEntry* chcl::Profiler::ProfilerEntry::findChildEntry(const std::string &name) const
+{
+	auto found = m_childEntries.find(name);
+	return found != m_childEntries.end() ? found->second : nullptr;
+}
+
+void chcl::Profiler::ProfilerEntry::merge(const ProfilerEntry &other)
+{
+	m_duration.fetch_add(other.m_duration.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+	for (auto const &[name, otherChild] : other.m_childEntries)
+	{
+		// The merged tree is not shared, so children are added without taking the lock the caller holds
+		ProfilerEntry *&child = m_childEntries[name];
+		if (!child)
+		{
+			child = new ProfilerEntry(name.c_str());
+			child->m_parentEntry = this;
+		}
+		child->merge(*otherChild);
+	}
+}
+
 #if 0
 chcl::Profiler::ProfilerEntry& chcl::Profiler::ProfilerEntry::operator =(const ProfilerEntry &other)
 {
@@ -216,14 +463,7 @@ unsigned int chcl::Profiler::EntryCache::getIndex()
 
 chcl::Profiler::ProfilerEntry* chcl::Profiler::EntryCache::get()
 {
-	ProfilerEntry *res = m_entryMap[g_currentEntry->getNumericID()];
-
-	if (res != nullptr)
-		return res;
-
-	m_entryMap[g_currentEntry->getNumericID()] = g_currentEntry->getChildEntry(m_name.c_str());
-
-	return m_entryMap[g_currentEntry->getNumericID()];
+	return CurrentThread().currentEntry->getChildEntry(this);
 }
 
 chcl::Profiler::ScopeAutoProfiler::ScopeAutoProfiler(EntryCache *cache) :
@@ -1,31 +1,46 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
+#include <functional>
 #include <map>
 #include <unordered_map>
 #include <string>
 
+#include "ProfilerClock.h"
+
 namespace chcl
 {
+	/**
+	 * @brief Hierarchical timing of profiled scopes.
+	 * Every thread profiles into its own tree of entries, so scopes on different threads never share state.
+	 * Only adding an entry to a tree or printing a report takes a lock.
+	 */
 	namespace Profiler
 	{
+		class EntryCache;
+
 		class ProfilerEntry
 		{
 		public:
-			using time_type = std::chrono::microseconds;
+			/// @brief Unit durations are reported in. They are recorded in ProfilerClock ticks
+			using time_type = std::chrono::duration<double, std::micro>;
 			
 		private:
-			inline static unsigned int s_idIncrementer = 0;
+			inline static std::atomic<unsigned int> s_idIncrementer = 0;
 			unsigned int m_numericID = 0;
 
 			std::string m_scopeName;
 			
 			bool m_running = false;
-			std::chrono::steady_clock::time_point m_scopeBeginTime; //, m_pauseBegin;
-			time_type m_duration = time_type(0); //, m_pauseDuration = time_type(0);
+			ProfilerClock::ticks m_scopeBeginTicks = 0; //, m_pauseBegin;
+			// Atomic so reports can read it while the owning thread is profiling
+			std::atomic<ProfilerClock::ticks> m_duration = 0; //, m_pauseDuration = time_type(0);
 
 			ProfilerEntry *m_parentEntry = nullptr;
 			std::map<std::string, ProfilerEntry*> m_childEntries = {};
+			/// @brief Children found through each call site's cache, only used by the owning thread
+			std::unordered_map<const EntryCache*, ProfilerEntry*> m_cachedChildren = {};
 
 		public:
 			ProfilerEntry() = delete;
@@ -34,8 +49,10 @@ namespace chcl
 			// ProfilerEntry(ProfilerEntry&&);
 			~ProfilerEntry();
 
-			void begin();
-			void end();
+			/// @return Time the scope began at
+			ProfilerClock::ticks begin();
+			/// @return Time the scope ended at, or 0 if it was not running
+			ProfilerClock::ticks end();
 
 			// void pause();
 			// void unpause();
@@ -43,27 +60,40 @@ namespace chcl
 			inline unsigned int getNumericID() const { return m_numericID; }
 			inline const std::string& getName() const { return m_scopeName; }
 			ProfilerEntry* getChildEntry(const char *name);
+			ProfilerEntry* getChildEntry(const EntryCache *cache);
 			ProfilerEntry* addChildEntry(const char *name);
+			/// @return Child with the given name, or nullptr. Never adds one, so other threads' trees can be read through ForEachThreadTree
+			const ProfilerEntry* findChildEntry(const std::string &name) const;
 			inline ProfilerEntry* getParentEntry() const { return m_parentEntry; }
 
-			inline time_type getDuration() const { return m_duration; }
+			inline ProfilerClock::ticks getTicks() const { return m_duration.load(std::memory_order_relaxed); }
+			inline time_type getDuration(double ticksPerSecond) const { return ProfilerClock::ToDuration<time_type>(getTicks(), ticksPerSecond); }
 			// inline time_type getPauseDuration() const { return m_pauseDuration; }
 
-			void print(int depth = 0) const;
+			/// @brief Adds the durations of another tree to this one, matching entries by name
+			void merge(const ProfilerEntry &other);
+
+			/// @param ticksPerSecond Rate from ProfilerClock::TicksPerSecond, shared by the whole report
+			void print(double ticksPerSecond, int depth = 0) const;
 
 			// ProfilerEntry& operator =(const ProfilerEntry&);
 			// ProfilerEntry& operator =(ProfilerEntry&&);
 		};
 
+		/**
+		 * @brief Static state of a profiled scope, shared by every thread
+		 * Each parent entry remembers which of its children belongs to the cache, so the lookup needs no locks
+		 */
 		class EntryCache
 		{
 		private:
-			std::unordered_map<unsigned int, ProfilerEntry*> m_entryMap;
 			std::string m_name;
 		public:
 			EntryCache(const char *name);
 
+			/// @brief Gets the calling thread's entry for this scope under its current entry
 			ProfilerEntry* get();
+			inline const std::string& getName() const { return m_name; }
 		};
 
 		class ScopeAutoProfiler
@@ -80,7 +110,39 @@ namespace chcl
 		void Begin(ProfilerEntry *entry);
 		void End(ProfilerEntry *entry);
 
+		/// @brief Names the calling thread in reports. Threads are numbered in the order they first profile otherwise
+		void SetThreadName(const std::string &name);
+
+		/// @brief Prints the tree of every thread, followed by the trees of all threads merged together
 		void PrintTree();
+		void PrintThreadTrees();
+		void PrintMergedTree();
+
+		/**
+		 * @brief Calls a visitor with the name and tree of every thread, in the order they first profiled
+		 * The visitor runs with the tree lock held, so it must not profile or print the trees itself
+		 */
+		void ForEachThreadTree(const std::function<void(const std::string&, const ProfilerEntry&)> &visitor);
+		/// @brief Adds the trees of all threads to merged, as PrintMergedTree reports them
+		void MergeThreadTrees(ProfilerEntry &merged);
+
+		/// @brief Events each thread keeps while recording. Once full, the oldest are overwritten
+		constexpr size_t DefaultTraceEvents = 1 << 16;
+
+		/**
+		 * @brief Starts recording when every scope begins and ends, on top of the totals in the trees
+		 * Each thread records into its own ring of events, allocated the first time it records
+		 * @param eventsPerThread Size of each ring, rounded up to a power of two
+		 */
+		void StartRecording(size_t eventsPerThread = DefaultTraceEvents);
+		void StopRecording();
+
+		/**
+		 * @brief Writes the recorded events as Chrome Trace Event JSON, which Perfetto and chrome://tracing can open
+		 * Must be called after StopRecording, once no thread is still recording
+		 * @return Whether the file was written
+		 */
+		bool ExportTrace(const std::string &filename);
 	}
 }
 
@@ -0,0 +1,76 @@
+#include "ProfilerClock.h"
+
+#include <thread>
+
+#if defined(CHCL_PROFILER_TSC) && !defined(_MSC_VER)
+	#include <cpuid.h>
+#endif
+
+namespace
+{
+	using chcl::ProfilerClock::ticks;
+
+	/// @brief Shortest interval the time stamp counter is calibrated over
+	constexpr std::chrono::milliseconds MinimumCalibrationTime{ 20 };
+
+	struct Sample
+	{
+		ticks count;
+		std::chrono::steady_clock::time_point time;
+
+		static Sample Take()
+		{
+			return { chcl::ProfilerClock::Now(), std::chrono::steady_clock::now() };
+		}
+	};
+
+	const Sample& StartupSample()
+	{
+		static const Sample sample = Sample::Take();
+		return sample;
+	}
+
+	// Taken during static initialization, so calibration spans as much of the run as possible
+	const Sample &g_startupSample = StartupSample();
+}
+
+bool chcl::ProfilerClock::DetectInvariantTSC()
+{
+#ifdef CHCL_PROFILER_TSC
+	// Leaf 0x80000007 reports the invariant TSC in bit 8 of EDX
+	constexpr unsigned int PowerLeaf = 0x80000007;
+	constexpr unsigned int InvariantTSCBit = 1u << 8;
+
+	#ifdef _MSC_VER
+		int registers[4];
+		__cpuid(registers, 0x80000000);
+		if ((unsigned int)registers[0] < PowerLeaf)
+			return false;
+		__cpuid(registers, PowerLeaf);
+		return registers[3] & InvariantTSCBit;
+	#else
+		unsigned int eax, ebx, ecx, edx;
+		if (!__get_cpuid(PowerLeaf, &eax, &ebx, &ecx, &edx))
+			return false;
+		return edx & InvariantTSCBit;
+	#endif
+#else
+	return false;
+#endif
+}
+
+double chcl::ProfilerClock::TicksPerSecond()
+{
+	if (!UsingTSC())
+		return double(std::chrono::steady_clock::period::den) / std::chrono::steady_clock::period::num;
+
+	const Sample &start = StartupSample();
+	Sample now = Sample::Take();
+	if (now.time - start.time < MinimumCalibrationTime)
+	{
+		std::this_thread::sleep_until(start.time + MinimumCalibrationTime);
+		now = Sample::Take();
+	}
+
+	return double(now.count - start.count) / std::chrono::duration<double>(now.time - start.time).count();
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	#define CHCL_PROFILER_TSC
+	#ifdef _MSC_VER
+		#include <intrin.h>
+	#else
+		#include <x86intrin.h>
+	#endif
+#endif
+
+namespace chcl
+{
+	/**
+	 * @brief Cheap timestamps for the Profiler.
+	 * Reads the CPU's time stamp counter when it runs at a constant rate, and steady_clock otherwise.
+	 * Ticks are only converted to time when reporting, against a steady_clock sample taken at startup.
+	 */
+	namespace ProfilerClock
+	{
+		using ticks = uint64_t;
+
+		/// @brief Whether the CPU has a time stamp counter that runs at a constant rate in every power state
+		bool DetectInvariantTSC();
+
+		/// @brief Whether Now reads the time stamp counter rather than steady_clock
+		inline bool UsingTSC()
+		{
+#ifdef CHCL_PROFILER_TSC
+			static const bool usingTSC = DetectInvariantTSC();
+			return usingTSC;
+#else
+			return false;
+#endif
+		}
+
+		inline ticks Now()
+		{
+#ifdef CHCL_PROFILER_TSC
+			if (UsingTSC())
+				return __rdtsc();
+#endif
+			return ticks(std::chrono::steady_clock::now().time_since_epoch().count());
+		}
+
+		/**
+		 * @brief Gets the rate ticks advance at
+		 * The time stamp counter is measured against steady_clock over the time since startup, so the estimate
+		 * improves the longer the program runs. Calibrating shortly after startup briefly waits for a usable interval.
+		 */
+		double TicksPerSecond();
+
+		/// @param ticksPerSecond Rate from TicksPerSecond, taken once per report rather than for every conversion
+		template <typename Duration = std::chrono::duration<double, std::micro>>
+		Duration ToDuration(ticks count, double ticksPerSecond)
+		{
+			return std::chrono::duration_cast<Duration>(std::chrono::duration<double>(double(count) / ticksPerSecond));
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,91 @@
+#include "Harness.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+	std::atomic<uint64_t> allocationCount{ 0 };
+	std::atomic<uint64_t> liveBytes{ 0 };
+	std::atomic<uint64_t> peakBytes{ 0 };
+
+	/// @brief Space in front of every allocation recording its size, keeping the returned pointer aligned
+	constexpr size_t HeaderSize = alignof(std::max_align_t);
+
+	void* CountedAllocate(size_t size)
+	{
+		void *block = std::malloc(size + HeaderSize);
+		if (!block)
+			throw std::bad_alloc();
+
+		*static_cast<size_t*>(block) = size;
+		allocationCount.fetch_add(1, std::memory_order_relaxed);
+
+		uint64_t live = liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+		uint64_t peak = peakBytes.load(std::memory_order_relaxed);
+		while (live > peak && !peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed));
+
+		return static_cast<char*>(block) + HeaderSize;
+	}
+
+	void CountedFree(void *pointer)
+	{
+		if (!pointer)
+			return;
+
+		void *block = static_cast<char*>(pointer) - HeaderSize;
+		liveBytes.fetch_sub(*static_cast<size_t*>(block), std::memory_order_relaxed);
+		std::free(block);
+	}
+}
+
+// Nothrow forms forward to these by default. Over-aligned forms are left alone and go uncounted
+void* operator new(size_t size) { return CountedAllocate(size); }
+void* operator new[](size_t size) { return CountedAllocate(size); }
+void operator delete(void *pointer) noexcept { CountedFree(pointer); }
+void operator delete[](void *pointer) noexcept { CountedFree(pointer); }
+// The header records the size, so the sized forms ignore theirs
+void operator delete(void *pointer, size_t) noexcept { CountedFree(pointer); }
+void operator delete[](void *pointer, size_t) noexcept { CountedFree(pointer); }
+
+uint64_t Harness::AllocationCount()
+{
+	return allocationCount.load(std::memory_order_relaxed);
+}
+
+uint64_t Harness::LiveBytes()
+{
+	return liveBytes.load(std::memory_order_relaxed);
+}
+
+uint64_t Harness::PeakBytes()
+{
+	return peakBytes.load(std::memory_order_relaxed);
+}
+
+void Harness::ResetPeak()
+{
+	peakBytes.store(liveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+void Harness::Print(const std::vector<Measurement> &measurements, const std::vector<Measurement> &baseline)
+{
+	std::printf("%-40s %12s %10s %14s %12s\n", "Benchmark", "MB/s", "Allocs/doc", "Peak bytes", "vs baseline");
+	for (const Measurement &measurement : measurements)
+	{
+		std::printf("%-40s %12.1f %10.1f %14llu", measurement.name.c_str(), measurement.megabytesPerSecond,
+			measurement.allocationsPerDocument, (unsigned long long)measurement.peakBytes);
+
+		for (const Measurement &previous : baseline)
+		{
+			if (previous.name == measurement.name && previous.megabytesPerSecond > 0.0)
+			{
+				std::printf(" %+11.1f%%", (measurement.megabytesPerSecond / previous.megabytesPerSecond - 1.0) * 100.0);
+				break;
+			}
+		}
+		std::printf("\n");
+	}
+}
\ No newline at end of file
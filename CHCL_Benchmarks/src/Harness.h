@@ -0,0 +1,102 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <chcl/dataStorage/JSON_Binding.h>
+
+namespace Harness
+{
+	/**
+	 * @brief Result of running one operation on one document
+	 */
+	struct Measurement
+	{
+		std::string name;
+		double megabytesPerSecond = 0.0;
+		double allocationsPerDocument = 0.0;
+		/// @brief Most heap memory held at once by a single run, on top of what was held before it
+		uint64_t peakBytes = 0;
+		uint64_t iterations = 0;
+	};
+
+	/// @brief Heap allocations made since the program started, counted by the replaced global operator new
+	uint64_t AllocationCount();
+	/// @brief Heap memory currently allocated through operator new
+	uint64_t LiveBytes();
+	/// @brief Most heap memory allocated at once since the last call to ResetPeak
+	uint64_t PeakBytes();
+	void ResetPeak();
+
+	/// @brief Written by DoNotOptimize where inline assembly is unavailable
+	inline const void *volatile Sink = nullptr;
+
+	/**
+	 * @brief Keeps the compiler from discarding a result the benchmark does not otherwise use
+	 * The value is treated as read by code the compiler cannot see, so everything that produced it must run
+	 */
+	template <typename T>
+	inline void DoNotOptimize(const T &value)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "r,m"(value) : "memory");
+#else
+		Sink = &value;
+#endif
+	}
+
+	/// @brief Minimum time each operation is repeated for
+	inline std::chrono::duration<double> MinimumTime{ 0.5 };
+	/// @brief Minimum number of times each operation is repeated
+	inline uint64_t MinimumIterations = 5;
+
+	/**
+	 * @brief Times an operation, repeating it until both minimums are reached
+	 * @param name Name to report the operation under
+	 * @param documentBytes Size of the document one run processes, to compute throughput from
+	 * @param run Operation to measure, called with no arguments
+	 */
+	template <typename Run>
+	Measurement Measure(std::string name, size_t documentBytes, Run &&run)
+	{
+		// One untimed run, so lazily created buffers and file caches do not count against the first iteration
+		run();
+
+		ResetPeak();
+		const uint64_t baseBytes = LiveBytes();
+		const uint64_t baseAllocations = AllocationCount();
+
+		Measurement result;
+		result.name = std::move(name);
+
+		auto begin = std::chrono::steady_clock::now();
+		std::chrono::duration<double> elapsed{ 0.0 };
+		while (result.iterations < MinimumIterations || elapsed < MinimumTime)
+		{
+			run();
+			++result.iterations;
+			elapsed = std::chrono::steady_clock::now() - begin;
+		}
+
+		const double iterations = double(result.iterations);
+		result.megabytesPerSecond = double(documentBytes) * iterations / elapsed.count() / 1e6;
+		result.allocationsPerDocument = double(AllocationCount() - baseAllocations) / iterations;
+		result.peakBytes = PeakBytes() - baseBytes;
+		return result;
+	}
+
+	/**
+	 * @brief Prints measurements as a table, with the change from a baseline if one has a matching name
+	 */
+	void Print(const std::vector<Measurement> &measurements, const std::vector<Measurement> &baseline);
+}
+
+template <> struct chcl::JSON_BindingOf<Harness::Measurement> : chcl::JSON_Binding<
+	chcl::JSON_Field<"name", &Harness::Measurement::name>,
+	chcl::JSON_Field<"megabytes_per_second", &Harness::Measurement::megabytesPerSecond>,
+	chcl::JSON_Field<"allocations_per_document", &Harness::Measurement::allocationsPerDocument>,
+	chcl::JSON_Field<"peak_bytes", &Harness::Measurement::peakBytes>,
+	chcl::JSON_Field<"iterations", &Harness::Measurement::iterations>> {};
\ No newline at end of file
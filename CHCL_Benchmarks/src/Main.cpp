@@ -0,0 +1,28 @@
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <chcl/dataStorage/JSON_Parser.h>
+
+#include "Harness.h"
+#include "benchmarks/JSONBenchmarks.h"
+
+/**
+ * Usage: "CHCL Benchmarks" [results.json] [baseline.json]
+ * Results are saved so they can be kept per release and passed back in as the baseline of a later run.
+ */
+int main(int argc, char **argv)
+{
+	std::vector<Harness::Measurement> results;
+	benchmarks::json::all(results);
+
+	std::vector<Harness::Measurement> baseline;
+	if (argc > 2 && std::filesystem::exists(argv[2]))
+		baseline = chcl::JSON_Parser::ReadFile<std::vector<Harness::Measurement>>(argv[2]);
+
+	Harness::Print(results, baseline);
+
+	if (argc > 1)
+		chcl::JSON_Parser::SaveToFile(argv[1], results);
+}
\ No newline at end of file
@@ -0,0 +1,237 @@
+#include "JSONBenchmarks.h"
+
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <random>
+#include <string>
+
+#include <chcl/dataStorage/JSON_Integration.h>
+#include <chcl/dataStorage/JSON_Parser.h>
+
+#include <chcl/maths/DynamicMatrix.h>
+#include <chcl/maths/Matrix.h>
+
+namespace
+{
+	using Harness::Measurement;
+
+	/// @brief Fixed seed, so every run benchmarks the same documents
+	constexpr unsigned Seed = 20240611;
+
+	std::string TempPath()
+	{
+		return (std::filesystem::temp_directory_path() / "chcl_benchmark.json").string();
+	}
+
+	/**
+	 * @brief Measures the four JSON_Parser entry points on one document
+	 * @tparam T Type the document is read as
+	 * @param shape Name of the document shape, used as a prefix for each measurement
+	 * @param text Document text
+	 * @param readMembers Reads the members of the document once parsed as a JSON_Object
+	 */
+	template <typename T>
+	void RunShape(const std::string &shape, const std::string &text, std::vector<Measurement> &results,
+		const std::function<void(chcl::JSON_Object&)> &readMembers)
+	{
+		const std::string path = TempPath();
+		{
+			std::ofstream file{ path, std::ios::binary };
+			file << text;
+		}
+
+		results.push_back(Harness::Measure(shape + "/ReadFile", text.size(), [&]()
+		{
+			Harness::DoNotOptimize(chcl::JSON_Parser::ReadFile<T>(path));
+		}));
+
+		results.push_back(Harness::Measure(shape + "/ParseElement", text.size(), [&]()
+		{
+			Harness::DoNotOptimize(chcl::JSON_Parser::ParseElement<T>(text));
+		}));
+
+		const T parsed = chcl::JSON_Parser::ParseElement<T>(text);
+		results.push_back(Harness::Measure(shape + "/SaveToFile", text.size(), [&]()
+		{
+			chcl::JSON_Parser::SaveToFile(path, parsed, chcl::JSON_Writer::Style::Compact);
+		}));
+
+		chcl::JSON_Object container = chcl::JSON_Parser::ParseElement<chcl::JSON_Object>(text);
+		results.push_back(Harness::Measure(shape + "/readElement", text.size(), [&]()
+		{
+			readMembers(container);
+		}));
+
+		std::filesystem::remove(path);
+	}
+
+	/// @brief Appends a random number with a fractional part
+	void AppendReal(std::string &text, std::mt19937 &random)
+	{
+		std::uniform_real_distribution<double> distribution{ -1000.0, 1000.0 };
+		char buffer[32];
+		auto [end, error] = std::to_chars(buffer, buffer + sizeof(buffer), distribution(random));
+		text.append(buffer, end);
+	}
+}
+
+namespace benchmarks
+{
+	namespace json
+	{
+		void all(std::vector<Harness::Measurement> &results)
+		{
+			deepNesting(results);
+			wideObject(results);
+			numericArrays(results);
+			stringHeavy(results);
+			matrices(results);
+		}
+
+		void deepNesting(std::vector<Harness::Measurement> &results)
+		{
+			// Many chains of objects and arrays, each 64 levels deep
+			constexpr size_t ChainCount = 4000;
+			constexpr size_t Depth = 64;
+
+			std::string text = "{\"chains\":[";
+			for (size_t chain = 0; chain < ChainCount; ++chain)
+			{
+				if (chain)
+					text += ',';
+				for (size_t level = 0; level < Depth; ++level)
+					text += level % 2 ? "[" : "{\"next\":";
+				text += std::to_string(chain);
+				for (size_t level = Depth; level-- > 0;)
+					text += level % 2 ? "]" : "}";
+			}
+			text += "]}";
+
+			RunShape<chcl::JSON_Object>("deep", text, results, [](chcl::JSON_Object &object)
+			{
+				Harness::DoNotOptimize(object.readElement<std::vector<chcl::JSON_Object>>("chains"));
+			});
+		}
+
+		void wideObject(std::vector<Harness::Measurement> &results)
+		{
+			// One object with many members of mixed types
+			constexpr size_t MemberCount = 50000;
+
+			std::mt19937 random{ Seed };
+			std::string text = "{";
+			for (size_t member = 0; member < MemberCount; ++member)
+			{
+				if (member)
+					text += ',';
+				text += "\"member_" + std::to_string(member) + "\":";
+				switch (member % 3)
+				{
+					case 0: text += std::to_string(random() % 100000); break;
+					case 1: text += "\"value " + std::to_string(random()) + "\""; break;
+					case 2: text += member % 2 ? "true" : "false"; break;
+				}
+			}
+			text += "}";
+
+			RunShape<chcl::JSON_Object>("wide", text, results, [](chcl::JSON_Object &object)
+			{
+				for (size_t member = 0; member < MemberCount; member += 3)
+					Harness::DoNotOptimize(object.readElement<int>("member_" + std::to_string(member)));
+			});
+		}
+
+		void numericArrays(std::vector<Harness::Measurement> &results)
+		{
+			constexpr size_t Count = 200000;
+
+			std::mt19937 random{ Seed };
+			std::string text = "{\"reals\":[";
+			for (size_t i = 0; i < Count; ++i)
+			{
+				if (i)
+					text += ',';
+				AppendReal(text, random);
+			}
+			text += "],\"integers\":[";
+			for (size_t i = 0; i < Count; ++i)
+			{
+				if (i)
+					text += ',';
+				text += std::to_string(int(random()) / 1000);
+			}
+			text += "]}";
+
+			RunShape<chcl::JSON_Object>("numeric", text, results, [](chcl::JSON_Object &object)
+			{
+				Harness::DoNotOptimize(object.readElement<std::vector<double>>("reals"));
+				Harness::DoNotOptimize(object.readElement<std::vector<int>>("integers"));
+			});
+		}
+
+		void stringHeavy(std::vector<Harness::Measurement> &results)
+		{
+			// Mostly plain text, with some escapes and non-ASCII characters mixed in
+			constexpr size_t Count = 40000;
+			const char *words[] = { "lorem", "ipsum", "dolor", "sit", "amet", "tab\\t", "quote\\\"", "caf\xC3\xA9", "\\u20ac", "line\\n" };
+
+			std::mt19937 random{ Seed };
+			std::string text = "{\"strings\":[";
+			for (size_t i = 0; i < Count; ++i)
+			{
+				if (i)
+					text += ',';
+				text += '\"';
+				size_t wordCount = 4 + random() % 12;
+				for (size_t word = 0; word < wordCount; ++word)
+				{
+					if (word)
+						text += ' ';
+					text += words[random() % std::size(words)];
+				}
+				text += '\"';
+			}
+			text += "]}";
+
+			RunShape<chcl::JSON_Object>("strings", text, results, [](chcl::JSON_Object &object)
+			{
+				Harness::DoNotOptimize(object.readElement<std::vector<std::string>>("strings"));
+			});
+		}
+
+		void matrices(std::vector<Harness::Measurement> &results)
+		{
+			std::mt19937 random{ Seed };
+			std::uniform_real_distribution<float> distribution{ -1.f, 1.f };
+
+			using FixedMatrix = chcl::Matrix<64, 64, float>;
+			FixedMatrix fixed;
+			for (size_t i = 0; i < 64 * 64; ++i)
+				fixed.data()[i] = distribution(random);
+
+			chcl::JSON_Stream fixedStream;
+			fixedStream << fixed;
+			const std::string fixedText = fixedStream.str();
+			RunShape<FixedMatrix>("Matrix<64,64>", fixedText, results, [](chcl::JSON_Object &object)
+			{
+				Harness::DoNotOptimize(object.readElement<std::vector<float>>("values"));
+			});
+
+			std::vector<float> values(512 * 512);
+			for (float &value : values)
+				value = distribution(random);
+			chcl::DynamicMatrix<float> dynamic(512, 512, values);
+
+			chcl::JSON_Stream dynamicStream;
+			dynamicStream << dynamic;
+			const std::string dynamicText = dynamicStream.str();
+			RunShape<chcl::DynamicMatrix<float>>("DynamicMatrix<512x512>", dynamicText, results, [](chcl::JSON_Object &object)
+			{
+				Harness::DoNotOptimize(object.readElement<std::vector<float>>("values"));
+			});
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <vector>
+
+#include "../Harness.h"
+
+namespace benchmarks
+{
+	namespace json
+	{
+		/**
+		 * @brief Runs ReadFile, ParseElement, readElement and SaveToFile over every document shape
+		 */
+		void all(std::vector<Harness::Measurement> &results);
+
+		void deepNesting(std::vector<Harness::Measurement> &results);
+		void wideObject(std::vector<Harness::Measurement> &results);
+		void numericArrays(std::vector<Harness::Measurement> &results);
+		void stringHeavy(std::vector<Harness::Measurement> &results);
+		void matrices(std::vector<Harness::Measurement> &results);
+	}
+}
\ No newline at end of file
@@ -33,6 +33,12 @@
 #include "chcl/dataStorage/JSON_Parser.h"
 #include "chcl/dataStorage/JSON_Integration.h"
 
+#include "tests/BinaryTests.h"
+#include "tests/FileTests.h"
+#include "tests/FormatterTests.h"
+#include "tests/JSONTests.h"
+#include "tests/LoggerTests.h"
+#include "tests/ProfilerTests.h"
 #include "tests/VectorTests.h"
 
 class ConstructionTest
@@ -94,6 +100,12 @@ private:
 int main()
 {
 	testing::vectors::all();
+	testing::binary::all();
+	testing::files::all();
+	testing::json::all();
+	testing::formatter::all();
+	testing::logger::all();
+	testing::profiler::all();
 
 	#if 0
 	chcl::VectorN<2> Vector1(5.f);
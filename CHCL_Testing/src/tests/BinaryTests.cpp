@@ -0,0 +1,278 @@
+#include "BinaryTests.h"
+
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include <chcl/dataStorage/Buffer.h>
+#include <chcl/dataStorage/BinaryLayout.h>
+#include <chcl/dataStorage/BinaryReader.h>
+#include <chcl/dataStorage/NetworkOrder.h>
+#include <chcl/dataStorage/Snapshot_Integration.h>
+
+#include "../Asserts.h"
+
+namespace testing
+{
+	namespace binary
+	{
+		void all()
+		{
+			networkOrder();
+			binaryReader();
+			binaryFileReader();
+			binaryLayout();
+			snapshot();
+		}
+
+		template <typename T>
+		void bulkReversal()
+		{
+			// Every length up to a few 32 byte blocks, so the wide, narrow and scalar tails are all used
+			for (size_t length = 0; length <= 3 * 32 / sizeof(T) + 1; ++length)
+			{
+				std::vector<T> values(length), expected(length);
+				for (size_t i = 0; i < length; ++i)
+				{
+					values[i] = T(0x0102030405060708ull * (i + 1));
+					expected[i] = chcl::NetworkOrder::byteswap(values[i]);
+				}
+				chcl::NetworkOrder::reverseArray(values.data(), values.size());
+				Asserts::Equal(values == expected, true, "Bulk byte reversal did not match single value swaps.\n");
+			}
+
+			// Start that is not on a vector boundary
+			std::vector<T> values(20), expected(20);
+			for (size_t i = 0; i < values.size(); ++i)
+			{
+				values[i] = T(0x1122334455667788ull + i);
+				expected[i] = i ? chcl::NetworkOrder::byteswap(values[i]) : values[i];
+			}
+			chcl::NetworkOrder::reverseArray(values.data() + 1, values.size() - 1);
+			Asserts::Equal(values == expected, true, "Bulk byte reversal from an offset start failed.\n");
+		}
+
+		void networkOrder()
+		{
+			Asserts::Equal(chcl::NetworkOrder::byteswap<uint16_t>(0x1122), (uint16_t)0x2211, "16 bit byteswap failed.\n");
+			Asserts::Equal(chcl::NetworkOrder::byteswap<uint32_t>(0x11223344), (uint32_t)0x44332211, "32 bit byteswap failed.\n");
+			Asserts::Equal(chcl::NetworkOrder::byteswap<uint64_t>(0x1122334455667788), (uint64_t)0x8877665544332211, "64 bit byteswap failed.\n");
+
+			bulkReversal<uint16_t>();
+			bulkReversal<uint32_t>();
+			bulkReversal<uint64_t>();
+		}
+
+		void binaryReader()
+		{
+			const uint8_t bytes[] = { 0x12, 0x34, 0x56, 0x78, 0x01, 0x00, 0x02, 0x00, 0xAA };
+			chcl::Buffer buffer(bytes, sizeof(bytes));
+			chcl::BinaryReader reader(buffer, chcl::Endianness::Big);
+
+			Asserts::Equal(reader.readInt<uint32_t>(), (uint32_t)0x12345678, "BinaryReader big endian read failed.\n");
+
+			uint16_t pair[2];
+			Asserts::Equal(reader.readArray(std::span<uint16_t>(pair), chcl::Endianness::Little), (size_t)2, "BinaryReader array read was short.\n");
+			Asserts::Equal(pair[0] == 1 && pair[1] == 2, true, "BinaryReader little endian array read failed.\n");
+
+			Asserts::Equal(reader.view(1)[0], (uint8_t)0xAA, "BinaryReader view returned the wrong data.\n");
+			Asserts::Equal(reader.eof(), true, "BinaryReader did not reach the end of the buffer.\n");
+
+			reader.seek(2);
+			Asserts::Equal(reader.readInt<uint16_t>(), (uint16_t)0x5678, "BinaryReader seek failed.\n");
+			reader.skip(10);
+			Asserts::Equal((bool)reader, false, "BinaryReader skipping past the end did not fail.\n");
+		}
+
+		void binaryFileReader()
+		{
+			std::vector<uint8_t> bytes(1000);
+			for (size_t i = 0; i < bytes.size(); ++i)
+				bytes[i] = uint8_t(i * 7 + i / 256);
+
+			const std::string filename = (std::filesystem::temp_directory_path() / "chcl_binary_reader_test.bin").string();
+			{
+				std::ofstream file(filename, std::ios::binary);
+				file.write((const char*)bytes.data(), bytes.size());
+			}
+
+			{
+				// Small buffer, so the window is refilled many times
+				chcl::BinaryReader reader(filename, chcl::Endianness::Big, 64);
+				Asserts::Equal((bool)reader, true, "BinaryReader failed to open a file.\n");
+
+				bool matched = true;
+				for (size_t i = 0; i < 100; i += 2)
+					matched &= reader.readInt<uint16_t>() == uint16_t(bytes[i] << 8 | bytes[i + 1]);
+				Asserts::Equal(matched, true, "BinaryReader reads across window refills failed.\n");
+
+				// Bigger than the buffer, so read straight from the file
+				std::vector<uint8_t> direct(300);
+				Asserts::Equal(reader.read(direct.data(), direct.size()), direct.size(), "BinaryReader direct read was short.\n");
+				Asserts::Equal(std::equal(direct.begin(), direct.end(), bytes.begin() + 100), true, "BinaryReader direct read returned the wrong data.\n");
+				Asserts::Equal(reader.tell(), (size_t)400, "BinaryReader position after a direct read was wrong.\n");
+				Asserts::Equal(reader.view(1)[0], bytes[400], "BinaryReader read after a direct read returned the wrong data.\n");
+
+				Asserts::Equal(reader.seek(5), true, "BinaryReader seek before the window failed.\n");
+				Asserts::Equal(reader.readInt<uint8_t>(), bytes[5], "BinaryReader seek before the window read the wrong data.\n");
+				Asserts::Equal(reader.seek(900), true, "BinaryReader seek after the window failed.\n");
+				Asserts::Equal(reader.readInt<uint8_t>(), bytes[900], "BinaryReader seek after the window read the wrong data.\n");
+				reader.skip(94);
+				Asserts::Equal(reader.readInt<uint8_t>(), bytes[995], "BinaryReader skip within the file read the wrong data.\n");
+
+				uint8_t tail[8];
+				Asserts::Equal(reader.read(tail, sizeof(tail)), (size_t)4, "BinaryReader read at the end of the file was not short.\n");
+				Asserts::Equal(reader.eof(), true, "BinaryReader did not reach the end of the file.\n");
+				Asserts::Equal((bool)reader, false, "BinaryReader reading past the end of the file did not fail.\n");
+			}
+
+			{
+				chcl::BinaryReader reader(filename, chcl::Endianness::Big, 64);
+				reader.skip(2000);
+				Asserts::Equal((bool)reader, false, "BinaryReader skipping past the end of the file did not fail.\n");
+				Asserts::Equal(reader.tell(), bytes.size(), "BinaryReader skipping past the end did not stop at the end of the file.\n");
+				Asserts::Equal(reader.eof(), true, "BinaryReader skipping past the end did not reach the end of the file.\n");
+			}
+
+			std::filesystem::remove(filename);
+
+			chcl::BinaryReader missing(filename);
+			Asserts::Equal((bool)missing, false, "BinaryReader opened a missing file.\n");
+		}
+
+		struct TestHeader
+		{
+			uint8_t magic[2];
+			uint32_t length;
+			uint16_t flags;
+			std::array<uint16_t, 2> dims;
+		};
+
+		struct TestSamples
+		{
+			uint8_t tag;
+			uint32_t values[3];
+		};
+
+		enum class TestKind : uint16_t
+		{
+			First = 1, Second = 0x0203
+		};
+
+		struct TestPoint
+		{
+			uint8_t id;
+			TestKind kind;
+			float x;
+			double y;
+			int64_t weight;
+			uint32_t little;
+		};
+
+		void binaryLayout()
+		{
+			using Layout = chcl::BinaryLayout<chcl::Endianness::Big,
+				chcl::Field<&TestHeader::magic>,
+				chcl::Field<&TestHeader::length, chcl::Endianness::Little>,
+				chcl::Field<&TestHeader::flags, chcl::Endianness::Default, 8>,
+				chcl::Field<&TestHeader::dims>
+			>;
+			static_assert(Layout::Size == 14, "Unexpected binary layout size");
+
+			const uint8_t bytes[] = { 'C', 'H', 0x04, 0x03, 0x02, 0x01, 0xFF, 0xFF, 0x12, 0x34, 0x00, 0x01, 0x00, 0x02 };
+			TestHeader header = Layout::decode(bytes);
+
+			Asserts::Equal(header.magic[1], (uint8_t)'H', "BinaryLayout byte array decode failed.\n");
+			Asserts::Equal(header.length, (uint32_t)0x01020304, "BinaryLayout little endian field decode failed.\n");
+			Asserts::Equal(header.flags, (uint16_t)0x1234, "BinaryLayout explicit offset field decode failed.\n");
+			Asserts::Equal(header.dims[1], (uint16_t)2, "BinaryLayout integer array decode failed.\n");
+
+			uint8_t encoded[sizeof(bytes)] = {};
+			Layout::encode(header, encoded);
+			encoded[6] = encoded[7] = 0xFF;
+			Asserts::Equal(std::memcmp(encoded, bytes, sizeof(bytes)), 0, "BinaryLayout encode did not round trip.\n");
+
+			// Packed after a single byte, so the swapped array is not aligned in the encoded data
+			using SampleLayout = chcl::BinaryLayout<chcl::Endianness::Big,
+				chcl::Field<&TestSamples::tag>,
+				chcl::Field<&TestSamples::values>
+			>;
+			const uint8_t sampleBytes[] = { 7, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C };
+			uint8_t encodedSamples[sizeof(sampleBytes)] = {};
+			SampleLayout::encode(TestSamples{ 7, { 0x01020304, 0x05060708, 0x090A0B0C } }, encodedSamples);
+			Asserts::Equal(std::memcmp(encodedSamples, sampleBytes, sizeof(sampleBytes)), 0, "BinaryLayout unaligned array encode failed.\n");
+			Asserts::Equal(SampleLayout::decode(encodedSamples).values[2], (uint32_t)0x090A0B0C, "BinaryLayout unaligned array decode failed.\n");
+
+			// More records than one block of the array decoder, with swapped, unswapped and single byte fields
+			using PointLayout = chcl::BinaryLayout<chcl::Endianness::Big,
+				chcl::Field<&TestPoint::id>,
+				chcl::Field<&TestPoint::kind>,
+				chcl::Field<&TestPoint::x>,
+				chcl::Field<&TestPoint::y>,
+				chcl::Field<&TestPoint::weight>,
+				chcl::Field<&TestPoint::little, chcl::Endianness::Little>
+			>;
+			static_assert(PointLayout::Size == 27, "Unexpected binary layout size");
+
+			const size_t pointCount = 2 * PointLayout::ArrayBlock + 3;
+			std::vector<TestPoint> points(pointCount);
+			for (size_t i = 0; i < pointCount; ++i)
+				points[i] = { uint8_t(i), i % 2 ? TestKind::Second : TestKind::First, float(i) * 0.5f, -double(i) / 3.0, int64_t(i) * -0x10000000001, uint32_t(i * 0x01010101) };
+
+			std::vector<uint8_t> encodedPoints(pointCount * PointLayout::Size);
+			PointLayout::encodeArray(points.data(), pointCount, encodedPoints.data());
+			std::vector<TestPoint> decodedPoints(pointCount);
+			PointLayout::decodeArray(encodedPoints.data(), decodedPoints.data(), pointCount);
+
+			bool matched = true;
+			for (size_t i = 0; i < pointCount; ++i)
+			{
+				const TestPoint &a = points[i], &b = decodedPoints[i];
+				matched &= a.id == b.id && a.kind == b.kind && a.x == b.x && a.y == b.y && a.weight == b.weight && a.little == b.little;
+			}
+			Asserts::Equal(matched, true, "BinaryLayout array decode did not match the records encoded.\n");
+		}
+
+		void snapshot()
+		{
+			std::vector<chcl::Matrix<2, 2, float>> mats(3, chcl::Matrix<2, 2, float>({ 1.f, 2.f, 3.f, 4.f }));
+			mats[2].at(1, 1) = 8.f;
+
+			chcl::Buffer buffer;
+			chcl::Snapshot::Write(buffer, std::span<const chcl::Matrix<2, 2, float>>(mats));
+
+			chcl::Snapshot::View view(buffer);
+			Asserts::Equal((bool)view, true, "Snapshot header was not valid.\n");
+
+			auto viewed = chcl::Snapshot::ViewMatrices<2, 2, float>(view);
+			Asserts::Equal(viewed.size(), (size_t)3, "Snapshot matrix view had the wrong size.\n");
+			Asserts::Equal(viewed[2].at(1, 1), 8.f, "Snapshot matrix view had the wrong values.\n");
+			Asserts::Equal(chcl::Snapshot::ViewMatrices<4, 1, float>(view).empty(), true, "Snapshot matrix view ignored the stored shape.\n");
+
+			chcl::DynamicMatrix<float> read;
+			Asserts::Equal(chcl::Snapshot::Read(view, read, 2), true, "Snapshot dynamic matrix read failed.\n");
+			Asserts::Equal(read.at(1, 0), 3.f, "Snapshot dynamic matrix read had the wrong values.\n");
+
+			// Dynamic matrices are appended one after another behind a single header
+			std::vector<chcl::DynamicMatrix<float>> dynamicMats;
+			for (const auto &mat : mats)
+				dynamicMats.emplace_back(2, 2, mat.data());
+			chcl::Buffer dynamicBuffer;
+			Asserts::Equal(chcl::Snapshot::Write(dynamicBuffer, std::span<const chcl::DynamicMatrix<float>>(dynamicMats)), true, "Snapshot dynamic matrix array write failed.\n");
+			Asserts::Equal(dynamicBuffer.size(), buffer.size(), "Snapshot dynamic matrix array had the wrong size.\n");
+			Asserts::Equal(std::memcmp(dynamicBuffer.data(), buffer.data(), buffer.size()), 0, "Snapshot dynamic matrix array did not match the fixed size matrices.\n");
+
+			dynamicMats.emplace_back(3, 2);
+			chcl::Buffer mismatched;
+			Asserts::Equal(chcl::Snapshot::Write(mismatched, std::span<const chcl::DynamicMatrix<float>>(dynamicMats)), false, "Snapshot wrote dynamic matrices of different shapes.\n");
+			Asserts::Equal(mismatched.size(), size_t(0), "Snapshot wrote part of a dynamic matrix array it rejected.\n");
+
+			std::vector<uint8_t> bytes((const uint8_t*)buffer.data(), (const uint8_t*)buffer.data() + buffer.size());
+			for (uint16_t version : { uint16_t(0), uint16_t(chcl::Snapshot::Version + 1) })
+			{
+				std::memcpy(bytes.data() + offsetof(chcl::Snapshot::Header, version), &version, sizeof(version));
+				Asserts::Equal((bool)chcl::Snapshot::View(bytes.data(), bytes.size()), false, "Snapshot with an unknown version was accepted.\n");
+			}
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,15 @@
+#pragma once
+
+namespace testing
+{
+	namespace binary
+	{
+		void all();
+
+		void networkOrder();
+		void binaryReader();
+		void binaryFileReader();
+		void binaryLayout();
+		void snapshot();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,80 @@
+#include "FileTests.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <chcl/files/AsyncFileReader.h>
+
+#include "../Asserts.h"
+
+namespace testing
+{
+	namespace files
+	{
+		void all()
+		{
+			asyncFileReader();
+		}
+
+		/// @brief Reads a whole file, checking the chunks arrive in order and match what was written
+		void readBack(const std::string &filename, const std::vector<uint8_t> &bytes, size_t chunkSize, bool allowIoUring)
+		{
+			chcl::AsyncFileReader reader(filename, chunkSize, 3, allowIoUring);
+			Asserts::Equal((bool)reader, true, "AsyncFileReader failed to open a file.\n");
+			Asserts::Equal(reader.fileSize(), bytes.size(), "AsyncFileReader reported the wrong file size.\n");
+			if (!allowIoUring)
+				Asserts::Equal(reader.usingIoUring(), false, "AsyncFileReader used io_uring when it was not allowed.\n");
+
+			std::vector<uint8_t> read;
+			bool ordered = true;
+			size_t chunkCount = 0;
+			bool complete = reader.readAll([&](const chcl::AsyncFileReader::Chunk &chunk)
+			{
+				ordered &= chunk.offset == read.size() && chunk.data.size() <= chunkSize;
+				read.insert(read.end(), (const uint8_t*)chunk.data.data(), (const uint8_t*)chunk.data.data() + chunk.data.size());
+				++chunkCount;
+			});
+
+			Asserts::Equal(complete, true, "AsyncFileReader failed to read a whole file.\n");
+			Asserts::Equal(ordered, true, "AsyncFileReader delivered chunks out of order.\n");
+			Asserts::Equal(chunkCount, (bytes.size() + chunkSize - 1) / chunkSize, "AsyncFileReader delivered the wrong number of chunks.\n");
+			Asserts::Equal(read == bytes, true, "AsyncFileReader chunks did not match the file.\n");
+		}
+
+		void asyncFileReader()
+		{
+			const std::string filename = (std::filesystem::temp_directory_path() / "chcl_async_reader_test.bin").string();
+			constexpr size_t ChunkSize = 1024;
+
+			// Empty, shorter than a chunk, a whole number of chunks, and a partial last chunk
+			for (size_t size : { size_t(0), size_t(100), 8 * ChunkSize, 10 * ChunkSize + 123 })
+			{
+				std::vector<uint8_t> bytes(size);
+				for (size_t i = 0; i < size; ++i)
+					bytes[i] = uint8_t(i * 13 + i / ChunkSize);
+
+				{
+					std::ofstream file(filename, std::ios::binary);
+					file.write((const char*)bytes.data(), bytes.size());
+				}
+
+				readBack(filename, bytes, ChunkSize, true);
+				readBack(filename, bytes, ChunkSize, false);
+			}
+
+			std::filesystem::remove(filename);
+
+			for (bool allowIoUring : { true, false })
+			{
+				chcl::AsyncFileReader missing(filename, ChunkSize, 3, allowIoUring);
+				chcl::AsyncFileReader::Chunk chunk;
+				Asserts::Equal((bool)missing, false, "AsyncFileReader opened a missing file.\n");
+				Asserts::Equal(missing.next(chunk), false, "AsyncFileReader returned a chunk of a missing file.\n");
+				Asserts::Equal(missing.failed(), true, "AsyncFileReader reading a missing file did not fail.\n");
+			}
+		}
+	}
+}
\ No newline at end of file
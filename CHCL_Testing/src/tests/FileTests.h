@@ -0,0 +1,11 @@
+#pragma once
+
+namespace testing
+{
+	namespace files
+	{
+		void all();
+
+		void asyncFileReader();
+	}
+}
\ No newline at end of file
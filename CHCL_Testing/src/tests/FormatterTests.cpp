@@ -0,0 +1,147 @@
+#include "FormatterTests.h"
+
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <string_view>
+
+#include <chcl/Formatter.h>
+#include <chcl/dataStorage/Buffer.h>
+
+#include "../Asserts.h"
+
+namespace testing
+{
+	namespace formatter
+	{
+		/// @brief Checks a compile time format string gives the same text as parsing it at runtime
+		template <chcl::FormatString formatString, typename ...Ts>
+		void sameAtRuntime(const std::string &expected, const Ts &...args)
+		{
+			using chcl::Formatter;
+
+			std::string compiled = Formatter::Format<formatString>(args...);
+			Asserts::Equal(compiled, expected, "Compile time formatting gave the wrong text.\n");
+			Asserts::Equal(Formatter::Format(std::string(formatString.view()), args...), compiled, "Runtime formatting differed from compile time formatting.\n");
+		}
+
+		/// @brief Checks every destination gets the same text, and that FormattedSize matches its length
+		template <chcl::FormatString formatString, typename ...Ts>
+		void sameEverywhere(const Ts &...args)
+		{
+			using chcl::Formatter;
+
+			const std::string expected = Formatter::Format<formatString>(args...);
+			const std::string_view format = formatString.view();
+
+			Asserts::Equal(Formatter::FormattedSize<formatString>(args...), expected.size(), "Compile time formatted size did not match the text.\n");
+			Asserts::Equal(Formatter::FormattedSize(format, args...), expected.size(), "Runtime formatted size did not match the text.\n");
+
+			std::string text(expected.size() + 1, '#');
+			char *end = Formatter::FormatTo<formatString>(text.data(), args...);
+			Asserts::Equal(std::string(text.data(), end), expected, "Compile time formatting to an iterator failed.\n");
+			Asserts::Equal(text.back(), '#', "Compile time formatting wrote past its formatted size.\n");
+			end = Formatter::FormatTo(text.data(), format, args...);
+			Asserts::Equal(std::string(text.data(), end), expected, "Runtime formatting to an iterator failed.\n");
+
+			std::string appended = "> ";
+			Formatter::FormatTo<formatString>(std::back_inserter(appended), args...);
+			Formatter::FormatTo(std::back_inserter(appended), format, args...);
+			Asserts::Equal(appended, "> " + expected + expected, "Formatting to an output iterator failed.\n");
+
+			chcl::Buffer buffer;
+			buffer.append('>');
+			Formatter::FormatTo<formatString>(buffer, args...);
+			Formatter::FormatTo(buffer, format, args...);
+			Asserts::Equal(std::string(static_cast<const char*>(buffer.data()), buffer.size()), ">" + expected + expected, "Formatting to a buffer failed.\n");
+		}
+
+		void all()
+		{
+			integers();
+			floats();
+			destinations();
+			parity();
+			malformed();
+			sizes();
+		}
+
+		void integers()
+		{
+			using chcl::Formatter;
+
+			Asserts::Equal(Formatter::Format<"{0} {1} {2}">(0, 1234567890, -4096), std::string("0 1234567890 -4096"), "Decimal integer formatting failed.\n");
+			Asserts::Equal(Formatter::Format<"{0}">(std::numeric_limits<int64_t>::min()), std::string("-9223372036854775808"), "Formatting the most negative integer failed.\n");
+			Asserts::Equal(Formatter::Format<"{0:6}">(42), std::string("    42"), "Integer width failed.\n");
+
+			Asserts::Equal(Formatter::Format<"{0:x} {1:x}">(0xbeef, 0), std::string("0xbeef 0"), "Hexadecimal formatting failed.\n");
+			Asserts::Equal(Formatter::Format<"{0:4x}">(uint8_t(5)), std::string("0x05"), "Hexadecimal padding failed.\n");
+			Asserts::Equal(Formatter::Format<"{0:x}">(-1), std::string("0xffffffff"), "Negative hexadecimal formatting failed.\n");
+
+			Asserts::Equal(Formatter::Format<"{0:b}">(uint8_t(0xA5)), std::string("10100101"), "Binary formatting failed.\n");
+			Asserts::Equal(Formatter::Format<"{0:b}">(int16_t(-2)), std::string("1111111111111110"), "Negative binary formatting failed.\n");
+		}
+
+		void floats()
+		{
+			using chcl::Formatter;
+
+			Asserts::Equal(Formatter::Format<"{0} {1}">(0.1, 1e21), std::string("0.1 1e+21"), "Shortest float formatting failed.\n");
+			Asserts::Equal(Formatter::Format<"{0}">(1.0 / 3.0), std::string("0.3333333333333333"), "Round trip float formatting failed.\n");
+			Asserts::Equal(Formatter::Format<"{0:.3f} {1:.2e}">(2.5, 12345.0), std::string("2.500 1.23e+04"), "Float precision failed.\n");
+			Asserts::Equal(Formatter::Format<"{0:8.2f}">(-3.14159), std::string("   -3.14"), "Float width failed.\n");
+		}
+
+		void destinations()
+		{
+			using chcl::Formatter;
+
+			char text[32];
+			char *end = Formatter::FormatTo(text, "{0}-{1:x}", 12, 255);
+			Asserts::Equal(std::string(text, end), std::string("12-0xff"), "Formatting to an iterator failed.\n");
+			Asserts::Equal(Formatter::FormattedSize("{0}-{1:x}", 12, 255), size_t(7), "Formatted size did not match the text written.\n");
+
+			chcl::Buffer buffer;
+			Formatter::FormatTo<"{0:b}|">(buffer, uint8_t(3));
+			Formatter::FormatTo(buffer, "{0:5}", "ab");
+			Asserts::Equal(std::string(static_cast<const char*>(buffer.data()), buffer.size()), std::string("00000011|   ab"), "Formatting to a buffer failed.\n");
+		}
+
+		void parity()
+		{
+			sameAtRuntime<"{0}, {1:x}, {2:b}">("-7, 0x2a, 00000101", -7, 42, uint8_t(5));
+			sameAtRuntime<"{1} before {0}">("b before a", "a", "b");
+			sameAtRuntime<"{} {} {}">("1 2.5 three", 1, 2.5, "three");
+			sameAtRuntime<"[{0:6}] [{1:8.3f}] [{2:.1e}]">("[    42] [  -1.500] [1.2e+03]", 42, -1.5, 1234.0);
+			sameAtRuntime<"{0}{0}{0}">("xxx", "x");
+			sameAtRuntime<"no fields">("no fields", 1);
+			sameAtRuntime<"">("");
+		}
+
+		void malformed()
+		{
+			// Braces that do not form a field are written as they are
+			sameAtRuntime<"{">("{", 1);
+			sameAtRuntime<"}">("}", 1);
+			sameAtRuntime<"a{b">("a{b", 1);
+			sameAtRuntime<"{0">("{0", 1);
+			sameAtRuntime<"{x}">("{x}", 1);
+			sameAtRuntime<"{ 0}">("{ 0}", 1);
+			sameAtRuntime<"{{0}}">("{7}", 7);
+			sameAtRuntime<"}{0}{">("}7{", 7);
+		}
+
+		void sizes()
+		{
+			sameEverywhere<"{0} {1} {2}">(0, std::numeric_limits<int64_t>::min(), std::numeric_limits<uint64_t>::max());
+			sameEverywhere<"{0:x}|{1:10x}|{2:b}">(0xbeef, -1, int16_t(-2));
+			sameEverywhere<"{0} {1:.3f} {2:12.2e} {3}">(0.1, 2.5, -12345.0, 1.0 / 3.0);
+			sameEverywhere<"{0:5}|{1}|{2:3}">("ab", "", "longer than the width");
+			// Padding wider than the buffer fills in one go
+			sameEverywhere<"[{0:100}] [{1:80.1f}]">(7, 1.5);
+			sameEverywhere<"{} and {}, {x} {">(1, "two");
+			sameEverywhere<"">();
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,16 @@
+#pragma once
+
+namespace testing
+{
+	namespace formatter
+	{
+		void all();
+
+		void integers();
+		void floats();
+		void destinations();
+		void parity();
+		void malformed();
+		void sizes();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,694 @@
+#include "JSONTests.h"
+
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <chcl/dataStorage/JSON_Binary.h>
+#include <chcl/dataStorage/JSON_Binding.h>
+#include <chcl/dataStorage/JSON_Document.h>
+#include <chcl/dataStorage/JSON_Integration.h>
+#include <chcl/dataStorage/JSON_LineReader.h>
+#include <chcl/dataStorage/JSON_Parser.h>
+#include <chcl/dataStorage/JSON_Path.h>
+#include <chcl/dataStorage/JSON_Reader.h>
+#include <chcl/dataStorage/JSON_Scanner.h>
+#include <chcl/dataStorage/JSON_Strings.h>
+#include <chcl/dataStorage/JSON_Writer.h>
+#include <chcl/dataStorage/JSON_Tape.h>
+
+#include "../Asserts.h"
+
+namespace
+{
+	struct Position
+	{
+		double x = 0.0;
+		double y = 0.0;
+	};
+
+	struct Message
+	{
+		int id = 0;
+		std::string text;
+		Position position;
+		std::vector<int> tags;
+	};
+}
+
+template <> struct chcl::JSON_BindingOf<Position> : chcl::JSON_Binding<chcl::JSON_Field<"x", &Position::x>, chcl::JSON_Field<"y", &Position::y>> {};
+template <> struct chcl::JSON_BindingOf<Message> : chcl::JSON_Binding<
+	chcl::JSON_Field<"id", &Message::id>,
+	chcl::JSON_Field<"text", &Message::text>,
+	chcl::JSON_Field<"position", &Message::position>,
+	chcl::JSON_Field<"tags", &Message::tags>> {};
+
+namespace testing
+{
+	namespace json
+	{
+		void all()
+		{
+			tape();
+			scanner();
+			objectView();
+			reader();
+			writer();
+			numbers();
+			binding();
+			lineReader();
+			binary();
+			document();
+			path();
+			strings();
+		}
+
+		void tape()
+		{
+			chcl::JSON_Tape tape{ "{ \"a\": [ 1, { \"b\": 2 }, ], \"c\\\"\": null }" };
+			Asserts::Equal(tape.valid(), true, "JSON tape rejected a valid document.\n");
+			Asserts::Equal(tape[0].count, (uint32_t)2, "JSON tape counted the wrong number of members.\n");
+			Asserts::Equal(tape[2].count, (uint32_t)2, "JSON tape counted the wrong number of elements.\n");
+			Asserts::Equal(tape[tape.findMember(0, "c\"")].type, chcl::JSON_Type::Null, "JSON tape escaped member lookup failed.\n");
+			Asserts::Equal(chcl::JSON_Tape{ "[ 1, 2" }.valid(), false, "JSON tape accepted an unterminated array.\n");
+
+			auto object = chcl::JSON_Parser::ParseElement<chcl::JSON_Object>("{ \"name\": \"tape\", \"nums\": [ 3, 4 ], \"sub\": { \"flag\": true } }");
+			Asserts::Equal(object.readElement<std::string>("name"), std::string("tape"), "JSON object string read failed.\n");
+			Asserts::Equal(object.readElement<std::vector<int>>("nums") == std::vector<int>{ 3, 4 }, true, "JSON object array read failed.\n");
+			Asserts::Equal(object.readElement<chcl::JSON_Object>("sub").readElement<bool>("flag"), true, "JSON nested object read failed.\n");
+		}
+
+		/// @brief Structural positions found one character at a time, to check JSON_Scanner against
+		std::vector<size_t> ReferenceStructurals(std::string_view text)
+		{
+			std::vector<size_t> positions;
+			bool inString = false, escaped = false, inToken = false;
+			for (size_t i = 0; i < text.length(); ++i)
+			{
+				const char c = text[i];
+				if (inString)
+				{
+					if (escaped)
+						escaped = false;
+					else if (c == '\\')
+						escaped = true;
+					else if (c == '\"')
+					{
+						positions.push_back(i);
+						inString = false;
+					}
+					continue;
+				}
+
+				const bool op = c == '{' || c == '}' || c == '[' || c == ']' || c == ':' || c == ',';
+				const bool whitespace = c == ' ' || c == '\t' || c == '\n' || c == '\r';
+				if (c == '\"' || op)
+					positions.push_back(i);
+				else if (!whitespace && !inToken)
+					positions.push_back(i);
+
+				inString = c == '\"';
+				inToken = !(c == '\"' || op || whitespace);
+			}
+			return positions;
+		}
+
+		/// @brief Checks a document's structurals and string against the reference, through the scanner and the tape
+		void scanString(const std::string &content)
+		{
+			std::string text = "[\"";
+			for (char c : content)
+			{
+				if (c == '\"' || c == '\\')
+					text += '\\';
+				text += c;
+			}
+			text += "\", 12, true]";
+
+			chcl::JSON_Scanner scanner{ text };
+			std::vector<size_t> positions;
+			for (size_t position; (position = scanner.next()) != chcl::JSON_Scanner::npos;)
+				positions.push_back(position);
+			Asserts::Equal(positions == ReferenceStructurals(text), true, "JSON scanner found the wrong structural characters.\n");
+			Asserts::Equal(scanner.unterminatedString(), false, "JSON scanner ended inside a string.\n");
+
+			chcl::JSON_Tape tape{ text };
+			std::string read;
+			Asserts::Equal(tape.valid() && tape[0].count == 3 && tape.readString(1, read), true, "JSON tape rejected a string with escapes.\n");
+			Asserts::Equal(read, content, "JSON tape read back the wrong string.\n");
+		}
+
+		void scanner()
+		{
+			// Odd runs escape the quote after them and even runs do not, with the runs ending either side of a block boundary.
+			// The text starts with [" so a run of backslashes in the content ends at byte 2 + prefix + 2 * length - 1
+			for (size_t prefix = 50; prefix < 64; ++prefix)
+			{
+				for (size_t length = 1; length <= 4; ++length)
+				{
+					scanString(std::string(prefix, 'x') + std::string(length, '\\'));
+					scanString(std::string(prefix, 'x') + std::string(length, '\\') + '\"' + "y");
+					scanString(std::string(prefix, 'x') + '\"' + std::string(length, '\\') + "]:,");
+				}
+			}
+
+			// A string spanning several blocks, with escapes and structural characters inside it
+			std::string content;
+			for (size_t i = 0; i < 300; ++i)
+				content += "{}[]:, \"\\x"[i % 10];
+			scanString(content);
+
+			// Partial final blocks and tokens running to the end of the text
+			for (size_t length = 60; length < 70; ++length)
+			{
+				const std::string text = "[" + std::string(length, '1') + ",truex]";
+				chcl::JSON_Scanner scanner{ text };
+				std::vector<size_t> positions;
+				for (size_t position; (position = scanner.next()) != chcl::JSON_Scanner::npos;)
+					positions.push_back(position);
+				Asserts::Equal(positions == ReferenceStructurals(text), true, "JSON scanner split a token at a block boundary.\n");
+			}
+		}
+
+		void objectView()
+		{
+			const std::string message = "{ \"id\": 7, \"tags\": [ \"a\", \"b\" ], \"inner\": { \"x\": 1.5 } }";
+			chcl::JSON_ObjectView view = chcl::JSON_Parser::ParseView(message);
+
+			Asserts::Equal(view.size(), (size_t)3, "JSON object view had the wrong size.\n");
+			Asserts::Equal(view.rawElement("tags").data() >= message.data() && view.rawElement("tags").data() < message.data() + message.size(), true, "JSON object view copied its source.\n");
+			Asserts::Equal(view.readElement<int>("id"), 7, "JSON object view number read failed.\n");
+			Asserts::Equal(view.readElement<chcl::JSON_ObjectView>("inner").readElement<float>("x"), 1.5f, "JSON nested object view read failed.\n");
+			Asserts::Equal(view.contains("missing"), false, "JSON object view found a missing label.\n");
+		}
+
+		void reader()
+		{
+			struct SumVisitor : chcl::JSON_Visitor
+			{
+				using chcl::JSON_Visitor::value;
+
+				size_t keys = 0;
+				double sum = 0.0;
+
+				void key(std::string_view) { ++keys; }
+				void value(int64_t number) { sum += (double)number; }
+				void value(double number) { sum += number; }
+			};
+
+			// A tiny chunk size forces every token to span chunk boundaries
+			std::istringstream input{ "{ \"values\": [ 10, 2.5, -4 ], \"label\": \"long \\\"quoted\\\" text\" }" };
+			chcl::JSON_Reader reader{ input, 3 };
+
+			chcl::JSON_Event event;
+			Asserts::Equal(reader.next(event) && event == chcl::JSON_Event::StartObject, true, "JSON reader missed the start of the object.\n");
+			Asserts::Equal(reader.next(event) && reader.text() == "values", true, "JSON reader key read failed.\n");
+
+			SumVisitor visitor;
+			Asserts::Equal(reader.visit(visitor), true, "JSON reader rejected a valid document.\n");
+			Asserts::Equal(visitor.sum, 8.5, "JSON reader passed the wrong numbers to the visitor.\n");
+			Asserts::Equal(visitor.keys, (size_t)1, "JSON reader passed the wrong keys to the visitor.\n");
+		}
+
+		void writer()
+		{
+			const std::vector<double> values{ 0.1, 2.0, -3.5 };
+
+			std::string compact;
+			{
+				chcl::JSON_Writer writer{ std::back_inserter(compact), chcl::JSON_Writer::Style::Compact };
+				writer.beginObject();
+				writer.key("values").values(values.data(), values.size());
+				writer.key("text").value("a\"b");
+				writer.endObject();
+			}
+			Asserts::Equal(compact, std::string("{\"values\":[0.1,2,-3.5],\"text\":\"a\\\"b\"}"), "JSON compact writer output was wrong.\n");
+
+			chcl::Buffer pretty;
+			{
+				chcl::JSON_Writer writer{ pretty };
+				writer.beginObject();
+				writer.key("nums") << std::vector<int>{ 1, 2 };
+				writer.endObject();
+			}
+			Asserts::Equal(std::string((const char*)pretty.data(), pretty.size()), std::string("{\n\t\"nums\": [ 1, 2 ]\n}"), "JSON pretty writer output was wrong.\n");
+
+			// Plain values written before the first container move onto their own lines, as in JSON_Stream
+			chcl::Buffer mixed;
+			{
+				chcl::JSON_Writer writer{ mixed };
+				chcl::JSON_Tape tape{ std::string("[1,\"a, [b\",[2],{\"c\":3}]") };
+				writer.element(tape);
+			}
+			Asserts::Equal(std::string((const char*)mixed.data(), mixed.size()), std::string("[\n\t1,\n\t\"a, [b\",\n\t[ 2 ],\n\t{\n\t\t\"c\": 3\n\t}\n]"),
+				"JSON pretty writer mixed array layout was wrong.\n");
+
+			// Long enough that the iterator writer has to hold the single line elements back
+			std::string streamed;
+			chcl::Buffer buffered;
+			auto writeLong = [](chcl::JSON_Writer &writer)
+			{
+				writer.beginArray();
+				for (int i = 0; i < 2000; ++i)
+					writer.value(i);
+				writer.beginObject().key("end").value(true).endObject();
+				writer.endArray();
+			};
+			{
+				chcl::JSON_Writer iteratorWriter{ std::back_inserter(streamed) }, bufferWriter{ buffered };
+				writeLong(iteratorWriter);
+				writeLong(bufferWriter);
+			}
+			Asserts::Equal(streamed, std::string((const char*)buffered.data(), buffered.size()), "JSON pretty writer iterator and buffer output differed.\n");
+			Asserts::Equal(streamed.compare(0, 9, "[\n\t0,\n\t1,"), 0, "JSON pretty writer long mixed array layout was wrong.\n");
+
+			// Keys outside of an object are ignored, and compact raw values lose their layout but not their strings
+			std::string guarded;
+			{
+				chcl::JSON_Writer writer{ std::back_inserter(guarded), chcl::JSON_Writer::Style::Compact };
+				writer.key("top").beginArray().key("inArray").value(1);
+				writer.rawValue("{\n\t\"a b\": [ 1, 2 ],\r\n\t\"c\": \"\\\" x \"\n}").endArray();
+			}
+			Asserts::Equal(guarded, std::string("[1,{\"a b\":[1,2],\"c\":\"\\\" x \"}]"), "JSON writer wrote a misplaced key or raw whitespace.\n");
+		}
+
+		/// @brief Reads a document into an existing value, as JSON_Parser::ParseElement does into a new one
+		template <typename T>
+		void readInto(const std::string &text, T &target)
+		{
+			chcl::JSON_Stream stream{ std::make_shared<const chcl::JSON_Tape>(text), 0 };
+			stream >> target;
+		}
+
+		void numbers()
+		{
+			using chcl::JSON_Tape;
+			auto parse = [](std::string_view text, auto &out) { return JSON_Tape::ParseNumber(text.data(), text.data() + text.length(), out); };
+
+			int integer = 0;
+			uint16_t small = 0;
+			uint64_t large = 0;
+			int64_t signedLarge = 0;
+			double real = 0.0;
+			Asserts::Equal(parse("-42", integer) && integer == -42, true, "JSON integer parse failed.\n");
+			Asserts::Equal(parse("3.0", integer) && integer == 3, true, "JSON integer parse from floating point form failed.\n");
+			Asserts::Equal(parse("1e3", integer) && integer == 1000, true, "JSON integer parse from an exponent failed.\n");
+			Asserts::Equal(parse("1e19", large) && large == 10000000000000000000ull, true, "JSON large integer parse from an exponent failed.\n");
+			Asserts::Equal(parse("70000", small), false, "JSON integer parse accepted a value out of range.\n");
+			Asserts::Equal(parse("-1", large), false, "JSON unsigned parse accepted a negative value.\n");
+			Asserts::Equal(parse("1e30", signedLarge) || parse("1e5", small), false, "JSON integer parse accepted an exponent out of range.\n");
+			Asserts::Equal(parse("1x", integer), false, "JSON number parse accepted trailing text.\n");
+			Asserts::Equal(parse("0.1", real) && real == 0.1, true, "JSON floating point parse failed.\n");
+
+			// Shortest text that reads back to the same value
+			std::string written;
+			{
+				chcl::JSON_Writer writer{ std::back_inserter(written), chcl::JSON_Writer::Style::Compact };
+				writer.beginArray();
+				writer.value(0.1).value(0.1f).value(1e300).value(std::numeric_limits<int64_t>::min()).value(std::numeric_limits<uint64_t>::max());
+				writer.endArray();
+			}
+			Asserts::Equal(written, std::string("[0.1,0.1,1e+300,-9223372036854775808,18446744073709551615]"), "JSON number writing failed.\n");
+
+			JSON_Tape tape{ written };
+			double reals[3];
+			Asserts::Equal(tape.readNumbers(0, reals, 3), false, "JSON readNumbers accepted the wrong count.\n");
+			JSON_Tape realTape{ std::string("[0.1,1e+300,-2.5]") };
+			Asserts::Equal(realTape.readNumbers(0, reals, 3) && reals[0] == 0.1 && reals[1] == 1e300 && reals[2] == -2.5, true, "JSON readNumbers failed.\n");
+			Asserts::Equal(JSON_Tape{ std::string("[1,\"2\",3]") }.readNumbers(0, reals, 3), false, "JSON readNumbers accepted a string element.\n");
+			Asserts::Equal(JSON_Tape{ std::string("{\"a\":1}") }.readNumbers(0, reals, 1), false, "JSON readNumbers accepted an object.\n");
+
+			chcl::DynamicMatrix<float> matrix(1, 1, 5.f);
+			readInto("{ \"rows\": 2, \"cols\": 2, \"values\": [ 1, 2, 3 ] }", matrix);
+			Asserts::Equal(matrix.rows() == 1 && matrix.at(0, 0) == 5.f, true, "JSON matrix read accepted the wrong number of values.\n");
+			readInto("{ \"rows\": 4294967296, \"cols\": 4294967296, \"values\": [] }", matrix);
+			Asserts::Equal(matrix.rows() == 1 && matrix.at(0, 0) == 5.f, true, "JSON matrix read accepted an overflowing size.\n");
+			readInto("{ \"rows\": 100000000000, \"cols\": 1, \"values\": [ 1 ] }", matrix);
+			Asserts::Equal(matrix.rows() == 1 && matrix.at(0, 0) == 5.f, true, "JSON matrix read accepted a huge size.\n");
+			readInto("{ \"rows\": 1, \"cols\": 2, \"values\": [ 1, 2 ] }", matrix);
+			Asserts::Equal(matrix.cols() == 2 && matrix.at(0, 1) == 2.f, true, "JSON matrix read failed.\n");
+
+			chcl::DynamicVector<int> vector(1, 7);
+			readInto("{ \"size\": 1e15, \"components\": [ 1 ] }", vector);
+			Asserts::Equal(vector.size() == 1 && vector[0] == 7, true, "JSON vector read accepted a huge size.\n");
+			readInto("{ \"size\": 2, \"components\": [ 1, \"2\" ] }", vector);
+			Asserts::Equal(vector.size() == 1 && vector[0] == 7, true, "JSON vector read accepted a string element.\n");
+			readInto("{ \"size\": 2, \"components\": [ 1, 2 ] }", vector);
+			Asserts::Equal(vector.size() == 2 && vector[1] == 2, true, "JSON vector read failed.\n");
+		}
+
+		void binding()
+		{
+			Message message = chcl::JSON_Parser::ParseElement<Message>("{ \"unknown\": [ {} ], \"text\": \"hi\", \"id\": 7, \"position\": { \"y\": 2.5 }, \"tags\": [ 1, 2 ] }");
+			Asserts::Equal(message.id, 7, "JSON binding number read failed.\n");
+			Asserts::Equal(message.text, std::string("hi"), "JSON binding string read failed.\n");
+			Asserts::Equal(message.position.y, 2.5, "JSON binding nested read failed.\n");
+			Asserts::Equal(message.tags == std::vector<int>{ 1, 2 }, true, "JSON binding array read failed.\n");
+
+			std::string compact;
+			{
+				chcl::JSON_Writer writer{ std::back_inserter(compact), chcl::JSON_Writer::Style::Compact };
+				writer << message;
+			}
+			Asserts::Equal(compact, std::string("{\"id\":7,\"text\":\"hi\",\"position\":{\"x\":0,\"y\":2.5},\"tags\":[1,2]}"), "JSON binding writer output was wrong.\n");
+
+			chcl::JSON_Stream stream;
+			stream << message;
+			Message reread = chcl::JSON_Parser::ParseElement<Message>(stream.str());
+			Asserts::Equal(reread.position.y, 2.5, "JSON binding stream round trip failed.\n");
+		}
+
+		void lineReader()
+		{
+			std::string lines;
+			for (int i = 0; i < 200; ++i)
+				lines += "{ \"id\": " + std::to_string(i) + " }\n" + (i % 7 ? "" : "\r\n");
+
+			chcl::JSON_LineReader reader{ lines.data(), lines.size(), 4, 64 };
+			std::vector<int> ids;
+			bool valid = reader.readAll<chcl::JSON_Object>([&](chcl::JSON_Object &&object) { ids.push_back(object.readElement<int>("id")); });
+			Asserts::Equal(valid, true, "JSON line reader rejected valid lines.\n");
+			Asserts::Equal(ids.size(), (size_t)200, "JSON line reader delivered the wrong number of documents.\n");
+			Asserts::Equal(std::is_sorted(ids.begin(), ids.end()), true, "JSON line reader delivered documents out of order.\n");
+
+			std::atomic<int> sum = 0;
+			reader.parseAll([&](const chcl::JSON_Tape &document)
+				{
+					int id = 0;
+					document.readNumber(document.findMember(0, "id"), id);
+					sum += id;
+				});
+			Asserts::Equal(sum.load(), 199 * 100, "JSON line reader parsed the wrong documents.\n");
+
+			// Objects keep their document, which must not depend on the reader's text
+			std::vector<chcl::JSON_Object> objects;
+			{
+				std::string text = "{ \"name\": \"first\" }\n{ \"name\": \"second\" }\n";
+				chcl::JSON_LineReader objectReader{ text.data(), text.size(), 2, 1 };
+				objectReader.readAll<chcl::JSON_Object>([&](chcl::JSON_Object &&object) { objects.push_back(std::move(object)); });
+				std::fill(text.begin(), text.end(), 'x');
+			}
+			Asserts::Equal(objects.size() == 2 && objects[1].readElement<std::string>("name") == "second", true, "JSON line reader objects did not outlive the reader.\n");
+
+			// Exceptions on the workers or in the consumer reach the calling thread
+			bool workerThrew = false, consumerThrew = false;
+			try
+			{
+				reader.parseAll([](const chcl::JSON_Tape&) { throw std::runtime_error("handler"); });
+			}
+			catch (const std::runtime_error&)
+			{
+				workerThrew = true;
+			}
+			try
+			{
+				reader.readAll<chcl::JSON_Object>([](chcl::JSON_Object&&) { throw std::runtime_error("consumer"); });
+			}
+			catch (const std::runtime_error&)
+			{
+				consumerThrew = true;
+			}
+			Asserts::Equal(workerThrew && consumerThrew, true, "JSON line reader did not pass on an exception.\n");
+
+			const std::string filename = (std::filesystem::temp_directory_path() / "chcl_line_reader_test.ndjson").string();
+			{
+				std::ofstream file(filename, std::ios::binary);
+				file << lines;
+			}
+			{
+				int fileSum = 0;
+				chcl::JSON_LineReader fileReader = chcl::JSON_LineReader::FromFile(filename, 2, 16);
+				Asserts::Equal(fileReader.readAll<chcl::JSON_Object>([&](chcl::JSON_Object &&object) { fileSum += object.readElement<int>("id"); }), true,
+					"JSON line reader rejected a valid file.\n");
+				Asserts::Equal(fileSum, 199 * 100, "JSON line reader read the wrong documents from a file.\n");
+			}
+			std::filesystem::remove(filename);
+
+			chcl::JSON_LineReader missing = chcl::JSON_LineReader::FromFile(filename, 2, 16);
+			Asserts::Equal(!missing && !missing.parseAll([](const chcl::JSON_Tape&) {}), true, "JSON line reader accepted a missing file.\n");
+
+			chcl::JSON_LineReader invalid{ "1\n[\n2", 5, 2, 1 };
+			size_t count = 0;
+			Asserts::Equal(invalid.readAll<int>([&](int&&) { ++count; }, chcl::JSON_LineReader::Delivery::Unordered), false, "JSON line reader accepted a malformed line.\n");
+			Asserts::Equal(count, (size_t)2, "JSON line reader skipped a valid line.\n");
+		}
+
+		void binary()
+		{
+			using Format = chcl::JSON_Binary::Format;
+
+			chcl::Buffer cbor;
+			chcl::JSON_Binary::Encode(chcl::JSON_Parser::ParseElement<chcl::JSON_Object>("{ \"a\": -2 }"), cbor, Format::Cbor);
+			const uint8_t cborExpected[] = { 0xbf, 0x61, 'a', 0x21, 0xff };
+			Asserts::Equal(cbor.size() == sizeof(cborExpected) && std::memcmp(cbor.data(), cborExpected, sizeof(cborExpected)) == 0, true, "CBOR encoding was wrong.\n");
+
+			chcl::Buffer pack;
+			chcl::JSON_Binary::Encode(std::vector<std::string>{ "x", "y" }, pack, Format::MessagePack);
+			const uint8_t packExpected[] = { 0x92, 0xa1, 'x', 0xa1, 'y' };
+			Asserts::Equal(pack.size() == sizeof(packExpected) && std::memcmp(pack.data(), packExpected, sizeof(packExpected)) == 0, true, "MessagePack encoding was wrong.\n");
+
+			Message message;
+			message.id = -300;
+			message.text = "binary \"text\"";
+			message.position.x = 0.1;
+			message.tags = std::vector<int>(40, 7);
+			for (Format format : { Format::Cbor, Format::MessagePack })
+			{
+				chcl::Buffer encoded;
+				chcl::JSON_Binary::Encode(message, encoded, format);
+				Message decoded = chcl::JSON_Binary::Decode<Message>(encoded.data(), encoded.size(), format);
+				Asserts::Equal(decoded.id, message.id, "Binary JSON integer round trip failed.\n");
+				Asserts::Equal(decoded.text, message.text, "Binary JSON string round trip failed.\n");
+				Asserts::Equal(decoded.position.x, message.position.x, "Binary JSON float round trip failed.\n");
+				Asserts::Equal(decoded.tags == message.tags, true, "Binary JSON typed array round trip failed.\n");
+
+				// Typed arrays keep their binary values, so matrices are copied out of the tape rather than parsed
+				chcl::DynamicMatrix<double> matrix(3, 4);
+				for (size_t i = 0; i < matrix.count(); ++i)
+					matrix.data()[i] = 0.1 * double(i) - 0.5;
+				chcl::Buffer matrixEncoded;
+				chcl::JSON_Binary::Encode(matrix, matrixEncoded, format);
+				auto tape = chcl::JSON_Binary::DecodeTape(matrixEncoded.data(), matrixEncoded.size(), format);
+				Asserts::Equal(tape && tape->binary() && (*tape)[tape->findMember(0, "values")].format == chcl::JSON_NumberFormat::Double, true,
+					"Binary JSON matrix values were not kept as binary.\n");
+				chcl::DynamicMatrix<double> decodedMatrix = chcl::JSON_Binary::Decode<chcl::DynamicMatrix<double>>(matrixEncoded.data(), matrixEncoded.size(), format);
+				Asserts::Equal(decodedMatrix.rows() == 3 && decodedMatrix.cols() == 4 && std::memcmp(decodedMatrix.data(), matrix.data(), matrix.count() * sizeof(double)) == 0, true,
+					"Binary JSON dynamic matrix round trip failed.\n");
+
+				chcl::Matrix<2, 2, float> fixed({ 1.5f, -2.f, 0.1f, 4.f });
+				chcl::Buffer fixedEncoded;
+				chcl::JSON_Binary::Encode(fixed, fixedEncoded, format);
+				chcl::Matrix<2, 2, float> decodedFixed = chcl::JSON_Binary::Decode<chcl::Matrix<2, 2, float>>(fixedEncoded.data(), fixedEncoded.size(), format);
+				Asserts::Equal(std::memcmp(decodedFixed.data(), fixed.data(), 4 * sizeof(float)), 0, "Binary JSON matrix round trip failed.\n");
+				chcl::Matrix<2, 2, int> converted = chcl::JSON_Binary::Decode<chcl::Matrix<2, 2, int>>(fixedEncoded.data(), fixedEncoded.size(), format);
+				Asserts::Equal(converted.data()[0] == 1 && converted.data()[1] == -2 && converted.data()[3] == 4, true, "Binary JSON typed array conversion failed.\n");
+
+				// Re-encoding a decoded tape writes the same bytes
+				chcl::Buffer reencoded;
+				chcl::JSON_Writer{ reencoded, format }.element(*tape);
+				Asserts::Equal(reencoded.size() == matrixEncoded.size() && std::memcmp(reencoded.data(), matrixEncoded.data(), reencoded.size()) == 0, true,
+					"Binary JSON tape was re-encoded differently.\n");
+			}
+
+			// Big endian float64 typed array, under an integer member name
+			const uint8_t bigEndian[] = { 0xa1, 0x07, 0xd8, 0x52, 0x50,
+				0x3f, 0xf8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+			auto swapped = chcl::JSON_Binary::DecodeTape(bigEndian, sizeof(bigEndian), Format::Cbor);
+			double swappedValues[2] = {};
+			Asserts::Equal(swapped && swapped->readNumbers(swapped->findMember(0, "7"), swappedValues, 2) && swappedValues[0] == 1.5 && swappedValues[1] == -2.5, true,
+				"Binary JSON big endian typed array was read wrong.\n");
+			Asserts::Equal(swapped->json(0), std::string("{\"7\":[1.5,-2.5]}"), "Binary JSON tape was rendered wrong.\n");
+		}
+
+		void document()
+		{
+			const std::string first = R"({"name":"plain","escaped":"tab\tquote\"","values":[1,2.5,-3],"nested":{"flag":true},"tags":[4,5]})";
+			const std::string second = R"(["a\nb",{"k":null}])";
+
+			chcl::JSON_Document document{ 256 };
+			Asserts::Equal(document.parse(first), true, "JSON_Document failed to parse a valid document.\n");
+
+			chcl::JSON_Value root = document.root();
+			Asserts::Equal(root["name"].string() == "plain", true, "JSON_Document unescaped string was wrong.\n");
+			Asserts::Equal(root["name"].string().data() >= first.data() && root["name"].string().data() < first.data() + first.size(), true, "JSON_Document copied a string without escapes.\n");
+			Asserts::Equal(root["escaped"].string() == "tab\tquote\"", true, "JSON_Document escaped string was wrong.\n");
+			Asserts::Equal(root["values"].size(), size_t(3), "JSON_Document array size was wrong.\n");
+			Asserts::Equal(root["values"][1].number<double>(), 2.5, "JSON_Document number was wrong.\n");
+			Asserts::Equal(root["values"][2].number<int>(), -3, "JSON_Document number was wrong.\n");
+			Asserts::Equal(root["nested"]["flag"].boolean(), true, "JSON_Document boolean was wrong.\n");
+			Asserts::Equal(bool(root["missing"]["deeper"][4]), false, "JSON_Document missing lookup returned an element.\n");
+			Asserts::Equal(root["missing"].type(), chcl::JSON_Type::Null, "JSON_Document missing element had a type.\n");
+			Asserts::Equal(root["missing"].is(chcl::JSON_Type::Null), false, "JSON_Document missing element read as null.\n");
+			Asserts::Equal(root["tags"].read<std::vector<int>>() == std::vector<int>{ 4, 5 }, true, "JSON_Document read was wrong.\n");
+
+			double sum = 0;
+			root["values"].forEachElement([&](chcl::JSON_Value value) { sum += value.number<double>(); });
+			Asserts::Equal(sum, 0.5, "JSON_Document element iteration was wrong.\n");
+
+			std::string keys;
+			root.forEachMember([&](std::string_view key, chcl::JSON_Value) { keys += key; keys += ','; });
+			Asserts::Equal(keys, std::string("name,escaped,values,nested,tags,"), "JSON_Document member iteration was wrong.\n");
+
+			const size_t capacity = document.arena().capacity();
+			Asserts::Equal(document.parse(second), true, "JSON_Document failed to reparse.\n");
+			Asserts::Equal(document.root()[0].string() == "a\nb", true, "JSON_Document reparsed string was wrong.\n");
+			Asserts::Equal(document.root()[1]["k"].is(chcl::JSON_Type::Null), true, "JSON_Document reparsed null was wrong.\n");
+			Asserts::Equal(document.arena().capacity(), capacity, "JSON_Document did not reuse its arena.\n");
+			Asserts::Equal(document.root().size(), size_t(2), "JSON_Document reparsed array size was wrong.\n");
+			Asserts::Equal(document.root()[0].size(), size_t(0), "JSON_Document string had a size.\n");
+
+			// Only strings take up space, other elements are read from the tape
+			Asserts::Equal(document.parse("[1,2,3,4,5,6,7,8,true,null,{\"key\":\"value\"}]"), true, "JSON_Document failed to parse numbers.\n");
+			Asserts::Equal(document.arena().used(), 2 * sizeof(std::string_view), "JSON_Document stored more than the views of its strings.\n");
+			Asserts::Equal(document.root()[10]["key"].string() == "value", true, "JSON_Document string after other elements was wrong.\n");
+
+			Asserts::Equal(document.parse("{\"a\":"), false, "JSON_Document accepted a truncated document.\n");
+			Asserts::Equal(bool(document.root()), false, "JSON_Document invalid document had a root.\n");
+		}
+
+		void path()
+		{
+			const std::string text = R"({"skip":{"deep":[1,{"cpu":"]}"}],"s":"\"{"},"metrics":{"a/b":1,"cpu":[{"load":0.5},{"load":1.5},{},{"load":3.25,"ids":[7,8]}]}})";
+
+			chcl::JSON_Path pointer{ "/metrics/cpu/3/load" };
+			Asserts::Equal(pointer.find(text) == "3.25", true, "JSON_Path pointer query was wrong.\n");
+			double load = 0.0;
+			Asserts::Equal(chcl::JSON_Path("metrics.cpu[3].load").read(text, load), true, "JSON_Path dotted query failed.\n");
+			Asserts::Equal(load, 3.25, "JSON_Path dotted query was wrong.\n");
+
+			std::vector<int> ids;
+			Asserts::Equal(chcl::JSON_Path("metrics.cpu.3.ids").read(text, ids) && ids == std::vector<int>{ 7, 8 }, true, "JSON_Path container query was wrong.\n");
+			Asserts::Equal(chcl::JSON_Path("/metrics/a~1b").find(text) == "1", true, "JSON_Path escaped pointer was wrong.\n");
+			Asserts::Equal(chcl::JSON_Path("/skip/deep/1/cpu").find(text) == "\"]}\"", true, "JSON_Path string query was wrong.\n");
+			Asserts::Equal(chcl::JSON_Path("").find(text) == text, true, "JSON_Path root query was wrong.\n");
+
+			Asserts::Equal(chcl::JSON_Path("/metrics/cpu/4").find(text).empty(), true, "JSON_Path found an element past the end.\n");
+			Asserts::Equal(chcl::JSON_Path("/metrics/cpu/2/load").find(text).empty(), true, "JSON_Path found a missing member.\n");
+			Asserts::Equal(chcl::JSON_Path("/metrics/cpu/01").find(text).empty(), true, "JSON_Path accepted a leading zero index.\n");
+			Asserts::Equal(chcl::JSON_Path("a..b").valid() || chcl::JSON_Path("a[x]").valid() || chcl::JSON_Path("/a~2").valid(), false, "JSON_Path accepted a malformed path.\n");
+
+			// Precompiled paths resolve the same way on parsed documents
+			chcl::JSON_Document document;
+			document.parse(text);
+			Asserts::Equal(document.root().at(pointer).number<double>(), 3.25, "JSON_Path document query was wrong.\n");
+			Asserts::Equal(bool(document.root().at(chcl::JSON_Path("/metrics/cpu/9"))), false, "JSON_Path document query found a missing element.\n");
+		}
+
+		/// @brief Decodes one sequence at a time, to compare the vectorized validator against
+		bool ReferenceUtf8(std::string_view text)
+		{
+			constexpr uint32_t minimum[] = { 0, 0, 0x80, 0x800, 0x10000 };
+			size_t i = 0;
+			while (i < text.length())
+			{
+				unsigned char lead = static_cast<unsigned char>(text[i]);
+				size_t length = lead < 0x80 ? 1 : lead >= 0xC2 && lead <= 0xDF ? 2 : (lead & 0xF0) == 0xE0 ? 3 : lead >= 0xF0 && lead <= 0xF4 ? 4 : 0;
+				if (length == 0 || i + length > text.length())
+					return false;
+
+				uint32_t codePoint = length == 1 ? lead : lead & (0x7F >> length);
+				for (size_t j = 1; j < length; ++j)
+				{
+					unsigned char c = static_cast<unsigned char>(text[i + j]);
+					if ((c & 0xC0) != 0x80)
+						return false;
+					codePoint = (codePoint << 6) | (c & 0x3F);
+				}
+				if (codePoint < minimum[length] || codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF))
+					return false;
+				i += length;
+			}
+			return true;
+		}
+
+		size_t EncodeUtf8(uint32_t codePoint, char *out)
+		{
+			if (codePoint < 0x80)
+			{
+				out[0] = char(codePoint);
+				return 1;
+			}
+			size_t length = codePoint < 0x800 ? 2 : codePoint < 0x10000 ? 3 : 4;
+			for (size_t i = length - 1; i > 0; --i, codePoint >>= 6)
+				out[i] = char(0x80 | (codePoint & 0x3F));
+			out[0] = char((0xF00 >> length) | codePoint);
+			return length;
+		}
+
+		void strings()
+		{
+			// Escapes are placed past the first vector so both the bulk and scalar paths are covered
+			const std::string padding(40, 'x');
+			std::string decoded;
+			chcl::JSON_Stream escapedStream{ "\"" + padding + R"(\b\f\/\u00e9\u20AC\ud83d\ude00\ud800x\"")" };
+			escapedStream >> decoded;
+			Asserts::Equal(decoded == padding + "\b\f/\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80\xEF\xBF\xBDx\"", true, "JSON string escapes were decoded wrong.\n");
+
+			std::string original = padding + "quote\" back\\ tab\t bell\x07 " + padding + "\xE2\x82\xAC";
+			chcl::JSON_Stream formatStream;
+			formatStream << original;
+			Asserts::Equal(formatStream.str().find("\\u0007") != std::string::npos, true, "JSON control character was not escaped.\n");
+			std::string roundTrip;
+			chcl::JSON_Stream parseStream{ formatStream.str() };
+			parseStream >> roundTrip;
+			Asserts::Equal(roundTrip, original, "JSON string round trip failed.\n");
+
+			Asserts::Equal(chcl::JSON_Strings::ValidUtf8(padding + "\xF0\x9F\x98\x80" + padding), true, "Valid UTF-8 was rejected.\n");
+			for (const char *invalid : { "\xC0\xAF", "\xED\xA0\x80", "\xF4\x90\x80\x80", "\xE2\x82", "\x80" })
+			{
+				Asserts::Equal(chcl::JSON_Strings::ValidUtf8(padding + invalid), false, "Invalid UTF-8 was accepted.\n");
+				std::string text = "[\"" + padding + invalid + "\"]";
+				Asserts::Equal(chcl::JSON_Tape(text).valid(), false, "JSON with invalid UTF-8 was parsed.\n");
+			}
+
+			// Every boundary case at every offset around a vector boundary, including at the very end of the text
+			const char *sequences[] = {
+				"\xC2\x80", "\xDF\xBF", "\xE0\xA0\x80", "\xED\x9F\xBF", "\xEF\xBF\xBF", "\xF0\x90\x80\x80", "\xF4\x8F\xBF\xBF",
+				"\xC0\x80", "\xC1\xBF", "\xE0\x9F\xBF", "\xED\xA0\x80", "\xF0\x8F\xBF\xBF", "\xF4\x90\x80\x80", "\xF5\x80\x80\x80",
+				"\xFF", "\x80", "\xBF", "\xC2", "\xE0\xA0", "\xF0\x90\x80", "\xC2\x80\x80", "\xE2\x82\xAC\xAC", "\xC2\xC2\x80", "\xE2\x28\xA1" };
+			for (const char *sequence : sequences)
+			{
+				for (size_t offset = 0; offset < 40; ++offset)
+				{
+					std::string text = std::string(offset, 'x') + sequence;
+					Asserts::Equal(chcl::JSON_Strings::ValidUtf8(text), ReferenceUtf8(text), "UTF-8 validation disagreed at the end of the text.\n");
+					text += padding;
+					Asserts::Equal(chcl::JSON_Strings::ValidUtf8(text), ReferenceUtf8(text), "UTF-8 validation disagreed before more text.\n");
+				}
+			}
+
+			std::mt19937 random{ 7 };
+			for (int i = 0; i < 5000; ++i)
+			{
+				std::string text;
+				size_t length = random() % 100;
+				while (text.length() < length)
+				{
+					switch (random() % 4)
+					{
+						case 0: text += char('a' + random() % 26); break;
+						case 1: text += char(0x80 + random() % 0x80); break;
+						default:
+						{
+							char encoded[4];
+							uint32_t codePoint = random() % 0x110000;
+							if (codePoint >= 0xD800 && codePoint <= 0xDFFF)
+								codePoint -= 0x800;
+							text.append(encoded, EncodeUtf8(codePoint, encoded));
+						}
+					}
+				}
+				Asserts::Equal(chcl::JSON_Strings::ValidUtf8(text), ReferenceUtf8(text), "UTF-8 validation disagreed on random text.\n");
+			}
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,22 @@
+#pragma once
+
+namespace testing
+{
+	namespace json
+	{
+		void all();
+
+		void tape();
+		void scanner();
+		void objectView();
+		void reader();
+		void writer();
+		void numbers();
+		void binding();
+		void lineReader();
+		void binary();
+		void document();
+		void path();
+		void strings();
+	}
+}
\ No newline at end of file
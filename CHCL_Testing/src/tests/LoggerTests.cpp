@@ -0,0 +1,130 @@
+#include "LoggerTests.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <chcl/misc/Logger.h>
+
+#include "../Asserts.h"
+
+namespace testing
+{
+	namespace logger
+	{
+		void all()
+		{
+			records();
+			wrapAround();
+			oversized();
+			blocking();
+		}
+
+		/// @brief Path of a fresh log file, since loggers append to what is already there
+		std::string logFile(const std::string &name)
+		{
+			std::filesystem::path path = std::filesystem::temp_directory_path() / name;
+			std::filesystem::remove(path);
+			return path.string();
+		}
+
+		std::string readFile(const std::string &filename)
+		{
+			std::ifstream file(filename, std::ios::binary);
+			std::stringstream text;
+			text << file.rdbuf();
+			return text.str();
+		}
+
+		void records()
+		{
+			const std::string filename = logFile("chcl_logger_records.log");
+			{
+				chcl::Logger logger(filename);
+				Asserts::Equal((bool)logger, true, "Logger failed to open its file.\n");
+
+				std::string temporary = "copied";
+				logger.log<"{0} {1:x} {2:.1f}">(7, 255, 1.5);
+				logger.log<"{1}-{0}">(temporary, "b");
+				temporary = "changed";
+				logger.log("runtime {0}", -3);
+			}
+
+			Asserts::Equal(readFile(filename), std::string("7 0xff 1.5\nb-copied\nruntime -3\n"), "Logged records were written incorrectly.\n");
+			std::filesystem::remove(filename);
+		}
+
+		void wrapAround()
+		{
+			const std::string filename = logFile("chcl_logger_wrap.log");
+			const std::string large(3000, 'x');
+
+			// A record that does not fit before the end of the ring starts again at the beginning once that is free
+			for (auto policy : { chcl::Logger::OverflowPolicy::Drop, chcl::Logger::OverflowPolicy::Block })
+			{
+				std::string expected;
+				{
+					chcl::Logger logger(filename, policy, 4096);
+					for (int i = 0; i < 64; ++i)
+					{
+						logger.log<"{0}">(i);
+						expected += std::to_string(i) + '\n';
+					}
+					logger.flush();
+
+					// Only one large record fits at a time, so dropping needs each to be written before the next
+					for (int i = 0; i < 3; ++i)
+					{
+						logger.log<"{0}">(large);
+						expected += large + '\n';
+						if (policy == chcl::Logger::OverflowPolicy::Drop)
+							logger.flush();
+					}
+					logger.flush();
+					Asserts::Equal(logger.droppedCount(), uint64_t(0), "Logger dropped a record that fits in its queue.\n");
+				}
+
+				Asserts::Equal(readFile(filename), expected, "Records wrapping around the queue were written incorrectly.\n");
+				std::filesystem::remove(filename);
+			}
+		}
+
+		void oversized()
+		{
+			const std::string filename = logFile("chcl_logger_oversized.log");
+			{
+				// Blocking cannot make room for a record bigger than the queue, so it is dropped
+				chcl::Logger logger(filename, chcl::Logger::OverflowPolicy::Block, 4096);
+				logger.log<"{0}">(std::string(5000, 'x'));
+				logger.log<"after">();
+				logger.flush();
+				Asserts::Equal(logger.droppedCount(), uint64_t(1), "Logger did not drop a record bigger than its queue.\n");
+			}
+
+			Asserts::Equal(readFile(filename), std::string("[1 messages dropped]\nafter\n"), "Dropped records were reported incorrectly.\n");
+			std::filesystem::remove(filename);
+		}
+
+		void blocking()
+		{
+			const std::string filename = logFile("chcl_logger_blocking.log");
+			std::string expected;
+			{
+				// The background thread would otherwise sleep for the whole interval, so a full queue must wake it
+				chcl::Logger logger(filename, chcl::Logger::OverflowPolicy::Block, 4096, std::chrono::hours(1));
+				const std::string line(100, 'x');
+				for (int i = 0; i < 1000; ++i)
+				{
+					logger.log<"{0} {1}">(i, line);
+					expected += std::to_string(i) + ' ' + line + '\n';
+				}
+				Asserts::Equal(logger.droppedCount(), uint64_t(0), "Blocking logger dropped a record.\n");
+			}
+
+			Asserts::Equal(readFile(filename), expected, "Blocking logger wrote its records incorrectly.\n");
+			std::filesystem::remove(filename);
+		}
+	}
+}
\ No newline at end of file
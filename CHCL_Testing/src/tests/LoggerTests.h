@@ -0,0 +1,14 @@
+#pragma once
+
+namespace testing
+{
+	namespace logger
+	{
+		void all();
+
+		void records();
+		void wrapAround();
+		void oversized();
+		void blocking();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,228 @@
+#include "ProfilerTests.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Scopes are only profiled where this is defined, so the test turns them on for its own code
+#define CHCL_ENABLE_PROFILING
+#include <chcl/misc/Profiler.h>
+#include <chcl/dataStorage/JSON_Tape.h>
+
+#include "../Asserts.h"
+
+namespace testing
+{
+	namespace profiler
+	{
+		void all()
+		{
+			threads();
+			trace();
+		}
+
+		/// @brief Takes long enough that every scope measures some ticks
+		void spin()
+		{
+			volatile int sink = 0;
+			for (int i = 0; i < 1000; ++i)
+				sink = sink + i;
+		}
+
+		void profiledWork(int iterations)
+		{
+			for (int i = 0; i < iterations; ++i)
+			{
+				ProfileScope(profiler_test_outer)
+				{
+					ProfileScope(profiler_test_first)
+					spin();
+				}
+				{
+					ProfileScope(profiler_test_second)
+					{
+						ProfileScope(profiler_test_nested)
+						spin();
+					}
+				}
+			}
+		}
+
+		/**
+		 * @brief Runs a function on several threads at once, each named after its index
+		 * @return Everything the threads printed, which is only ever a "Profiler BAD" message
+		 */
+		template <typename Function>
+		std::string runThreads(const std::string &name, int count, Function &&function)
+		{
+			std::stringstream output;
+			std::streambuf *previous = std::cout.rdbuf(output.rdbuf());
+
+			std::vector<std::thread> workers;
+			for (int i = 0; i < count; ++i)
+			{
+				workers.emplace_back([&, i]()
+					{
+						chcl::Profiler::SetThreadName(name + ' ' + std::to_string(i));
+						function(i);
+					});
+			}
+			for (std::thread &worker : workers)
+				worker.join();
+
+			std::cout.rdbuf(previous);
+			return output.str();
+		}
+
+		/// @brief Ticks of an entry's child, or 0 if it has none of that name
+		chcl::ProfilerClock::ticks childTicks(const chcl::Profiler::ProfilerEntry *entry, const std::string &name)
+		{
+			const chcl::Profiler::ProfilerEntry *child = entry ? entry->findChildEntry(name) : nullptr;
+			return child ? child->getTicks() : 0;
+		}
+
+		void threads()
+		{
+			std::string output = runThreads("profiler test", 4, [](int index) { profiledWork(20 + index * 10); });
+			Asserts::Equal(output, std::string(), "Profiler scopes on several threads were ended out of order.\n");
+
+			// Every thread has its own tree, nested the same way as its scopes
+			int checkedThreads = 0;
+			chcl::ProfilerClock::ticks outerTotal = 0, nestedTotal = 0;
+			chcl::Profiler::ForEachThreadTree([&](const std::string &name, const chcl::Profiler::ProfilerEntry &tree)
+				{
+					const chcl::Profiler::ProfilerEntry *outer = tree.findChildEntry("profiler_test_outer");
+					const chcl::Profiler::ProfilerEntry *second = outer ? outer->findChildEntry("profiler_test_second") : nullptr;
+					outerTotal += childTicks(&tree, "profiler_test_outer");
+					nestedTotal += childTicks(second, "profiler_test_nested");
+
+					if (name.starts_with("profiler test"))
+					{
+						++checkedThreads;
+						Asserts::Equal(outer && second && outer->findChildEntry("profiler_test_first"), true, "Profiler thread tree is missing a scope.\n");
+						Asserts::Equal(outer->findChildEntry("profiler_test_nested") == nullptr, true, "Profiler nested a scope under the wrong parent.\n");
+						Asserts::Equal(childTicks(second, "profiler_test_nested") > 0 && childTicks(second, "profiler_test_nested") <= second->getTicks(), true,
+							"Profiler child scope took longer than its parent.\n");
+						Asserts::Equal(childTicks(outer, "profiler_test_first") + second->getTicks() <= outer->getTicks(), true,
+							"Profiler children took longer than their parent.\n");
+					}
+				});
+			Asserts::Equal(checkedThreads, 4, "Profiler did not keep a tree for every thread.\n");
+
+			chcl::Profiler::ProfilerEntry merged{ chcl::Profiler::TopLevelName };
+			chcl::Profiler::MergeThreadTrees(merged);
+			const chcl::Profiler::ProfilerEntry *mergedOuter = merged.findChildEntry("profiler_test_outer");
+			Asserts::Equal(childTicks(&merged, "profiler_test_outer"), outerTotal, "Profiler merged tree has the wrong total.\n");
+			Asserts::Equal(childTicks(mergedOuter ? mergedOuter->findChildEntry("profiler_test_second") : nullptr, "profiler_test_nested"), nestedTotal,
+				"Profiler merged tree has the wrong nested total.\n");
+		}
+
+		struct TraceEvent
+		{
+			std::string name;
+			std::string phase;
+			double time = 0.0;
+		};
+
+		/// @brief Reads an exported trace back, grouping its begin and end events by thread name
+		std::map<std::string, std::vector<TraceEvent>> readTrace(const std::string &filename)
+		{
+			std::ifstream file(filename, std::ios::binary);
+			std::stringstream text;
+			text << file.rdbuf();
+
+			chcl::JSON_Tape tape{ text.str() };
+			Asserts::Equal(tape.valid(), true, "Profiler trace is not valid JSON.\n");
+
+			std::map<size_t, std::string> threadNames;
+			std::map<std::string, std::vector<TraceEvent>> threads;
+			size_t events = tape.findMember(0, "traceEvents");
+			if (events == chcl::JSON_Tape::npos)
+				return threads;
+
+			for (size_t index = events + 1; index < tape[events].next; index = tape[index].next)
+			{
+				TraceEvent event;
+				size_t thread = 0;
+				tape.readString(tape.findMember(index, "ph"), event.phase);
+				tape.readNumber(tape.findMember(index, "tid"), thread);
+
+				if (event.phase == "M")
+					tape.readString(tape.findMember(tape.findMember(index, "args"), "name"), threadNames[thread]);
+				else
+				{
+					tape.readString(tape.findMember(index, "name"), event.name);
+					tape.readNumber(tape.findMember(index, "ts"), event.time);
+					threads[threadNames[thread]].push_back(event);
+				}
+			}
+			return threads;
+		}
+
+		/// @returns Whether every end event closes the innermost open scope, every scope is closed and time never goes backwards
+		bool balanced(const std::vector<TraceEvent> &events)
+		{
+			std::vector<std::string> open;
+			double time = 0.0;
+			for (const TraceEvent &event : events)
+			{
+				if (event.time < time)
+					return false;
+				time = event.time;
+
+				if (event.phase == "B")
+					open.push_back(event.name);
+				else if (event.phase != "E" || open.empty() || open.back() != event.name)
+					return false;
+				else
+					open.pop_back();
+			}
+			return open.empty();
+		}
+
+		void trace()
+		{
+			const std::string filename = (std::filesystem::temp_directory_path() / "chcl_profiler_trace.json").string();
+
+			chcl::Profiler::StartRecording();
+			std::string output = runThreads("profiler trace", 2, [](int) { profiledWork(10); });
+			chcl::Profiler::StopRecording();
+			Asserts::Equal(output, std::string(), "Recorded profiler scopes were ended out of order.\n");
+			Asserts::Equal(chcl::Profiler::ExportTrace(filename), true, "Profiler failed to export a trace.\n");
+
+			auto threads = readTrace(filename);
+			for (const char *name : { "profiler trace 0", "profiler trace 1" })
+			{
+				const std::vector<TraceEvent> &events = threads[name];
+				Asserts::Equal(events.size(), size_t(10 * 4 * 2), "Profiler trace has the wrong number of events.\n");
+				Asserts::Equal(balanced(events), true, "Profiler trace events are unbalanced or out of order.\n");
+			}
+
+			// Only the last 8 events are kept: the end of one inner scope, three whole ones, and the end of the outer scope
+			chcl::Profiler::StartRecording(8);
+			output = runThreads("profiler overflow", 1, [](int)
+				{
+					ProfileScope(profiler_test_outer)
+					for (int i = 0; i < 10; ++i)
+					{
+						ProfileScope(profiler_test_first)
+						spin();
+					}
+				});
+			chcl::Profiler::StopRecording();
+			Asserts::Equal(chcl::Profiler::ExportTrace(filename), true, "Profiler failed to export an overflowed trace.\n");
+
+			threads = readTrace(filename);
+			const std::vector<TraceEvent> &overflowed = threads["profiler overflow 0"];
+			Asserts::Equal(overflowed.size(), size_t(6), "Profiler trace kept unmatched end events after overflowing.\n");
+			Asserts::Equal(balanced(overflowed), true, "Overflowed profiler trace events are unbalanced.\n");
+			Asserts::Equal(threads["profiler trace 0"].empty(), true, "Profiler trace kept events from an earlier recording.\n");
+			std::filesystem::remove(filename);
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,12 @@
+#pragma once
+
+namespace testing
+{
+	namespace profiler
+	{
+		void all();
+
+		void threads();
+		void trace();
+	}
+}
\ No newline at end of file
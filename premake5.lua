@@ -33,6 +33,42 @@ project "CHCL Testing"
 		"CHCL"
 	}
 
+	filter "system:windows"
+		systemversion "latest"
+
+	filter "configurations:Debug"
+		symbols "On"
+
+	filter "configurations:Release"
+		optimize "On"
+
+project "CHCL Benchmarks"
+	location "CHCL_Benchmarks"
+	kind "ConsoleApp"
+	language "C++"
+	cppdialect "C++20"
+	staticruntime "On"
+
+	targetdir ("bin/" .. outputdir .. "/%{prj.name}")
+	objdir ("bin-int/" .. outputdir .. "/%{prj.name}")
+
+	files
+	{
+		"%{prj.location}/src/**.h",
+		"%{prj.location}/src/**.cpp",
+		"%{prj.location}/src/**.inl"
+	}
+
+	includedirs
+	{
+		"CHCL/src"
+	}
+
+	links
+	{
+		"CHCL"
+	}
+
 	filter "system:windows"
 		systemversion "latest"
 